@@ -799,7 +799,7 @@ static char *getEndPoint_input()
 
 static void init()
 {
-    config = (EdgeConfigure *) EdgeMalloc(sizeof(EdgeConfigure));
+    config = (EdgeConfigure *) EdgeCalloc(1, sizeof(EdgeConfigure));
     VERIFY_NON_NULL_NR(config);
     config->recvCallback = (ReceivedMessageCallback *) EdgeMalloc(sizeof(ReceivedMessageCallback));
     VERIFY_NON_NULL_NR(config->recvCallback);
@@ -16,10 +16,16 @@ mkdir build
 # Get into the build directory
 cd build
 
-cmake .. -DCMAKE_BUILD_TYPE=Release -DUA_ENABLE_AMALGAMATION=ON -DUA_ENABLE_ENCRYPTION=OFF
+cmake .. -DCMAKE_BUILD_TYPE=Release -DUA_ENABLE_AMALGAMATION=ON -DUA_ENABLE_ENCRYPTION=OFF -DUA_ENABLE_MALLOC_SINGLETON=ON
 
 make
 
+# The adapter shares its allocator with the stack through the malloc singleton.
+if ! grep -q "#define UA_ENABLE_MALLOC_SINGLETON" open62541.h; then
+    echo "open62541.h is generated without UA_ENABLE_MALLOC_SINGLETON"
+    exit 1
+fi
+
 # Delete all files and folders except open62541.c and open62541.h.
 cp open62541.h ../../
 cp open62541.c ../../
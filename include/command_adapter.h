@@ -45,6 +45,13 @@ typedef void (*response_cb_t) (EdgeMessage *data);
  */
 typedef void (*send_cb_t) (EdgeMessage *data);
 
+/**
+ * @brief Callback Function to register for sending several requests of the same endpoint at once
+ * @param[out]  data Request EdgeMessages
+ * @param[out]  count Number of messages
+ */
+typedef void (*send_batch_cb_t) (EdgeMessage **data, size_t count);
+
 /**
  * @brief Callback Function to register for receiving the status response
  * @param  epInfo Endpoint information
@@ -41,13 +41,19 @@ extern "C"
 typedef struct EdgeNodeInfo EdgeNodeInfo;
 typedef struct EdgeResult EdgeResult;
 
+/** Layout version of EdgeVersatility, see getEdgeVersatilityAbiVersion. */
+#define EDGE_VERSATILITY_ABI_VERSION 2
+
+/** Largest scalar value stored inside EdgeVersatility itself. */
+#define EDGE_VERSATILITY_INLINE_SIZE 16
+
 /**
   * @brief Structure which represents the data
   *
   */
 typedef struct EdgeVersatility
 {
-    /**< Scalar/Array data. */
+    /**< Scalar/Array data. Points to inlineValue for a scalar stored inline. */
     void *value;
 
     /**< Scalar/Array type. */
@@ -55,8 +61,22 @@ typedef struct EdgeVersatility
 
     /**< Array Length */
     size_t arrayLength;
+
+    /**< Storage of scalar values up to EDGE_VERSATILITY_INLINE_SIZE bytes. */
+    union
+    {
+        int32_t int32Value;
+        int64_t int64Value;
+        double doubleValue;
+        bool boolValue;
+        unsigned char bytes[EDGE_VERSATILITY_INLINE_SIZE];
+    } inlineValue;
 } EdgeVersatility;
 
+/** true if the value of the EdgeVersatility is stored outside of it and freed on its own. */
+#define EDGE_VERSATILITY_IS_EXTERNAL(versatility) \
+    ((versatility)->value != (void *) &(versatility)->inlineValue)
+
 /**
   * @brief Structure which represents the diagnostic information
   *
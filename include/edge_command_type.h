@@ -71,6 +71,9 @@ typedef enum
     CMD_READ_SAMPLING_INTERVAL = 12
 } EdgeCommand;
 
+/** Number of commands in EdgeCommand.*/
+#define EDGE_COMMAND_COUNT (CMD_READ_SAMPLING_INTERVAL + 1)
+
 /** Read - String value.*/
 #define  CMD_READ_VALUE                   "read"
 
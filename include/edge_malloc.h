@@ -28,6 +28,7 @@
 #define EDGE_MALLOC_H_
 
 #include <malloc.h>
+#include <stdbool.h>
 #include <edge_opcua_common.h>
 
 #ifdef __cplusplus
@@ -98,6 +99,134 @@ EXPORT void EdgeFree(void *ptr);
 
 EXPORT Edge_String EdgeStringAlloc(char const src[]);
 
+/** Allocator functions with the semantics of malloc, calloc, realloc and free. */
+typedef void *(*EdgeMallocFunction)(size_t size);
+typedef void *(*EdgeCallocFunction)(size_t num, size_t size);
+typedef void *(*EdgeReallocFunction)(void *ptr, size_t size);
+typedef void (*EdgeFreeFunction)(void *ptr);
+
+/**
+ * Sets the allocator EdgeMalloc, EdgeCalloc, EdgeRealloc and EdgeFree go through.  The
+ * UA_malloc family of open62541 uses the same functions, so the stack and the adapter share
+ * one allocator.  This needs open62541 built with UA_ENABLE_MALLOC_SINGLETON.
+ *
+ * NOTE: Only to be called once at initialization, before any other function of the library
+ *       and before other threads are started.  The functions are swapped without locking,
+ *       and memory allocated before the call would be freed with the new functions.
+ *
+ * @param mallocFn - Replaces malloc.
+ * @param callocFn - Replaces calloc.
+ * @param reallocFn - Replaces realloc.
+ * @param freeFn - Replaces free.
+ *
+ * @return true, or false if only some of the functions are NULL or open62541 is built
+ *         without UA_ENABLE_MALLOC_SINGLETON.  If all of them are NULL, the C library
+ *         allocator is restored.
+ */
+EXPORT bool EdgeSetAllocator(EdgeMallocFunction mallocFn, EdgeCallocFunction callocFn,
+        EdgeReallocFunction reallocFn, EdgeFreeFunction freeFn);
+
+struct EdgeMemoryStats;
+
+/**
+ * Copies the allocation accounting counters.
+ *
+ * @param stats - Counters per TAG.
+ *
+ * @return true, or false if the library is built without EDGE_MEMORY_STATS
+ */
+bool EdgeMemoryGetStats(struct EdgeMemoryStats *stats);
+
+/**
+ * Writes the memory still allocated per TAG to stderr.  Built with EDGE_MEMORY_STATS,
+ * this is also done when the library is unloaded; otherwise it does nothing.
+ */
+void EdgeMemoryReportLeaks(void);
+
+#ifdef EDGE_MEMORY_STATS
+/*
+ * Allocation accounting: allocations are recorded under the TAG of the file calling
+ * EdgeMalloc, EdgeCalloc or EdgeRealloc, which must define TAG.  Without
+ * EDGE_MEMORY_STATS, these calls go straight to the allocator.
+ */
+EXPORT void *EdgeMallocTag(size_t size, const char *tag);
+EXPORT void *EdgeCallocTag(size_t num, size_t size, const char *tag);
+EXPORT void *EdgeReallocTag(void *ptr, size_t size, const char *tag);
+
+#define EdgeMalloc(size) EdgeMallocTag((size), TAG)
+#define EdgeCalloc(num, size) EdgeCallocTag((num), (size), TAG)
+#define EdgeRealloc(ptr, size) EdgeReallocTag((ptr), (size), TAG)
+#endif
+
+/**
+ * Region from which EdgeMalloc, EdgeCalloc and EdgeRealloc take memory while it is the
+ * current arena of the calling thread.  Its memory is handed out by bumping a pointer and
+ * released all at once by EdgeArenaDestroy.  While the arena is current, EdgeFree ignores
+ * pointers into it and frees heap pointers as usual, so objects mixing both kinds of
+ * memory can still be freed member by member.
+ *
+ * NOTE: These functions are intended to be used internally by the TB Stack.
+ */
+typedef struct EdgeArena EdgeArena;
+
+/** Size of the first block of the arena used for one EdgeMessage. */
+#define EDGE_MESSAGE_ARENA_SIZE 2048
+
+/**
+ * Creates an arena.
+ *
+ * @param initialSize - Size of the first block in bytes. Further blocks are allocated
+ *                      as needed.
+ *
+ * @return
+ *     on success, the arena
+ *     on failure, a null pointer is returned
+ */
+EdgeArena *EdgeArenaCreate(size_t initialSize);
+
+/**
+ * Takes an arena of EDGE_MESSAGE_ARENA_SIZE from the message arena pool, or creates one if
+ * the pool is empty.  EdgeArenaDestroy gives it back to the pool.
+ *
+ * @return
+ *     on success, the arena
+ *     on failure, a null pointer is returned
+ */
+EdgeArena *EdgeMessageArenaCreate(void);
+
+/**
+ * Releases the arena and all memory taken from it.  Arenas of EdgeMessageArenaCreate are
+ * emptied and kept for reuse.
+ *
+ * @param arena - Arena to release. If arena is a null pointer, the function does nothing.
+ */
+void EdgeArenaDestroy(EdgeArena *arena);
+
+/**
+ * Reads the message arena pool counters.
+ *
+ * @param hits - Number of EdgeMessageArenaCreate calls served by the pool.
+ * @param misses - Number of EdgeMessageArenaCreate calls that allocated a new arena.
+ * @param freeArenas - Number of arenas in the shared free list.
+ */
+void EdgeMessageArenaPoolStats(uint64_t *hits, uint64_t *misses, size_t *freeArenas);
+
+/**
+ * Makes arena the current arena of the calling thread.
+ *
+ * @param arena - New current arena, or a null pointer to allocate from the heap.
+ *
+ * @return the previous current arena, to be given to EdgeArenaLeave.
+ */
+EdgeArena *EdgeArenaEnter(EdgeArena *arena);
+
+/**
+ * Restores the current arena of the calling thread.
+ *
+ * @param previous - Value returned by the matching EdgeArenaEnter.
+ */
+void EdgeArenaLeave(EdgeArena *previous);
+
 #ifdef __cplusplus
 }
 #endif
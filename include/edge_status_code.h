@@ -64,6 +64,9 @@ typedef enum
     /** Failed to enqueue(add) a request into send queue.*/
     STATUS_ENQUEUE_ERROR = 20,
 
+    /** A synchronous request did not get its session in time.*/
+    STATUS_TIMEOUT = 21,
+
     /** Return fewer Results than the number of nodes specified in the nodesToRead parameter.*/
     STATUS_READ_LESS_RESPONSE = 26,
 
@@ -225,6 +228,9 @@ typedef enum
 /** STATUS_ENQUEUE_ERROR - Description.*/
 #define STATUS_ENQUEUE_ERROR_VALUE  ""
 
+/** STATUS_TIMEOUT - Description.*/
+#define STATUS_TIMEOUT_VALUE  "request timed out"
+
 /** STATUS_READ_LESS_RESPONSE - Description.*/
 #define STATUS_READ_LESS_RESPONSE_VALUE         "Return fewer Results than the number of nodes specified in the nodesToRead parameter."
 
@@ -332,6 +332,15 @@ typedef struct EdgeEndPointInfo
 
     /**<  Security Level.*/
     int securityLevel;
+
+    /**< Number of holders of a shared endpoint info, see shareEdgeEndpointInfo.
+         0 for an endpoint info with a single owner.*/
+    uint32_t refCount;
+
+    /**< Id of the client session of the endpoint, set when the session is connected.
+         Requests with the id are routed to the session without resolving endpointUri.
+         0 if unknown.*/
+    uint32_t sessionId;
 } EdgeEndPointInfo;
 
 /**
@@ -482,6 +491,25 @@ typedef struct EdgeContinuationPointList
     EdgeContinuationPoint **cp;
 } EdgeContinuationPointList;
 
+/**
+  * @brief Enum which represents the scheduling class of a message.
+  * Higher classes are dispatched more often, but every class keeps making progress.
+  *
+  */
+typedef enum
+{
+    /**< Derived from the command and message type */
+    EDGE_PRIORITY_DEFAULT = 0,
+    /**< Control: writes and client/server start and stop */
+    EDGE_PRIORITY_CONTROL = 1,
+    /**< Reads and method calls */
+    EDGE_PRIORITY_READ = 2,
+    /**< Subscription management and reports */
+    EDGE_PRIORITY_SUBSCRIPTION = 3,
+    /**< Browse and discovery */
+    EDGE_PRIORITY_BROWSE = 4
+} EdgeMessagePriority;
+
 /**
   * @brief Structure which represents the request and response data
   *
@@ -532,6 +560,15 @@ typedef struct EdgeMessage
 
     /**< Server Time Stamp **/
     struct timeval serverTime;
+
+    /**< Scheduling class in the send and receive queues **/
+    EdgeMessagePriority priority;
+
+    /**< Monotonic time in microseconds at which the message was queued, set by the queues **/
+    uint64_t queuedTime;
+
+    /**< Arena holding the message and its members, NULL if they are allocated from the heap **/
+    struct EdgeArena *arena;
 } EdgeMessage;
 
 #ifdef __cplusplus
@@ -166,6 +166,171 @@ typedef struct DiscoveryCallback
     device_found_cb_t device_found_cb;
 } DiscoveryCallback;
 
+/**
+ * @brief Enum which represents what sendRequest does when the send queue is full
+ *
+ */
+typedef enum
+{
+    /**< Fail with STATUS_ENQUEUE_ERROR */
+    EDGE_QUEUE_FULL_REJECT = 0,
+    /**< Wait up to sendQueueTimeoutMs for room, then fail with STATUS_ENQUEUE_ERROR.
+     * A request sent from a send queue worker fails at once, it would wait for itself */
+    EDGE_QUEUE_FULL_BLOCK = 1,
+    /**< Drop the oldest queued request of the same command. Its sender gets an ERROR response */
+    EDGE_QUEUE_FULL_DROP_OLDEST = 2
+} EdgeQueueFullPolicy;
+
+/**
+ * @brief Structure which counts how often the send queue full policy was applied
+ *
+ */
+typedef struct EdgeSendQueueStats
+{
+    /**< Requests rejected because the queue was full */
+    size_t rejected;
+
+    /**< Requests which had to wait for room */
+    size_t blocked;
+
+    /**< Requests which waited for room and timed out */
+    size_t blockTimeouts;
+
+    /**< Queued requests dropped to make room */
+    size_t dropped;
+} EdgeSendQueueStats;
+
+/**
+ * @brief Structure which summarizes a time histogram, all times in microseconds
+ *
+ */
+typedef struct EdgeLatencyStats
+{
+    /**< Number of recorded times */
+    size_t count;
+
+    /**< Mean time */
+    uint64_t meanUs;
+
+    /**< Median time */
+    uint64_t p50Us;
+
+    /**< 90th percentile */
+    uint64_t p90Us;
+
+    /**< 99th percentile */
+    uint64_t p99Us;
+
+    /**< Highest time */
+    uint64_t maxUs;
+} EdgeLatencyStats;
+
+/**
+ * @brief Structure which contains the statistics of one dispatcher queue
+ *
+ */
+typedef struct EdgeQueueStats
+{
+    /**< Number of messages queued and not yet processed */
+    size_t depth;
+
+    /**< Highest depth since the last reset */
+    size_t depthHighWatermark;
+
+    /**< Number of messages queued since the last reset */
+    size_t enqueued;
+
+    /**< Number of messages dropped since the last reset because the queue was full or
+         stopped. Reports dropped from the receive queue are lost */
+    size_t dropped;
+
+    /**< Time from queueing a message to the start of its processing */
+    EdgeLatencyStats waitTime;
+
+    /**< Time spent processing a message */
+    EdgeLatencyStats serviceTime;
+} EdgeQueueStats;
+
+/**
+ * @brief Structure which contains the statistics of the send and receive queues
+ *
+ */
+typedef struct EdgeDispatcherStats
+{
+    /**< Requests going to the servers */
+    EdgeQueueStats sendQueue;
+
+    /**< Responses and reports going to the application */
+    EdgeQueueStats receiveQueue;
+
+    /**< Number of requests queued since the last reset, indexed by EdgeCommand */
+    size_t commandCounts[EDGE_COMMAND_COUNT];
+} EdgeDispatcherStats;
+
+/**
+ * @brief Structure which contains the statistics of the pool recycling the memory of
+ *        responses and reports
+ *
+ */
+typedef struct EdgeMessagePoolStats
+{
+    /**< Number of messages whose memory was taken from the pool */
+    uint64_t hits;
+
+    /**< Number of messages whose memory had to be allocated */
+    uint64_t misses;
+
+    /**< hits / (hits + misses), 0 before the first message */
+    double hitRate;
+
+    /**< Number of free message arenas shared between the threads */
+    size_t freeArenas;
+} EdgeMessagePoolStats;
+
+/** Number of TAGs the allocation accounting tells apart; further ones share the last entry. */
+#define EDGE_MEMORY_MAX_TAGS 48
+
+/**
+ * @brief Structure which contains the memory allocated under one TAG
+ *
+ */
+typedef struct EdgeMemoryTagStats
+{
+    /**< TAG of the files allocating the memory */
+    const char *tag;
+
+    /**< Number of bytes currently allocated */
+    size_t liveBytes;
+
+    /**< Number of allocations not freed yet */
+    size_t liveCount;
+
+    /**< Highest number of bytes allocated at once */
+    size_t peakBytes;
+
+    /**< Number of allocations made so far */
+    uint64_t allocations;
+} EdgeMemoryTagStats;
+
+/**
+ * @brief Structure which contains the memory allocated by the library, per TAG
+ *
+ */
+typedef struct EdgeMemoryStats
+{
+    /**< Statistics of each TAG */
+    EdgeMemoryTagStats tags[EDGE_MEMORY_MAX_TAGS];
+
+    /**< Number of valid entries in tags */
+    size_t tagCount;
+
+    /**< Number of bytes currently allocated */
+    size_t liveBytes;
+
+    /**< Highest number of bytes allocated at once */
+    size_t peakBytes;
+} EdgeMemoryStats;
+
 /**
  * @brief EdgeConfigure structure which contains the initial configuration for client/server
  *
@@ -186,6 +351,35 @@ typedef struct EdgeConfigure
 
     /**< Discovery Callback.*/
     DiscoveryCallback *discoveryCallback;
+
+    /**< Maximum number of requests waiting in the send queue. 0 means unbounded.*/
+    size_t sendQueueCapacity;
+
+    /**< Behaviour of sendRequest when the send queue is full.*/
+    EdgeQueueFullPolicy sendQueueFullPolicy;
+
+    /**< Time to wait for room with EDGE_QUEUE_FULL_BLOCK in milliseconds. 0 waits without limit.*/
+    uint32_t sendQueueTimeoutMs;
+
+    /**< Maximum number of queued read requests of one endpoint sent in a single ReadRequest.
+         0 or 1 disables read coalescing.*/
+    size_t readCoalesceMaxMessages;
+
+    /**< Time to wait for more read requests to coalesce in milliseconds. 0 only coalesces
+         requests which are already queued.*/
+    uint32_t readCoalesceWindowMs;
+
+    /**< Number of client sessions opened to each endpoint. Reads, writes and method calls
+         are sent on the least loaded session, browsing and subscriptions stay on the first
+         one. Reads and method calls of an endpoint may then complete out of order, and a
+         write may complete before reads sent earlier. Reads and method calls sent while a
+         write or another request of the endpoint is pending run after it.
+         0 or 1 opens a single session.*/
+    size_t sessionsPerEndpoint;
+
+    /**< Time in milliseconds for which getEndpointInfo and findServers reuse the result of
+         a server instead of asking it again. 0 disables the discovery cache.*/
+    uint32_t discoveryCacheTtlMs;
 } EdgeConfigure_t;
 
 #ifdef __cplusplus
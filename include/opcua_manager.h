@@ -52,6 +52,7 @@ typedef struct EdgeApplicationConfig EdgeApplicationConfig;
 typedef struct EdgeBrowseParameter EdgeBrowseParameter;
 
 void onSendMessage(EdgeMessage* msg);
+void onSendMessages(EdgeMessage **msgs, size_t count);
 void onResponseMessage(EdgeMessage *msg);
 void onStatusCallback(EdgeEndPointInfo *epInfo, EdgeStatusCode status);
 void onDiscoveryCallback(EdgeDevice *device);
@@ -101,6 +102,30 @@ EXPORT EdgeResult findServers(const char *endpointUri, size_t serverUrisSize,
  */
 EXPORT EdgeResult getEndpointInfo(EdgeMessage *msg);
 
+/**
+ * @brief Removes the cached results of getEndpointInfo and findServers
+ * @remarks The cache is enabled with EdgeConfigure.discoveryCacheTtlMs. The next lookup asks
+ *          the server again.
+ * @param[in]  endpointUri Endpoint whose results are removed. NULL removes all results.
+ */
+EXPORT void invalidateDiscoveryCache(const char *endpointUri);
+
+/**
+ * @brief Connects the client to several servers at the same time
+ * @remarks Blocks until every endpoint is connected or has failed. STATUS_CLIENT_STARTED is
+ *          reported through the status callback for each endpoint as soon as it is connected.
+ *          Unlike a CMD_START_CLIENT request, the connects do not wait in the send queue.
+ * @param[in]  endpoints End point information of each server.
+ * @param[in]  count Number of servers.
+ * @param[in]  timeoutMs Maximum time for each step of a connect (TCP connect, secure channel
+ *             and session) in milliseconds. 0 or less uses the default client timeout.
+ * @return @c EdgeResult code is 0 on success, otherwise an error value
+ * @retval #STATUS_OK All servers connected
+ * @retval #STATUS_PARAM_INVALID Invalid parameter
+ * @retval #STATUS_ERROR One or more servers could not be connected
+ */
+EXPORT EdgeResult connectClients(EdgeEndPointInfo **endpoints, size_t count, int timeoutMs);
+
 /**
  * @brief Disconnect the client connection
  * @param[in]  epInfo End point information for server.
@@ -113,6 +138,51 @@ EXPORT void disconnectClient(EdgeEndPointInfo *epInfo);
  */
 EXPORT void configure(EdgeConfigure *config);
 
+/**
+ * @brief Gets how often the send queue full policy was applied since configure.
+ * @param[out]  stats Send queue counters.
+ * @return @c EdgeResult code is 0 on success, otherwise an error value
+ * @retval #STATUS_OK Successful
+ * @retval #STATUS_PARAM_INVALID Invalid parameter
+ */
+EXPORT EdgeResult getSendQueueStats(EdgeSendQueueStats *stats);
+
+/**
+ * @brief Gets the depth, wait time and service time statistics of the send and receive queues
+ * @param[out]  stats Dispatcher statistics
+ * @return @c EdgeResult code is 0 on success, otherwise an error value
+ * @retval #STATUS_OK Successful
+ * @retval #STATUS_PARAM_INVALID Invalid parameter
+ */
+EXPORT EdgeResult getDispatcherStats(EdgeDispatcherStats *stats);
+
+/**
+ * @brief Restarts the statistics returned by getDispatcherStats
+ * @remarks The current queue depths are kept and become the new high watermarks.
+ */
+EXPORT void resetDispatcherStats(void);
+
+/**
+ * @brief Gets the hit rate of the pool recycling the memory of responses and reports
+ * @param[out]  stats Message pool statistics
+ * @return @c EdgeResult code is 0 on success, otherwise an error value
+ * @retval #STATUS_OK Successful
+ * @retval #STATUS_PARAM_INVALID Invalid parameter
+ */
+EXPORT EdgeResult getMessagePoolStats(EdgeMessagePoolStats *stats);
+
+/**
+ * @brief Gets the memory allocated by the library per TAG
+ * @remarks Only available when the library is built with MEMORY_STATS=1. The memory still
+ *          allocated is also logged when the library is unloaded.
+ * @param[out]  stats Memory statistics
+ * @return @c EdgeResult code is 0 on success, otherwise an error value
+ * @retval #STATUS_OK Successful
+ * @retval #STATUS_PARAM_INVALID Invalid parameter
+ * @retval #STATUS_NOT_SUPPORT Built without allocation accounting
+ */
+EXPORT EdgeResult getEdgeMemoryStats(EdgeMemoryStats *stats);
+
 /**
  * @brief Add a new namespace to the server.
  * @param[in]  name Namespace name/URI
@@ -219,14 +289,53 @@ EXPORT void showNodeList(void);
 
 /**
  * @brief Send the EdgeMessage request to queue for processing
+ * @remarks When the send queue is full, EdgeConfigure::sendQueueFullPolicy applies.
  * @param[in]  msg EdgeMessage request data
  * @return @c EdgeResult code is 0 on success, otherwise an error value
  * @retval #STATUS_OK Successful
  * @retval #STATUS_PARAM_INVALID Invalid parameter
  * @retval #STATUS_ERROR Operation failed
+ * @retval #STATUS_ENQUEUE_ERROR Send queue is full
  */
 EXPORT EdgeResult sendRequest(EdgeMessage* msg);
 
+/**
+ * @brief Send the EdgeMessage request to queue for processing without copying it
+ * @remarks Unlike sendRequest, the message itself is queued and freed by the library
+ *          once it is processed, so it must be freeable with destroyEdgeMessage (e.g.
+ *          built with createEdgeMessage). Once the parameters are valid, the library owns
+ *          the message and *msg is set to NULL, also when it cannot be queued. On
+ *          STATUS_PARAM_INVALID the caller keeps ownership.
+ * @param[in,out]  msg EdgeMessage request data
+ * @return @c EdgeResult code is 0 on success, otherwise an error value
+ * @retval #STATUS_OK Successful
+ * @retval #STATUS_PARAM_INVALID Invalid parameter
+ * @retval #STATUS_ENQUEUE_ERROR Send queue is full
+ */
+EXPORT EdgeResult sendRequestMove(EdgeMessage **msg);
+
+/**
+ * @brief Execute a read, write or method request on the calling thread and return its response
+ * @remarks The request bypasses the send and receive queues. It waits for the requests of
+ *          the same endpoint which are already running, but not for queued ones. The
+ *          response does not go to the registered callbacks. When only some of the nodes
+ *          fail, resp holds the response of the other nodes and the errors of the failed
+ *          nodes are discarded.
+ * @param[in]  req EdgeMessage request data (CMD_READ, CMD_READ_SAMPLING_INTERVAL, CMD_WRITE
+ *             or CMD_METHOD)
+ * @param[out]  resp Response or error message. Free it with destroyEdgeMessage.
+ * @param[in]  timeoutMs Maximum time to wait for the endpoint session in milliseconds.
+ *             0 or less waits without limit. The service call itself is bounded by the
+ *             client timeout.
+ * @return @c EdgeResult code is 0 on success, otherwise an error value
+ * @retval #STATUS_OK Successful
+ * @retval #STATUS_PARAM_INVALID Invalid parameter
+ * @retval #STATUS_NOT_SUPPORT The command cannot run synchronously
+ * @retval #STATUS_TIMEOUT The session stayed busy for timeoutMs
+ * @retval #STATUS_ERROR Operation failed
+ */
+EXPORT EdgeResult sendRequestSync(EdgeMessage *req, EdgeMessage **resp, int timeoutMs);
+
 /**
  * @brief Deallocates the dynamic memory for EdgeResult. \n
                   Behaviour is undefined if EdgeResult is not dynamically allocated.
@@ -241,6 +350,13 @@ EXPORT void destroyEdgeResult(EdgeResult *res);
  */
 EXPORT void destroyEdgeVersatility(EdgeVersatility *versatileValue);
 
+/**
+ * @brief Gets the EdgeVersatility layout the library was built with. Applications compare it
+ *        with EDGE_VERSATILITY_ABI_VERSION to detect a mismatched header.
+ * @return EDGE_VERSATILITY_ABI_VERSION of the library
+ */
+EXPORT int getEdgeVersatilityAbiVersion();
+
 /**
  * @brief Deallocates the dynamic memory for EdgeArgument. \n
                    Behaviour is undefined if EdgeArgument is not dynamically allocated.
@@ -410,6 +526,20 @@ EXPORT EdgeMessage* createEdgeAttributeMessage(const char *endpointUri,
  */
 EXPORT EdgeMessage* createEdgeMessage(const char *endpointUri, size_t requestSize, EdgeCommand cmd);
 
+/**
+ * @brief Create EdgeMessage whose members are allocated from a single arena
+ * @remarks The message and everything the insert functions add to it are taken from one
+ *          memory region, released at once by destroyEdgeMessage. Values attached by the
+ *          application (e.g. write values) are still freed individually.
+ * @param[in]  endpointUri Endpoint Uri
+ * @param[in]  requestSize request size
+ * @param[in]  cmd command type
+ * @return EdgeMessage object on success
+ *                  NULL in case of error
+ */
+EXPORT EdgeMessage* createEdgeArenaMessage(const char *endpointUri, size_t requestSize,
+        EdgeCommand cmd);
+
 /**
  * @brief Insert Read Access to the EdgeMessage request data
  * @param[in]  msg EdgeMessage request
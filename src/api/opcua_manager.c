@@ -22,6 +22,7 @@
 #include "edge_opcua_server.h"
 #include "edge_opcua_client.h"
 #include "message_dispatcher.h"
+#include "cmd_util.h"
 #include "edge_logger.h"
 #include "edge_utils.h"
 #include "edge_open62541.h"
@@ -76,9 +77,61 @@ void configure(EdgeConfigure *config)
 
     registerClientCallback(onResponseMessage, onStatusCallback, onDiscoveryCallback);
     registerServerCallback(onStatusCallback);
+    configureSendQueue(config->sendQueueCapacity, config->sendQueueFullPolicy,
+            config->sendQueueTimeoutMs);
+    configureReadCoalescing(config->readCoalesceMaxMessages, config->readCoalesceWindowMs,
+            onSendMessages);
+    configureSessionPool(config->sessionsPerEndpoint);
+    configureSendLanes(config->sessionsPerEndpoint);
+    configureDiscoveryCache(config->discoveryCacheTtlMs);
     registerMQCallback(onResponseMessage, onSendMessage);
 }
 
+EdgeResult getSendQueueStats(EdgeSendQueueStats *stats)
+{
+    EdgeResult result;
+    result.code = STATUS_PARAM_INVALID;
+    VERIFY_NON_NULL_MSG(stats, "NULL stats param in getSendQueueStats\n", result);
+    result.code = getSendQueueFullStats(stats) ? STATUS_OK : STATUS_ERROR;
+    return result;
+}
+
+EdgeResult getDispatcherStats(EdgeDispatcherStats *stats)
+{
+    EdgeResult result;
+    result.code = STATUS_PARAM_INVALID;
+    VERIFY_NON_NULL_MSG(stats, "NULL stats param in getDispatcherStats\n", result);
+    getMQStats(stats);
+    result.code = STATUS_OK;
+    return result;
+}
+
+void resetDispatcherStats(void)
+{
+    resetMQStats();
+}
+
+EdgeResult getMessagePoolStats(EdgeMessagePoolStats *stats)
+{
+    EdgeResult result;
+    result.code = STATUS_PARAM_INVALID;
+    VERIFY_NON_NULL_MSG(stats, "NULL stats param in getMessagePoolStats\n", result);
+    EdgeMessageArenaPoolStats(&stats->hits, &stats->misses, &stats->freeArenas);
+    uint64_t total = stats->hits + stats->misses;
+    stats->hitRate = (total > 0) ? (double) stats->hits / (double) total : 0;
+    result.code = STATUS_OK;
+    return result;
+}
+
+EdgeResult getEdgeMemoryStats(EdgeMemoryStats *stats)
+{
+    EdgeResult result;
+    result.code = STATUS_PARAM_INVALID;
+    VERIFY_NON_NULL_MSG(stats, "NULL stats param in getEdgeMemoryStats\n", result);
+    result.code = EdgeMemoryGetStats(stats) ? STATUS_OK : STATUS_NOT_SUPPORT;
+    return result;
+}
+
 EdgeResult createNamespace(const char *name, const char *rootNodeId, const char *rootBrowseName,
 		const char *rootDisplayName)
 {
@@ -163,11 +216,36 @@ EdgeResult findServers(const char *endpointUri, size_t serverUrisSize, unsigned
             registeredServersSize, registeredServers);
 }
 
+void invalidateDiscoveryCache(const char *endpointUri)
+{
+    clearDiscoveryCache(endpointUri);
+}
+
+EdgeResult connectClients(EdgeEndPointInfo **endpoints, size_t count, int timeoutMs)
+{
+    EdgeResult result;
+    if (IS_NULL(endpoints) || 0 == count)
+    {
+        result.code = STATUS_PARAM_INVALID;
+        return result;
+    }
+
+    EDGE_LOG_V(TAG, "[Received command] :: Connect %zu clients.\n", count);
+    size_t connected = connect_clients(endpoints, count, timeoutMs);
+    EDGE_LOG_V(TAG, "%zu of %zu clients connected.\n", connected, count);
+    result.code = (connected == count) ? STATUS_OK : STATUS_ERROR;
+    return result;
+}
+
 void disconnectClient(EdgeEndPointInfo *epInfo)
 {
     VERIFY_NON_NULL_NR_MSG(epInfo, "NULL param epINfo in dosconnect client\n");
     EDGE_LOG(TAG, "[Received command] :: Client disconnect.");
-    disconnect_client(epInfo);
+    if (disconnect_client(epInfo))
+    {
+        /* Delete all the messages in send and receiver queue */
+        delete_queue();
+    }
 }
 
 EdgeNodeItem* createVariableNodeItem(const char* name, int type, void* data,
@@ -206,6 +284,11 @@ void destroyEdgeVersatility(EdgeVersatility *versatileValue)
     freeEdgeVersatility(versatileValue);
 }
 
+int getEdgeVersatilityAbiVersion()
+{
+    return EDGE_VERSATILITY_ABI_VERSION;
+}
+
 void destroyEdgeNodeId(EdgeNodeId *nodeId)
 {
     freeEdgeNodeId(nodeId);
@@ -352,6 +435,37 @@ EdgeResult sendRequest(EdgeMessage* msg)
     return result;
 }
 
+EdgeResult sendRequestMove(EdgeMessage **msg)
+{
+    EdgeResult result;
+    result.code = STATUS_PARAM_INVALID;
+    VERIFY_NON_NULL_MSG(msg, "NULL param EdgeMessage in sendRequestMove\n", result);
+    result = checkParameterValid(*msg);
+    if (result.code == STATUS_OK)
+    {
+        // add_to_sendQ owns the message from here on, even when it fails.
+        EdgeMessage *queued = *msg;
+        *msg = NULL;
+        bool ret = add_to_sendQ(queued);
+        result.code = (ret ? STATUS_OK : STATUS_ENQUEUE_ERROR);
+    }
+    return result;
+}
+
+EdgeResult sendRequestSync(EdgeMessage *req, EdgeMessage **resp, int timeoutMs)
+{
+    EdgeResult result;
+    result.code = STATUS_PARAM_INVALID;
+    VERIFY_NON_NULL_MSG(resp, "NULL response param in sendRequestSync\n", result);
+    *resp = NULL;
+    result = checkParameterValid(req);
+    if (result.code == STATUS_OK)
+    {
+        result = executeRequestSync(req, resp, timeoutMs);
+    }
+    return result;
+}
+
 void onSendMessage(EdgeMessage* msg)
 {
     if (CMD_START_SERVER == msg->command)
@@ -371,7 +485,7 @@ void onSendMessage(EdgeMessage* msg)
     else if (CMD_START_CLIENT == msg->command)
     {
         EDGE_LOG(TAG, "\n[Received command] :: START CLIENT \n");
-        bool result = connect_client(msg->endpointInfo->endpointUri);
+        bool result = connect_client(msg->endpointInfo);
         if (!result)
         {
             return;
@@ -421,6 +535,20 @@ void onSendMessage(EdgeMessage* msg)
     }
 }
 
+void onSendMessages(EdgeMessage **msgs, size_t count)
+{
+    EDGE_LOG_V(TAG, "\n[Received command] :: READ (%zu requests) \n", count);
+    EdgeResult result = readNodesFromServerBatch(msgs, count);
+    if (STATUS_OK != result.code)
+    {
+        /* The batch failed before any response was sent */
+        for (size_t i = 0; i < count; i++)
+        {
+            sendErrorResponse(msgs[i], "Error in read operation");
+        }
+    }
+}
+
 void onResponseMessage(EdgeMessage *msg)
 {
     VERIFY_NON_NULL_NR_MSG(receivedMsgCb, "NULL receivedMsgCb in onResponseMessage\n");
@@ -524,6 +652,12 @@ EdgeNodeInfo* createEdgeNodeInfo(const char* nodeName)
     return nodeInfo;
 }
 
+/* Members inserted into a message come from its arena, if it has one. */
+static EdgeArena *enterMessageArena(EdgeMessage **msg)
+{
+    return EdgeArenaEnter((msg && *msg) ? (*msg)->arena : NULL);
+}
+
 EdgeResult insertSubParameter(EdgeMessage **msg, const char* nodeName, EdgeNodeType subType,
         double samplingInterval, double publishingInterval, int maxKeepAliveCount,
         int lifetimeCount, int maxNotificationsPerPublish, bool publishingEnabled, int priority,
@@ -531,6 +665,7 @@ EdgeResult insertSubParameter(EdgeMessage **msg, const char* nodeName, EdgeNodeT
 {
     EdgeResult result;
     result.code = STATUS_OK;
+    EdgeArena *previous = enterMessageArena(msg);
     if (IS_NULL((*msg)) || IS_NULL(nodeName))
     {
         EDGE_LOG(TAG, "Error : parameter is not valid");
@@ -605,7 +740,9 @@ EdgeResult insertSubParameter(EdgeMessage **msg, const char* nodeName, EdgeNodeT
         (*msg)->requestLength = 1;
     }
 
-    EXIT: return result;
+    EXIT:
+    EdgeArenaLeave(previous);
+    return result;
 }
 
 EdgeMessage* createEdgeSubMessage(const char *endpointUri, const char* nodeName, size_t requestSize,
@@ -743,10 +880,31 @@ EdgeMessage* createEdgeMessage(const char *endpointUri, size_t requestSize, Edge
     return msg;
 }
 
+EdgeMessage* createEdgeArenaMessage(const char *endpointUri, size_t requestSize, EdgeCommand cmd)
+{
+    VERIFY_NON_NULL_MSG(endpointUri, "NULL endpointUri param in createEdgeArenaMessage\n", NULL);
+
+    EdgeArena *arena = EdgeMessageArenaCreate();
+    VERIFY_NON_NULL_MSG(arena, "EdgeMessageArenaCreate failed in createEdgeArenaMessage\n", NULL);
+
+    EdgeArena *previous = EdgeArenaEnter(arena);
+    EdgeMessage *msg = createEdgeMessage(endpointUri, requestSize, cmd);
+    EdgeArenaLeave(previous);
+
+    if (IS_NULL(msg))
+    {
+        EdgeArenaDestroy(arena);
+        return NULL;
+    }
+    msg->arena = arena;
+    return msg;
+}
+
 EdgeResult insertReadAccessNode(EdgeMessage **msg, const char* nodeName)
 {
     EdgeResult result;
     result.code = STATUS_OK;
+    EdgeArena *previous = enterMessageArena(msg);
     if (IS_NULL((*msg)) || IS_NULL(nodeName))
     {
         EDGE_LOG(TAG, "Error : parameter is not valid");
@@ -773,7 +931,9 @@ EdgeResult insertReadAccessNode(EdgeMessage **msg, const char* nodeName)
     }
     (*msg)->requestLength = ++index;
 
-    EXIT: return result;
+    EXIT:
+    EdgeArenaLeave(previous);
+    return result;
 }
 
 EdgeResult insertWriteAccessNode(EdgeMessage **msg, const char* nodeName, void* value,
@@ -781,6 +941,7 @@ EdgeResult insertWriteAccessNode(EdgeMessage **msg, const char* nodeName, void*
 {
     EdgeResult result;
     result.code = STATUS_OK;
+    EdgeArena *previous = enterMessageArena(msg);
     if (IS_NULL((*msg)) || IS_NULL(nodeName))
     {
         EDGE_LOG(TAG, "Error : parameter is not valid");
@@ -815,7 +976,7 @@ EdgeResult insertWriteAccessNode(EdgeMessage **msg, const char* nodeName, void*
 
     (*msg)->requests[index]->type = getValueType(nodeName);
 
-    EdgeVersatility* varient = (EdgeVersatility*) malloc(sizeof(EdgeVersatility));
+    EdgeVersatility* varient = (EdgeVersatility*) EdgeMalloc(sizeof(EdgeVersatility));
     if (IS_NULL(varient))
     {
         EDGE_LOG(TAG, "Error : EdgeMalloc failed for varient");
@@ -837,7 +998,9 @@ EdgeResult insertWriteAccessNode(EdgeMessage **msg, const char* nodeName, void*
 
     (*msg)->requestLength = ++index;
 
-    EXIT: return result;
+    EXIT:
+    EdgeArenaLeave(previous);
+    return result;
 }
 
 EdgeResult insertEdgeMethodParameter(EdgeMessage **msg, const char* nodeName,
@@ -846,6 +1009,7 @@ EdgeResult insertEdgeMethodParameter(EdgeMessage **msg, const char* nodeName,
 {
     EdgeResult result;
     result.code = STATUS_OK;
+    EdgeArena *previous = enterMessageArena(msg);
 
     if (IS_NULL((*msg)) || IS_NULL(nodeName))
     {
@@ -886,7 +1050,7 @@ EdgeResult insertEdgeMethodParameter(EdgeMessage **msg, const char* nodeName,
     if (0 == inputParameterSize)
     {
         request->methodParams->num_inpArgs = 0;
-        return result;
+        goto EXIT;
     }
 
     if (NULL == request->methodParams->inpArg)
@@ -918,7 +1082,9 @@ EdgeResult insertEdgeMethodParameter(EdgeMessage **msg, const char* nodeName,
     request->methodParams->inpArg[num_inpArgs]->arrayLength = arrayLength;
 
     request->methodParams->num_inpArgs = ++num_inpArgs;
-    EXIT: return result;
+    EXIT:
+    EdgeArenaLeave(previous);
+    return result;
 }
 
 EdgeResult insertBrowseParameter(EdgeMessage **msg, EdgeNodeInfo* nodeInfo,
@@ -926,6 +1092,7 @@ EdgeResult insertBrowseParameter(EdgeMessage **msg, EdgeNodeInfo* nodeInfo,
 {
     EdgeResult result;
     result.code = STATUS_OK;
+    EdgeArena *previous = enterMessageArena(msg);
 
     if (IS_NULL((*msg)) || IS_NULL(nodeInfo))
     {
@@ -981,7 +1148,9 @@ EdgeResult insertBrowseParameter(EdgeMessage **msg, EdgeNodeInfo* nodeInfo,
     (*msg)->browseParam->direction = parameter.direction;
     (*msg)->browseParam->maxReferencesPerNode = parameter.maxReferencesPerNode;
 
-    EXIT: return result;
+    EXIT:
+    EdgeArenaLeave(previous);
+    return result;
 }
 
 void destroyBrowseNextDataElements(EdgeBrowseNextData *data)
@@ -1029,7 +1198,7 @@ EdgeBrowseNextData* initBrowseNextData(EdgeBrowseNextData *browseNextData,
         return NULL;
     }
 
-    browseNextData->srcNodeId = (EdgeNodeId **) calloc(browseNextData->count, sizeof(EdgeNodeId *));
+    browseNextData->srcNodeId = (EdgeNodeId **) EdgeCalloc(browseNextData->count, sizeof(EdgeNodeId *));
     if (NULL == browseNextData->srcNodeId)
     {
         EdgeFree(browseNextData->cp);
@@ -1087,7 +1256,7 @@ EdgeBrowseNextData *cloneBrowseNextData(EdgeBrowseNextData* browseNextData)
         EdgeFree(clone);
         return NULL;
     }
-    clone->srcNodeId = (EdgeNodeId **)calloc(clone->count, sizeof(EdgeNodeId *));
+    clone->srcNodeId = (EdgeNodeId **)EdgeCalloc(clone->count, sizeof(EdgeNodeId *));
     if(IS_NULL(clone->srcNodeId))
     {
         printf("Error :: EdgeCalloc Failed for clone->srcNodeId in cloneBrowseNextData \n");
@@ -85,7 +85,7 @@ static NodesToBrowse_t *initNodesToBrowse(size_t size)
             return NULL;
         }
 
-        browseNodesInfo->browseName = (unsigned char **) calloc(size, sizeof(unsigned char *));
+        browseNodesInfo->browseName = (unsigned char **) EdgeCalloc(size, sizeof(unsigned char *));
         if (IS_NULL(browseNodesInfo->browseName))
         {
             EDGE_LOG(TAG, "Memory allocation failed for browseNodesInfo->browseName.");
@@ -138,7 +138,7 @@ static EdgeContinuationPointList *getContinuationPointList(UA_String *uaStr)
     VERIFY_NON_NULL_MSG(cpList, "EdgeCalloc FAILED for EdgeContinuationPointList\n", NULL);
 
     cpList->count = 1;
-    cpList->cp = (EdgeContinuationPoint **) calloc(cpList->count, sizeof(EdgeContinuationPoint *));
+    cpList->cp = (EdgeContinuationPoint **) EdgeCalloc(cpList->count, sizeof(EdgeContinuationPoint *));
     if (!cpList->cp)
     {
         freeEdgeContinuationPointList(cpList);
@@ -478,7 +478,7 @@ static void invokeResponseCb(EdgeMessage *msg, int msgId, EdgeNodeId *srcNodeId,
 
     resultMsg->type = BROWSE_RESPONSE;
     resultMsg->message_id = msg->message_id;
-    resultMsg->endpointInfo = cloneEdgeEndpointInfo(msg->endpointInfo);
+    resultMsg->endpointInfo = shareEdgeEndpointInfo(msg->endpointInfo);
     if (IS_NULL(resultMsg->endpointInfo))
     {
         EDGE_LOG(TAG, "Failed to clone the EdgeEndpointInfo.");
@@ -569,7 +569,7 @@ static void invokeResponseCbForContinuationPoint(EdgeMessage *msg, int msgId, Ed
         return;
     }
 
-    resultMsg->endpointInfo = cloneEdgeEndpointInfo(msg->endpointInfo);
+    resultMsg->endpointInfo = shareEdgeEndpointInfo(msg->endpointInfo);
     if (!resultMsg->endpointInfo)
     {
         EDGE_LOG(TAG, "Failed to clone the EdgeEndpointInfo.");
@@ -594,7 +594,7 @@ static void invokeResponseCbForContinuationPoint(EdgeMessage *msg, int msgId, Ed
     }
     response->nodeInfo->nodeId = cloneEdgeNodeId(srcNodeId);
     response->requestId = msgId; // Response for msgId'th request.
-    EdgeResponse **responses = (EdgeResponse **) calloc(1, sizeof(EdgeResponse *));
+    EdgeResponse **responses = (EdgeResponse **) EdgeCalloc(1, sizeof(EdgeResponse *));
     if (IS_NULL(responses))
     {
         EDGE_LOG(TAG, "Memory allocation failed.");
@@ -1021,7 +1021,7 @@ static EdgeMessage *prepareEdgeMessageForBrowseView(EdgeMessage *msg, List *view
 
     size_t size = getListSize(viewNodeList);
 
-    EdgeRequest **request = (EdgeRequest **)calloc(size, sizeof(EdgeRequest *));
+    EdgeRequest **request = (EdgeRequest **)EdgeCalloc(size, sizeof(EdgeRequest *));
     if(IS_NULL(request))
     {
         goto ERROR;
@@ -1059,7 +1059,7 @@ static EdgeMessage *prepareEdgeMessageForBrowseView(EdgeMessage *msg, List *view
         ptr = ptr->link;
     }
 
-    browseViewMsg->requests = (EdgeRequest **)calloc(idx, sizeof(EdgeRequest *));
+    browseViewMsg->requests = (EdgeRequest **)EdgeCalloc(idx, sizeof(EdgeRequest *));
     if(IS_NULL(browseViewMsg->requests))
     {
         goto ERROR;
@@ -1228,8 +1228,12 @@ static EdgeStatusCode browse(UA_Client *client, EdgeMessage *msg, bool browseNex
             continue;
         }
 
-        nextReqIdList = (int *) calloc(resp->results[i].referencesSize, sizeof(int));
-        if (IS_NULL(nextReqIdList))
+        nextReqIdList = NULL;
+        if (resp->results[i].referencesSize > 0)
+        {
+            nextReqIdList = (int *) EdgeCalloc(resp->results[i].referencesSize, sizeof(int));
+        }
+        if (resp->results[i].referencesSize > 0 && IS_NULL(nextReqIdList))
         {
             EDGE_LOG(TAG, "Memory allocation failed.");
             statusCode = STATUS_INTERNAL_ERROR;
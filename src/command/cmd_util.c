@@ -128,14 +128,21 @@ int get_response_type(const UA_DataType *datatype)
 
 void sendErrorResponse(const EdgeMessage *msg, char *err_desc)
 {
+    // The error message outlives the arena of the message being processed, if any.
+    EdgeArena *previous = EdgeArenaEnter(NULL);
     EdgeMessage *resultMsg = (EdgeMessage *) EdgeCalloc(1, sizeof(EdgeMessage));
-    VERIFY_NON_NULL_NR_MSG(resultMsg, "EdgeCalloc FAILED for EdgeMessage in sendErrorResponse\n");
-    resultMsg->endpointInfo = cloneEdgeEndpointInfo(msg->endpointInfo);
+    if (IS_NULL(resultMsg))
+    {
+        EDGE_LOG(TAG, "EdgeCalloc FAILED for EdgeMessage in sendErrorResponse\n");
+        goto EXIT;
+    }
+    resultMsg->endpointInfo = shareEdgeEndpointInfo(msg->endpointInfo);
     resultMsg->type = ERROR;
+    resultMsg->priority = msg->priority;
     resultMsg->responseLength = 1;
     resultMsg->message_id = msg->message_id;
 
-    resultMsg->responses = (EdgeResponse **) malloc(sizeof(EdgeResponse *) * resultMsg->responseLength);
+    resultMsg->responses = (EdgeResponse **) EdgeMalloc(sizeof(EdgeResponse *) * resultMsg->responseLength);
     for (int i = 0; i < resultMsg->responseLength; i++)
     {
         resultMsg->responses[i] = (EdgeResponse*) EdgeCalloc(1, sizeof(EdgeResponse));
@@ -160,11 +167,15 @@ void sendErrorResponse(const EdgeMessage *msg, char *err_desc)
 
     /* Adding Error response message to receiver Q */
     add_to_recvQ(resultMsg);
-    return ;
+    resultMsg = NULL;
 
     EXIT:
     /* Free the memory */
-    freeEdgeMessage(resultMsg);
+    if (resultMsg)
+    {
+        freeEdgeMessage(resultMsg);
+    }
+    EdgeArenaLeave(previous);
 }
 
 EdgeDiagnosticInfo *checkDiagnosticInfo(int nodesToProcess,
@@ -122,7 +122,7 @@ EdgeResult executeMethod(UA_Client *client, const EdgeMessage *msg)
             goto EXIT;
         }
 
-        resultMsg->endpointInfo = cloneEdgeEndpointInfo(msg->endpointInfo);
+        resultMsg->endpointInfo = shareEdgeEndpointInfo(msg->endpointInfo);
         if(IS_NULL(resultMsg->endpointInfo))
         {
             EDGE_LOG(TAG, "Memory allocation failed.");
@@ -205,13 +205,11 @@ EdgeResult executeMethod(UA_Client *client, const EdgeMessage *msg)
                 }
                 else
                 {
-                    versatility->value = (void *) EdgeCalloc(1, size);
-                    if(IS_NULL(versatility->value))
+                    if(IS_NULL(setEdgeVersatilityScalar(versatility, output[i].data, size)))
                     {
                         EDGE_LOG(TAG, "Memory allocation failed.");
                         goto EXIT;
                     }
-                    memcpy(versatility->value, output[i].data, size);
                 }
             }
             else
@@ -248,65 +248,39 @@ static void *checkValidation(UA_DataValue *value, const EdgeMessage *msg, UA_Tim
 }
 
 /**
- * @brief readGroup - Executes read operation of single/group nodes
- * @param client - Client handle
+ * @brief readGroupResponse - Sends the response of one read message
  * @param msg - Request edge message
- * @param attributeId - Attribute Id to read
+ * @param attributeId - Attribute Id read
+ * @param readRequest - Read request sent to the server
+ * @param readResponse - Read response received from the server
+ * @param offset - Index of the first node of msg in readRequest
  */
-static void readGroup(UA_Client *client, const EdgeMessage *msg, UA_UInt32 attributeId)
+static void readGroupResponse(const EdgeMessage *msg, UA_UInt32 attributeId,
+        const UA_ReadRequest *readRequest, const UA_ReadResponse *readResponse, size_t offset)
 {
     char errorDesc[ERROR_DESC_LENGTH] = {'\0'};
     EdgeMessage *resultMsg = NULL;
+    EdgeArena *arena = NULL;
+    EdgeArena *previous = EdgeArenaEnter(NULL);
     size_t reqLen = msg->requestLength;
-    UA_ReadValueId *rv = (UA_ReadValueId *) EdgeMalloc(sizeof(UA_ReadValueId) * reqLen);
-    if(IS_NULL(rv))
-    {
-        EDGE_LOG(TAG, "Memory allocation failed.");
-        sendErrorResponse(msg, "Memory allocation failed.");
-        return;
-    }
+    UA_DataValue *results = readResponse->results + offset;
 
-    for (size_t i = 0; i < reqLen; i++)
+    /* Diagnostics are per node, so a coalesced request carries the ones of msg at offset */
+    UA_DiagnosticInfo *diagnosticInfos = readResponse->diagnosticInfos;
+    int diagnosticInfosSize = (int) readResponse->diagnosticInfosSize;
+    if (readResponse->diagnosticInfosSize == readRequest->nodesToReadSize)
     {
-        EDGE_LOG_V(TAG, "[READGROUP] Node to read :: %s\n", msg->requests[i]->nodeInfo->valueAlias);
-        UA_ReadValueId_init(&rv[i]);
-        rv[i].attributeId = attributeId;
-        rv[i].nodeId = UA_NODEID_STRING_ALLOC(msg->requests[i]->nodeInfo->nodeId->nameSpace,
-                msg->requests[i]->nodeInfo->valueAlias);
-    }
-
-    UA_ReadRequest readRequest;
-    UA_ReadRequest_init(&readRequest);
-    /* Nodes information to read */
-    readRequest.nodesToRead = rv;
-    /* Number of nodes to read */
-    readRequest.nodesToReadSize = reqLen;
-    /* Max age */
-    readRequest.maxAge = 2000;
-    /* Timestamp information requested from server */
-    readRequest.timestampsToReturn = UA_TIMESTAMPSTORETURN_BOTH;
-
-    //UA_RequestHeader_init(&(readRequest.requestHeader));
-    //readRequest.requestHeader.returnDiagnostics = 1;
-
-    UA_ReadResponse readResponse = UA_Client_Service_read(client, readRequest);
-
-    if (readResponse.responseHeader.serviceResult != UA_STATUSCODE_GOOD)
-    {
-        /* Error response in processing read request */
-        EDGE_LOG_V(TAG, "Error in group read :: 0x%08x(%s)\n", readResponse.responseHeader.serviceResult,
-                UA_StatusCode_name(readResponse.responseHeader.serviceResult));
-        strncpy(errorDesc, "Error in read.", ERROR_DESC_LENGTH);
-        goto EXIT;
+        diagnosticInfos += offset;
+        diagnosticInfosSize = (int) reqLen;
     }
 
-    if (readResponse.results[0].status == UA_STATUSCODE_GOOD)
+    if (results[0].status == UA_STATUSCODE_GOOD)
     {
         if(UA_ATTRIBUTEID_VALUE == attributeId) {
-            if (readRequest.timestampsToReturn == UA_TIMESTAMPSTORETURN_NEITHER)
+            if (readRequest->timestampsToReturn == UA_TIMESTAMPSTORETURN_NEITHER)
             {
-                if (readResponse.results[0].hasSourceTimestamp
-                        || readResponse.results[0].hasServerTimestamp)
+                if (results[0].hasSourceTimestamp
+                        || results[0].hasServerTimestamp)
                 {
                     /* Invalid timestamp error */
                     EDGE_LOG(TAG, "BadInvalidTimestamp\n\n");
@@ -314,10 +288,10 @@ static void readGroup(UA_Client *client, const EdgeMessage *msg, UA_UInt32 attri
                     goto EXIT;
                 }
             }
-            else if (readRequest.timestampsToReturn == UA_TIMESTAMPSTORETURN_BOTH)
+            else if (readRequest->timestampsToReturn == UA_TIMESTAMPSTORETURN_BOTH)
             {
-                if (!readResponse.results[0].hasSourceTimestamp
-                        || !readResponse.results[0].hasServerTimestamp)
+                if (!results[0].hasSourceTimestamp
+                        || !results[0].hasServerTimestamp)
                 {
                     /* Missing timestamp information in response */
                     EDGE_LOG(TAG, "Timestamp missing\n\n");
@@ -325,10 +299,10 @@ static void readGroup(UA_Client *client, const EdgeMessage *msg, UA_UInt32 attri
                     goto EXIT;
                 }
             }
-            else if (readRequest.timestampsToReturn == UA_TIMESTAMPSTORETURN_SOURCE)
+            else if (readRequest->timestampsToReturn == UA_TIMESTAMPSTORETURN_SOURCE)
             {
-                if (!readResponse.results[0].hasSourceTimestamp
-                        || readResponse.results[0].hasServerTimestamp)
+                if (!results[0].hasSourceTimestamp
+                        || results[0].hasServerTimestamp)
                 {
                     /* Source timestamp requested. But source timestamp missing in response */
                     EDGE_LOG(TAG, "source Timestamp missing\n\n");
@@ -336,10 +310,10 @@ static void readGroup(UA_Client *client, const EdgeMessage *msg, UA_UInt32 attri
                     goto EXIT;
                 }
             }
-            else if (readRequest.timestampsToReturn == UA_TIMESTAMPSTORETURN_SERVER)
+            else if (readRequest->timestampsToReturn == UA_TIMESTAMPSTORETURN_SERVER)
             {
-                if (readResponse.results[0].hasSourceTimestamp
-                        || !readResponse.results[0].hasServerTimestamp)
+                if (results[0].hasSourceTimestamp
+                        || !results[0].hasServerTimestamp)
                 {
                     /* Server timestamp requested. But server timestamp missing in response */
                     EDGE_LOG(TAG, "server Timestamp missing\n\n");
@@ -348,9 +322,9 @@ static void readGroup(UA_Client *client, const EdgeMessage *msg, UA_UInt32 attri
                 }
             }
 
-            if (readRequest.timestampsToReturn != UA_TIMESTAMPSTORETURN_NEITHER
-                    && !checkMaxAge(readResponse.results[0].serverTimestamp, UA_DateTime_now(),
-                            readRequest.maxAge * 2))
+            if (readRequest->timestampsToReturn != UA_TIMESTAMPSTORETURN_NEITHER
+                    && !checkMaxAge(results[0].serverTimestamp, UA_DateTime_now(),
+                            readRequest->maxAge * 2))
             {
                 /* MaxAge error */
                 EDGE_LOG(TAG, "Max age failed\n\n");
@@ -358,9 +332,9 @@ static void readGroup(UA_Client *client, const EdgeMessage *msg, UA_UInt32 attri
                 goto EXIT;
             }
 
-            if (readRequest.timestampsToReturn != UA_TIMESTAMPSTORETURN_NEITHER
-                    && !checkValidation(&(readResponse.results[0]), msg, readRequest.timestampsToReturn,
-                            readRequest.maxAge))
+            if (readRequest->timestampsToReturn != UA_TIMESTAMPSTORETURN_NEITHER
+                    && !checkValidation(&(results[0]), msg, readRequest->timestampsToReturn,
+                            readRequest->maxAge))
             {
                 strncpy(errorDesc, "", ERROR_DESC_LENGTH);
                 goto EXIT;
@@ -368,6 +342,10 @@ static void readGroup(UA_Client *client, const EdgeMessage *msg, UA_UInt32 attri
         }
     }
 
+    /* The response and its members are taken from one arena, or from the heap without it */
+    arena = EdgeMessageArenaCreate();
+    EdgeArenaEnter(arena);
+
     resultMsg = (EdgeMessage *) EdgeCalloc(1, sizeof(EdgeMessage));
     if(IS_NULL(resultMsg))
     {
@@ -375,6 +353,7 @@ static void readGroup(UA_Client *client, const EdgeMessage *msg, UA_UInt32 attri
         strncpy(errorDesc, "Memory allocation failed.", ERROR_DESC_LENGTH);
         goto EXIT;
     }
+    resultMsg->arena = arena;
 
     resultMsg->responses = (EdgeResponse **) EdgeCalloc(reqLen, sizeof(EdgeResponse *));
     if(IS_NULL(resultMsg->responses))
@@ -392,7 +371,7 @@ static void readGroup(UA_Client *client, const EdgeMessage *msg, UA_UInt32 attri
     }
     resultMsg->type = GENERAL_RESPONSE;
     resultMsg->message_id = msg->message_id;
-    resultMsg->endpointInfo = cloneEdgeEndpointInfo(msg->endpointInfo);
+    resultMsg->endpointInfo = shareEdgeEndpointInfo(msg->endpointInfo);
     if(IS_NULL(resultMsg->endpointInfo))
     {
         EDGE_LOG(TAG, "Error : EdgeCalloc failed for resultMsg.endpointInfo in Read Group\n");
@@ -403,9 +382,9 @@ static void readGroup(UA_Client *client, const EdgeMessage *msg, UA_UInt32 attri
     int respIndex = 0;
     for (int i = 0; i < reqLen; i++)
     {
-        if (readResponse.results[i].status == UA_STATUSCODE_GOOD)
+        if (results[i].status == UA_STATUSCODE_GOOD)
         {
-            UA_Variant val = readResponse.results[i].value;
+            UA_Variant val = results[i].value;
 
             EdgeResponse *response = (EdgeResponse *) EdgeCalloc(1, sizeof(EdgeResponse));
             if (IS_NULL(response))
@@ -531,16 +510,14 @@ static void readGroup(UA_Client *client, const EdgeMessage *msg, UA_UInt32 attri
                 }
                 else
                 {                    
-                    /* Response handling for other array data types */
-                    versatility->value = (void *) EdgeCalloc(1, size);
-                    if(IS_NULL(versatility->value))
+                    /* Response handling for other scalar data types, stored inline */
+                    if(IS_NULL(setEdgeVersatilityScalar(versatility, val.data, size)))
                     {
                         EDGE_LOG(TAG, "Memory allocation failed.");
                         strncpy(errorDesc, "Memory allocation failed.", ERROR_DESC_LENGTH);
                         freeEdgeResponse(response);
                         goto EXIT;
                     }
-                    memcpy(versatility->value, val.data, size);
                 }
             }
             else
@@ -711,8 +688,8 @@ static void readGroup(UA_Client *client, const EdgeMessage *msg, UA_UInt32 attri
 
             /* Check for diagnostic information in read response */
             response->m_diagnosticInfo = checkDiagnosticInfo(msg->requestLength,
-                    readResponse.diagnosticInfos, readResponse.diagnosticInfosSize,
-                    readRequest.requestHeader.returnDiagnostics);
+                    diagnosticInfos, diagnosticInfosSize,
+                    readRequest->requestHeader.returnDiagnostics);
 
             resultMsg->responseLength++;
             resultMsg->responses[respIndex++] = response;
@@ -721,7 +698,7 @@ static void readGroup(UA_Client *client, const EdgeMessage *msg, UA_UInt32 attri
         {
             /* Error in read response for a particular node */
             EDGE_LOG_V(TAG, "Error in group read response for particular node :: 0x%08x(%s)\n",
-                    readResponse.results[i].status, UA_StatusCode_name(readResponse.results[i].status));
+                    results[i].status, UA_StatusCode_name(results[i].status));
             if(1 == reqLen)
             {
                 // Error response for the node(only one) in the given read request.
@@ -740,20 +717,103 @@ static void readGroup(UA_Client *client, const EdgeMessage *msg, UA_UInt32 attri
         goto EXIT;
     }
     /* Adding the read response to receiver Q */
+    EdgeArenaLeave(previous);
     add_to_recvQ(resultMsg);
-    for (size_t i = 0; i < reqLen; i++)
-    {
-        UA_NodeId_deleteMembers(&rv[i].nodeId);
-    }
-    UA_ReadValueId_deleteMembers(rv);
-    EdgeFree(rv);
-    UA_ReadResponse_deleteMembers(&readResponse);
     return;
 
     EXIT:
     /* Free the memory */
+    EdgeArenaLeave(previous);
     sendErrorResponse(msg, errorDesc);
-    freeEdgeMessage(resultMsg);
+    if (resultMsg)
+    {
+        freeEdgeMessage(resultMsg);
+    }
+    else
+    {
+        EdgeArenaDestroy(arena);
+    }
+}
+
+/**
+ * @brief readGroups - Executes read operation of the nodes of one or more messages
+ *                     in a single read request
+ * @param client - Client handle
+ * @param msgs - Request edge messages
+ * @param msgCount - Number of messages
+ * @param attributeId - Attribute Id to read
+ */
+static void readGroups(UA_Client *client, const EdgeMessage **msgs, size_t msgCount,
+        UA_UInt32 attributeId)
+{
+    size_t reqLen = 0;
+    for (size_t m = 0; m < msgCount; m++)
+    {
+        reqLen += msgs[m]->requestLength;
+    }
+
+    UA_ReadValueId *rv = (UA_ReadValueId *) EdgeMalloc(sizeof(UA_ReadValueId) * reqLen);
+    if(IS_NULL(rv))
+    {
+        EDGE_LOG(TAG, "Memory allocation failed.");
+        for (size_t m = 0; m < msgCount; m++)
+        {
+            sendErrorResponse(msgs[m], "Memory allocation failed.");
+        }
+        return;
+    }
+
+    size_t index = 0;
+    for (size_t m = 0; m < msgCount; m++)
+    {
+        const EdgeMessage *msg = msgs[m];
+        for (size_t i = 0; i < msg->requestLength; i++, index++)
+        {
+            EDGE_LOG_V(TAG, "[READGROUP] Node to read :: %s\n", msg->requests[i]->nodeInfo->valueAlias);
+            UA_ReadValueId_init(&rv[index]);
+            rv[index].attributeId = attributeId;
+            rv[index].nodeId = UA_NODEID_STRING_ALLOC(msg->requests[i]->nodeInfo->nodeId->nameSpace,
+                    msg->requests[i]->nodeInfo->valueAlias);
+        }
+    }
+
+    UA_ReadRequest readRequest;
+    UA_ReadRequest_init(&readRequest);
+    /* Nodes information to read */
+    readRequest.nodesToRead = rv;
+    /* Number of nodes to read */
+    readRequest.nodesToReadSize = reqLen;
+    /* Max age */
+    readRequest.maxAge = 2000;
+    /* Timestamp information requested from server */
+    readRequest.timestampsToReturn = UA_TIMESTAMPSTORETURN_BOTH;
+
+    //UA_RequestHeader_init(&(readRequest.requestHeader));
+    //readRequest.requestHeader.returnDiagnostics = 1;
+
+    UA_ReadResponse readResponse = UA_Client_Service_read(client, readRequest);
+
+    if (readResponse.responseHeader.serviceResult != UA_STATUSCODE_GOOD
+            || readResponse.resultsSize != reqLen)
+    {
+        /* Error response in processing read request */
+        EDGE_LOG_V(TAG, "Error in group read :: 0x%08x(%s)\n", readResponse.responseHeader.serviceResult,
+                UA_StatusCode_name(readResponse.responseHeader.serviceResult));
+        for (size_t m = 0; m < msgCount; m++)
+        {
+            sendErrorResponse(msgs[m], "Error in read.");
+        }
+    }
+    else
+    {
+        size_t offset = 0;
+        for (size_t m = 0; m < msgCount; m++)
+        {
+            readGroupResponse(msgs[m], attributeId, &readRequest, &readResponse, offset);
+            offset += msgs[m]->requestLength;
+        }
+    }
+
     for (size_t i = 0; i < reqLen; i++)
     {
         UA_NodeId_deleteMembers(&rv[i].nodeId);
@@ -763,6 +823,17 @@ static void readGroup(UA_Client *client, const EdgeMessage *msg, UA_UInt32 attri
     UA_ReadResponse_deleteMembers(&readResponse);
 }
 
+/**
+ * @brief readGroup - Executes read operation of single/group nodes
+ * @param client - Client handle
+ * @param msg - Request edge message
+ * @param attributeId - Attribute Id to read
+ */
+static void readGroup(UA_Client *client, const EdgeMessage *msg, UA_UInt32 attributeId)
+{
+    readGroups(client, &msg, 1, attributeId);
+}
+
 EdgeResult executeRead(UA_Client *client, const EdgeMessage *msg)
 {
     EdgeResult result;
@@ -783,3 +854,44 @@ EdgeResult executeRead(UA_Client *client, const EdgeMessage *msg)
     result.code = STATUS_OK;
     return result;
 }
+
+EdgeResult executeReadBatch(UA_Client *client, const EdgeMessage **msgs, size_t msgCount)
+{
+    EdgeResult result;
+    result.code = STATUS_ERROR;
+    VERIFY_NON_NULL_MSG(client, "Client param is NULL in execute READ batch\n", result);
+    VERIFY_NON_NULL_MSG(msgs, "Messages param is NULL in execute READ batch\n", result);
+    if (0 == msgCount)
+    {
+        result.code = STATUS_PARAM_INVALID;
+        return result;
+    }
+
+    /* All the messages of a batch read the same attribute */
+    EdgeCommand command = msgs[0]->command;
+    for (size_t m = 1; m < msgCount; m++)
+    {
+        if (msgs[m]->command != command)
+        {
+            result.code = STATUS_PARAM_INVALID;
+            return result;
+        }
+    }
+
+    if (CMD_READ == command)
+    {
+        readGroups(client, msgs, msgCount, UA_ATTRIBUTEID_VALUE);
+    }
+    else if (CMD_READ_SAMPLING_INTERVAL == command)
+    {
+        readGroups(client, msgs, msgCount, UA_ATTRIBUTEID_MINIMUMSAMPLINGINTERVAL);
+    }
+    else
+    {
+        result.code = STATUS_PARAM_INVALID;
+        return result;
+    }
+
+    result.code = STATUS_OK;
+    return result;
+}
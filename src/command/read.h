@@ -48,6 +48,20 @@ extern "C"
  */
 EdgeResult executeRead(UA_Client *client, const EdgeMessage *msg);
 
+/**
+ * @brief Executes the Read operations of several messages in one read request
+ * @remarks Every message gets its own response or error, as with executeRead.
+ * @param[in]  client Client Handle.
+ * @param[in]  msgs EdgeMessage requests with the same command (CMD_READ or
+ *             CMD_READ_SAMPLING_INTERVAL)
+ * @param[in]  msgCount Number of messages
+ * @return @c EdgeResult code is 0 on success, otherwise an error value
+ * @retval #STATUS_OK Successful
+ * @retval #STATUS_PARAM_INVALID Invalid parameter
+ * @retval #STATUS_ERROR Operation failed
+ */
+EdgeResult executeReadBatch(UA_Client *client, const EdgeMessage **msgs, size_t msgCount);
+
 #ifdef __cplusplus
 }
 #endif
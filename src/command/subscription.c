@@ -24,6 +24,7 @@
 #include "edge_utils.h"
 #include "edge_open62541.h"
 #include "edge_map.h"
+#include "edge_intern.h"
 #include "edge_logger.h"
 #include "edge_malloc.h"
 #include "message_dispatcher.h"
@@ -35,12 +36,14 @@
 
 #define TAG "subscription"
 
-#define EDGE_UA_SUBSCRIPTION_ITEM_SIZE (20)
 #define EDGE_UA_MINIMUM_PUBLISHING_TIME (5)
 #define DEFAULT_RETRANSMIT_SEQUENCENUM (2)
 #define GUID_LENGTH (36)
+/* Time the subscription thread waits after a publish request failed for a lost connection,
+ * until the session is connected again. */
+#define EDGE_UA_LOST_PUBLISHING_TIME (100)
 
-/* Subscription information */
+/* Subscription information, the context of its monitored item in open62541 */
 typedef struct subscriptionInfo
 {
     /* Edge Message */
@@ -49,54 +52,56 @@ typedef struct subscriptionInfo
     UA_UInt32 subId;
     /* MonitoredItem Id */
     UA_UInt32 monId;
-    /* Context */
-    void *hfContext;
+    /* value alias, interned */
+    const char *valueAlias;
 } subscriptionInfo;
 
+/* Subscriptions of one client. Only used by calls holding clientLock, apart from the
+ * subscription thread reading client and clientLock. */
 typedef struct clientSubscription
 {
+    /* Client handle */
+    UA_Client *client;
     /* Number of subscriptions */
     int subscriptionCount;
     /* Subscription thread */
     pthread_t subscription_thread;
     /* flag to determine to execution of subscription thread */
     bool subscription_thread_running;
-    /* Subscription list */
+    /* Lock serializing the service calls on the client, taken for each publish request */
+    pthread_mutex_t *clientLock;
+    /* Subscription list, keyed by interned value alias */
     edgeMap *subscriptionList;
+    /* Monitored items keyed by subscription Id, each a map of subscriptionInfo keyed by
+     * monitored item Id */
+    edgeMap *monitoredItems;
 } clientSubscription;
 
-typedef struct client_valueAlias
-{
-    /* Client handle */
-    UA_Client *client;
-    /* value alias */
-    char *valueAlias;
-} client_valueAlias;
-
+/* Requests for different endpoints run in parallel, subscriptionMutex only guards the lookup
+ * and insertion of their client subscriptions in clientSubMap. */
 static edgeMap *clientSubMap  = NULL;
+static pthread_mutex_t subscriptionMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Ids are used as map keys by value */
+static keyValue idKey(UA_UInt32 id)
+{
+    return (keyValue) (uintptr_t) id;
+}
 
 /**
  * @brief validateMonitoringId - Function that checks whether monitoredItem id
  * is present under the given subscription Id
- * @param list - subscription list
+ * @param clientSub - client subscription
  * @param subId - subscription Id
  * @param monId - monitored Id to check under the given subscription Id
- * @return
+ * @return true if the monitored Id is not in use
  */
-static bool validateMonitoringId(edgeMap *list, UA_UInt32 subId, UA_UInt32 monId)
+static bool validateMonitoringId(clientSubscription *clientSub, UA_UInt32 subId, UA_UInt32 monId)
 {
-    if (list)
+    if (clientSub)
     {
-        edgeMapNode *temp = list->head;
-        while (temp != NULL)
-        {
-            subscriptionInfo *subInfo = (subscriptionInfo *) temp->value;
-
-            if (subInfo->subId == subId && subInfo->monId == monId)
-                return false;
-
-            temp = temp->next;
-        }
+        edgeMap *items = (edgeMap *) getMapElement(clientSub->monitoredItems, idKey(subId));
+        return IS_NULL(getMapElement(items, idKey(monId)));
     }
 
     return true;
@@ -104,26 +109,93 @@ static bool validateMonitoringId(edgeMap *list, UA_UInt32 subId, UA_UInt32 monId
 
 /**
  * @brief hasSubscriptionId - Function that checks whether subscription id is valid
- * @param list - subscription list
+ * @param clientSub - client subscription
  * @param subId - subscription Id to check whether its valid
  * @return
  */
-static bool hasSubscriptionId(edgeMap *list, UA_UInt32 subId)
+static bool hasSubscriptionId(clientSubscription *clientSub, UA_UInt32 subId)
 {
-    if (list)
+    return clientSub && IS_NOT_NULL(getMapElement(clientSub->monitoredItems, idKey(subId)));
+}
+
+/**
+ * @brief insertMonitoredItem - Adds the subscription information to the monitored items
+ * @param monitoredItems - monitored items keyed by subscription Id
+ * @param subInfo - subscription information
+ * @return true on success
+ */
+static bool insertMonitoredItem(edgeMap *monitoredItems, subscriptionInfo *subInfo)
+{
+    edgeMap *items = (edgeMap *) getMapElement(monitoredItems, idKey(subInfo->subId));
+    if (IS_NULL(items))
     {
-        edgeMapNode *temp = list->head;
-        while (temp != NULL)
-        {
-            subscriptionInfo *subInfo = (subscriptionInfo *)temp->value;
+        items = createMap();
+        VERIFY_NON_NULL_MSG(items, "createMap FAILED in insertMonitoredItem\n", false);
+        insertMapElement(monitoredItems, idKey(subInfo->subId), (keyValue) items);
+    }
+    insertMapElement(items, idKey(subInfo->monId), (keyValue) subInfo);
+    return true;
+}
+
+/**
+ * @brief addMonitoredItem - Adds the subscription information to the lists of the client
+ * @param clientSub - client subscription
+ * @param subInfo - subscription information
+ * @return true on success
+ */
+static bool addMonitoredItem(clientSubscription *clientSub, subscriptionInfo *subInfo)
+{
+    if (!insertMonitoredItem(clientSub->monitoredItems, subInfo))
+    {
+        return false;
+    }
+    insertMapElement(clientSub->subscriptionList, (keyValue) EdgeInternRetain(subInfo->valueAlias),
+                     (keyValue) subInfo);
+    return true;
+}
+
+/**
+ * @brief removeMonitoredItem - Removes the subscription information from the lists of the client
+ * @param clientSub - client subscription
+ * @param subInfo - subscription information
+ */
+static void removeMonitoredItem(clientSubscription *clientSub, subscriptionInfo *subInfo)
+{
+    edgeMap *items = (edgeMap *) getMapElement(clientSub->monitoredItems, idKey(subInfo->subId));
+    EdgeFree(removeMapElement(items, idKey(subInfo->monId)));
+    if (items && 0 == items->count)
+    {
+        EdgeFree(removeMapElement(clientSub->monitoredItems, idKey(subInfo->subId)));
+        deleteMap(items);
+        EdgeFree(items);
+    }
 
-            if (subInfo->subId == subId)
-                return true;
+    edgeMapNode *removed = removeMapElement(clientSub->subscriptionList, (keyValue) subInfo->valueAlias);
+    if (removed)
+    {
+        EdgeInternRelease(removed->key);
+        EdgeFree(removed);
+    }
+}
 
-            temp = temp->next;
+/**
+ * @brief freeSubInfo - Frees the subscription information
+ * @param subInfo - subscription information
+ */
+static void freeSubInfo(subscriptionInfo *subInfo)
+{
+    if (IS_NOT_NULL(subInfo))
+    {
+        if (subInfo->valueAlias)
+        {
+            EdgeInternRelease(subInfo->valueAlias);
+        }
+        if (subInfo->msg)
+        {
+            freeEdgeMessage(subInfo->msg);
         }
+        EdgeFree(subInfo);
     }
-    return false;
 }
 
 /**
@@ -133,81 +205,92 @@ static bool hasSubscriptionId(edgeMap *list, UA_UInt32 subId)
  */
 static void* get_subscription_list(UA_Client *client)
 {
-    if (clientSubMap)
-    {
-        edgeMapNode *temp = clientSubMap->head;
-        while (NULL != temp)
-        {
-            if (temp->key == client)
-            {
-                // client valid
-                // get all subscription information
-                return temp->value;
-            }
-            temp = temp->next;
-        }
-    }
-    return NULL;
+    pthread_mutex_lock(&subscriptionMutex);
+    void *clientSub = getMapElement(clientSubMap, (keyValue) client);
+    pthread_mutex_unlock(&subscriptionMutex);
+    return clientSub;
+}
+
+/**
+ * @brief findValueAlias - Gets the interned handle of a value alias of a request
+ * @param valueAlias - value alias
+ * @return handle of the value alias, NULL if no subscription uses it
+ */
+static const char *findValueAlias(const char *valueAlias)
+{
+    return valueAlias ? EdgeInternFind(valueAlias, strlen(valueAlias)) : NULL;
 }
 
 /**
  * @brief getSubInfo - Gets subscription information from the list with valueAlias filter
  * @param list - subscription list
- * @param valueAlias - value alias
+ * @param valueAlias - interned value alias
  * @return keyValue
  */
 static keyValue getSubInfo(edgeMap* list, const char *valueAlias)
 {
-    if(IS_NOT_NULL(list))
+    if(IS_NOT_NULL(list) && IS_NOT_NULL(valueAlias))
     {
-        edgeMapNode *temp = list->head;
-        while (temp != NULL)
-        {
-            if (!strcmp(temp->key, valueAlias))
-            {
-                return temp->value;
-            }
-            temp = temp->next;
-        }
+        return getMapElement(list, (keyValue) valueAlias);
     }
     return NULL;
 }
 
 /**
- * @brief removeSubFromMap - Remove the subscription information from the subscription list
- * @param list - subscription list
- * @param valueAlias - value alias
- * @return the removed subscription info
+ * @brief getSubRequest - Gets the subscription parameters of a request message
+ * @param msg - request message
+ * @return subscription parameters
  */
-static edgeMapNode *removeSubFromMap(edgeMap *list, const char *valueAlias)
+static EdgeSubRequest *getSubRequest(const EdgeMessage *msg)
 {
-    edgeMapNode *temp = list->head;
-    edgeMapNode *prev = NULL;
-    while (temp != NULL)
+    if (msg->type == SEND_REQUESTS)
     {
-        if (!strcmp(temp->key, valueAlias))
-        {
-            if (prev == NULL)
-            {
-                list->head = temp->next;
-            }
-            else
-            {
-                prev->next = temp->next;
-            }
+        return msg->requests[0]->subMsg;
+    }
+    return msg->request->subMsg;
+}
+
+/**
+ * @brief initMonitoredItem - Initializes the monitored item of a subscription request
+ * @param item - monitored item to be initialized
+ * @param request - request of the item
+ */
+static void initMonitoredItem(UA_MonitoredItemCreateRequest *item, const EdgeRequest *request)
+{
+    EDGE_LOG_V(TAG, "%s, %s, %d", request->nodeInfo->valueAlias,
+            request->nodeInfo->nodeId->nodeUri, request->nodeInfo->nodeId->nameSpace);
+    UA_MonitoredItemCreateRequest_init(item);
+    item->itemToMonitor.nodeId = UA_NODEID_STRING(request->nodeInfo->nodeId->nameSpace,
+            request->nodeInfo->valueAlias);
+    item->itemToMonitor.attributeId = UA_ATTRIBUTEID_VALUE;
+    item->monitoringMode = UA_MONITORINGMODE_REPORTING;
+    item->requestedParameters.samplingInterval = request->subMsg->samplingInterval;
+    item->requestedParameters.discardOldest = true;
+    item->requestedParameters.queueSize = 1;
+}
 
-            return temp;
+/**
+ * @brief getItemRequest - Gets the request of a monitored item from its subscription message
+ * @param subInfo - subscription information
+ * @return request of the item with its subscription parameters, NULL if not found
+ */
+static EdgeRequest *getItemRequest(const subscriptionInfo *subInfo)
+{
+    EdgeMessage *msg = subInfo->msg;
+    for (size_t i = 0; msg && msg->requests && i < msg->requestLength; i++)
+    {
+        if (!strcmp(msg->requests[i]->nodeInfo->valueAlias, subInfo->valueAlias)
+            && msg->requests[i]->subMsg)
+        {
+            return msg->requests[i];
         }
-        prev = temp;
-        temp = temp->next;
     }
     return NULL;
 }
 
-
-void sendPublishRequest(UA_Client *client)
+UA_StatusCode sendPublishRequest(UA_Client *client)
 {
-    UA_Client_Subscriptions_manuallySendPublishRequest(client);
+    return UA_Client_Subscriptions_manuallySendPublishRequest(client);
 }
 
 /**
@@ -235,19 +318,26 @@ static void monitoredItemHandler(UA_Client *client, UA_UInt32 monId, UA_DataValu
     EDGE_LOG_V(TAG, "Notification received. Value is present, monId :: %d\n", monId);
     logCurrentTimeStamp();
 
-    client_valueAlias *client_alias = (client_valueAlias*) context;
-    char *valueAlias = client_alias->valueAlias;
-
-    clientSubscription *clientSub = (clientSubscription*) get_subscription_list(client_alias->client);
-    VERIFY_NON_NULL_NR_MSG(clientSub, "clientSubscription recevied is NULL in monitoredItemHandler\n");
-
-    subscriptionInfo *subInfo = (subscriptionInfo *) getSubInfo(clientSub->subscriptionList, client_alias->valueAlias);
+    subscriptionInfo *subInfo = (subscriptionInfo *) context;
     VERIFY_NON_NULL_NR_MSG(subInfo, "subscription info received in NULL in monitoredItemHandler\n");
+    VERIFY_NON_NULL_NR_MSG(subInfo->msg, "subscription info without message in monitoredItemHandler\n");
+    const char *valueAlias = subInfo->valueAlias;
+
+    /* The report and its members are taken from one arena, or from the heap without it */
+    EdgeArena *arena = EdgeMessageArenaCreate();
+    EdgeArena *previous = EdgeArenaEnter(arena);
 
     EdgeMessage *resultMsg = (EdgeMessage *) EdgeCalloc(1, sizeof(EdgeMessage));
-    VERIFY_NON_NULL_NR_MSG(resultMsg, "EdgeCalloc FAILED for edgeMessage in monitoredItemHandler\n");
+    if(IS_NULL(resultMsg))
+    {
+        EDGE_LOG(TAG, "EdgeCalloc FAILED for edgeMessage in monitoredItemHandler\n");
+        EdgeArenaLeave(previous);
+        EdgeArenaDestroy(arena);
+        return;
+    }
+    resultMsg->arena = arena;
 
-    resultMsg->endpointInfo = cloneEdgeEndpointInfo(subInfo->msg->endpointInfo);
+    resultMsg->endpointInfo = shareEdgeEndpointInfo(subInfo->msg->endpointInfo);
     if(IS_NULL(resultMsg->endpointInfo))
     {
         EDGE_LOG(TAG, "Error : EdgeCalloc failed for resultMsg.endpointInfo in monitor item handler\n");
@@ -353,9 +443,12 @@ static void monitoredItemHandler(UA_Client *client, UA_UInt32 monId, UA_DataValu
         }
         else
         {
-            /* Handling other scalar value data types */
-            response->message->value = (void *) EdgeCalloc(1, size);
-            memcpy(response->message->value, value->value.data, size);
+            /* Handling other scalar value data types, stored inline */
+            if(IS_NULL(setEdgeVersatilityScalar(response->message, value->value.data, size)))
+            {
+                EDGE_LOG(TAG, "Error : Malloc failed for SCALAR value in monitor item handler\n");
+                goto ERROR;
+            }
         }
     }
     else
@@ -457,52 +550,57 @@ static void monitoredItemHandler(UA_Client *client, UA_UInt32 monId, UA_DataValu
     }
 
     /* Adding the subscription response to receiver Q */
+    EdgeArenaLeave(previous);
     add_to_recvQ(resultMsg);
 
     return;
 
     ERROR:
     /* Free memory */
+    EdgeArenaLeave(previous);
     freeEdgeMessage(resultMsg);
 }
 
 static void *subscription_thread_handler(void *ptr)
 {
     EDGE_LOG(TAG, ">>>>>>>>>>>>>>>>>> subscription thread created <<<<<<<<<<<<<<<<<<<<");
-    UA_Client *client = (UA_Client *) ptr;
-    clientSubscription *clientSub = NULL;
-    clientSub = (clientSubscription*) get_subscription_list(client);
+    clientSubscription *clientSub = (clientSubscription *) ptr;
     VERIFY_NON_NULL_MSG(clientSub, "NULL client subscription in subscription_thread_handler\n", NULL);
 
-    clientSub->subscription_thread_running = true;
-    while (clientSub->subscription_thread_running)
+    while (__atomic_load_n(&clientSub->subscription_thread_running, __ATOMIC_ACQUIRE))
     {
         /* Manually send publish request to server every
-         * (EDGE_UA_MINIMUM_PUBLISHING_TIME * 1000) ms */
-        sendPublishRequest(client);
-        usleep(EDGE_UA_MINIMUM_PUBLISHING_TIME * 1000);
+         * (EDGE_UA_MINIMUM_PUBLISHING_TIME * 1000) ms.
+         * A busy client is skipped, deleteSub joins this thread while holding its lock. */
+        UA_StatusCode ret = UA_STATUSCODE_GOOD;
+        if (0 == pthread_mutex_trylock(clientSub->clientLock))
+        {
+            ret = sendPublishRequest(clientSub->client);
+            pthread_mutex_unlock(clientSub->clientLock);
+        }
+        if (isConnectionLost(ret))
+        {
+            /* The session supervisor connects the client again */
+            requestConnectionCheck();
+            usleep(EDGE_UA_LOST_PUBLISHING_TIME * 1000);
+        }
+        else
+        {
+            usleep(EDGE_UA_MINIMUM_PUBLISHING_TIME * 1000);
+        }
     }
 
     EDGE_LOG(TAG, ">>>>>>>>>>>>>>>>>> subscription thread destroyed <<<<<<<<<<<<<<<<<<<<");
     return NULL;
 }
 
-static UA_StatusCode createSub(UA_Client *client, const EdgeMessage *msg)
+static UA_StatusCode createSub(UA_Client *client, pthread_mutex_t *clientLock,
+        const EdgeMessage *msg)
 {
     clientSubscription *clientSub = NULL;
     clientSub = get_subscription_list(client);
 
-    EdgeSubRequest *subReq;
-    if (msg->type == SEND_REQUESTS)
-    {
-        EdgeRequest **req = msg->requests;
-        subReq = req[0]->subMsg;
-    }
-    else
-    {
-        EdgeRequest *req = msg->request;
-        subReq = req->subMsg;
-    }
+    EdgeSubRequest *subReq = getSubRequest(msg);
 
     for (int i = 0; i < msg->requestLength; i++)
     {
@@ -526,7 +624,7 @@ static UA_StatusCode createSub(UA_Client *client, const EdgeMessage *msg)
         for (int i = 0; i < msg->requestLength; i++)
         {
             subscriptionInfo *subInfo = (subscriptionInfo *) getSubInfo(clientSub->subscriptionList,
-                msg->requests[i]->nodeInfo->valueAlias);
+                findValueAlias(msg->requests[i]->nodeInfo->valueAlias));
 
             if (IS_NOT_NULL(subInfo))
             {
@@ -537,6 +635,41 @@ static UA_StatusCode createSub(UA_Client *client, const EdgeMessage *msg)
         }
     }
 
+    if (IS_NULL(clientSub))
+    {
+        EDGE_LOG(TAG, "subscription list for the client is empty\n");
+        clientSub = (clientSubscription*) EdgeCalloc(1, sizeof(clientSubscription));
+        VERIFY_NON_NULL_MSG(clientSub, "Error : Malloc failed for clientSub in create subscription\n",
+            UA_STATUSCODE_BADOUTOFMEMORY);
+        clientSub->client = client;
+        clientSub->clientLock = clientLock;
+        clientSub->subscriptionList = createMap();
+        clientSub->monitoredItems = createMap();
+        pthread_mutex_lock(&subscriptionMutex);
+        if (IS_NULL(clientSubMap))
+        {
+            clientSubMap = createMap();
+        }
+        if (IS_NULL(clientSub->subscriptionList) || IS_NULL(clientSub->monitoredItems)
+            || IS_NULL(clientSubMap))
+        {
+            pthread_mutex_unlock(&subscriptionMutex);
+            EDGE_LOG(TAG, "Error : Malloc failed for subscription lists in create subscription\n");
+            if (clientSub->subscriptionList)
+            {
+                EdgeFree(clientSub->subscriptionList);
+            }
+            if (clientSub->monitoredItems)
+            {
+                EdgeFree(clientSub->monitoredItems);
+            }
+            EdgeFree(clientSub);
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+        insertMapElement(clientSubMap, (keyValue) client, (keyValue) clientSub);
+        pthread_mutex_unlock(&subscriptionMutex);
+    }
+
     UA_UInt32 subId = 0;
     UA_SubscriptionSettings settings =
     { subReq->publishingInterval, /* .requestedPublishingInterval */
@@ -558,95 +691,71 @@ static UA_StatusCode createSub(UA_Client *client, const EdgeMessage *msg)
 
     EDGE_LOG_V(TAG, "Subscription ID received is %u\n", subId);
 
-    if (NULL != clientSub && hasSubscriptionId(clientSub->subscriptionList, subId))
+    if (hasSubscriptionId(clientSub, subId))
     {
         EDGE_LOG_V(TAG, "ERROR :: Subscription ID is already present in subscriptionList %s\n",
                 UA_StatusCode_name(UA_STATUSCODE_BADSUBSCRIPTIONIDINVALID));
         return UA_STATUSCODE_BADSUBSCRIPTIONIDINVALID;
     }
 
+    UA_StatusCode retVal = UA_STATUSCODE_GOOD;
     size_t itemSize = msg->requestLength;
     UA_MonitoredItemCreateRequest *items = (UA_MonitoredItemCreateRequest *) EdgeMalloc(
             sizeof(UA_MonitoredItemCreateRequest) * itemSize);
-    if(IS_NULL(items))
-    {
-        EDGE_LOG(TAG, "Error : Malloc failed for items in create subscription");
-        goto EXIT;
-    }
-    UA_UInt32 *monId = (UA_UInt32 *) EdgeMalloc(sizeof(UA_UInt32) * itemSize);
-    if(IS_NULL(monId))
-    {
-        EDGE_LOG(TAG, "Error : Malloc failed for monId in create subscription");
-        goto EXIT;
-    }
+    UA_UInt32 *monId = (UA_UInt32 *) EdgeCalloc(itemSize, sizeof(UA_UInt32));
     UA_StatusCode *itemResults = (UA_StatusCode *) EdgeMalloc(sizeof(UA_StatusCode) * itemSize);
-    if(IS_NULL(itemResults))
-    {
-        EDGE_LOG(TAG, "Error : Malloc failed for itemResults in create subscription");
-        goto EXIT;
-    }
     UA_MonitoredItemHandlingFunction *hfs = (UA_MonitoredItemHandlingFunction *) EdgeMalloc(
             sizeof(UA_MonitoredItemHandlingFunction) * itemSize);
-    if(IS_NULL(hfs))
-    {
-        EDGE_LOG(TAG, "Error : Malloc failed for UA_MonitoredItemHandlingFunction in create subscription");
-        goto EXIT;
-    }
-    client_valueAlias **client_alias = (client_valueAlias**) EdgeMalloc(sizeof(client_valueAlias*) * itemSize);
-    if(IS_NULL(client_alias))
+    /* Subscription information of the items, given to open62541 as their contexts and
+     * set to NULL once added to the lists of the client */
+    subscriptionInfo **subInfos = (subscriptionInfo **) EdgeCalloc(itemSize, sizeof(subscriptionInfo *));
+    if(IS_NULL(items) || IS_NULL(monId) || IS_NULL(itemResults) || IS_NULL(hfs) || IS_NULL(subInfos))
     {
-        EDGE_LOG(TAG, "Error : Malloc failed for client_alias in create subscription");
+        EDGE_LOG(TAG, "Error : Malloc failed for monitored items in create subscription");
+        retVal = UA_STATUSCODE_BADOUTOFMEMORY;
         goto EXIT;
     }
 
     for (int i = 0; i < itemSize; i++)
     {
-        monId[i] = 0;
         hfs[i] = &monitoredItemHandler;
-        client_alias[i] = (client_valueAlias*) EdgeMalloc(sizeof(client_valueAlias));
-         if(IS_NULL(client_alias[i]))
+        subInfos[i] = (subscriptionInfo *) EdgeCalloc(1, sizeof(subscriptionInfo));
+        if(IS_NULL(subInfos[i]))
         {
-            EDGE_LOG_V(TAG, "Error : Malloc failed for client_alias id %d in create subscription\n", i);
+            EDGE_LOG_V(TAG, "Error : Malloc failed for subInfo id %d in create subscription\n", i);
+            retVal = UA_STATUSCODE_BADOUTOFMEMORY;
             goto EXIT;
         }
-        client_alias[i]->client = client;
-        client_alias[i]->valueAlias = (char *)EdgeMalloc(EDGE_UA_SUBSCRIPTION_ITEM_SIZE);
-        if(IS_NULL(client_alias[i]->valueAlias))
+        subInfos[i]->subId = subId;
+        subInfos[i]->valueAlias = EdgeInternString(msg->requests[i]->nodeInfo->valueAlias);
+        if(IS_NULL(subInfos[i]->valueAlias))
         {
-            EDGE_LOG_V(TAG, "Error : Malloc failed for client_alias.valuealias id %d in create subscription\n", i);
+            EDGE_LOG_V(TAG, "Error : Malloc failed for subInfo.valuealias id %d in create subscription\n", i);
+            retVal = UA_STATUSCODE_BADOUTOFMEMORY;
             goto EXIT;
         }
-        strncpy(client_alias[i]->valueAlias, msg->requests[i]->nodeInfo->valueAlias,
-            strlen(msg->requests[i]->nodeInfo->valueAlias));
-        client_alias[i]->valueAlias[strlen(msg->requests[i]->nodeInfo->valueAlias)] = '\0';
-
-        EDGE_LOG_V(TAG, "%s, %s, %d", msg->requests[i]->nodeInfo->valueAlias,
-                msg->requests[i]->nodeInfo->nodeId->nodeUri, msg->requests[i]->nodeInfo->nodeId->nameSpace);
-        UA_MonitoredItemCreateRequest_init(&items[i]);
-        items[i].itemToMonitor.nodeId = UA_NODEID_STRING(msg->requests[i]->nodeInfo->nodeId->nameSpace,
-                msg->requests[i]->nodeInfo->valueAlias);
-        items[i].itemToMonitor.attributeId = UA_ATTRIBUTEID_VALUE;
-        items[i].monitoringMode = UA_MONITORINGMODE_REPORTING;
-        items[i].requestedParameters.samplingInterval =
-                msg->requests[i]->subMsg->samplingInterval;
-        items[i].requestedParameters.discardOldest = true;
-        items[i].requestedParameters.queueSize = 1;
+
+        initMonitoredItem(&items[i], msg->requests[i]);
     }
 
     UA_StatusCode retMon = UA_Client_Subscriptions_addMonitoredItems(client, subId, items, itemSize,
-            hfs, (void **) client_alias, itemResults, monId);
+            hfs, (void **) subInfos, itemResults, monId);
     (void) retMon;
     for (int i = 0; i < itemSize; i++)
     {
         EDGE_LOG_V(TAG, "Monitoring Details for item : %d\n", i);
         if (monId[i])
         {
-            if (clientSub != NULL && !validateMonitoringId(clientSub->subscriptionList, subId, monId[i]))
+            if (!validateMonitoringId(clientSub, subId, monId[i]))
             {
                 EDGE_LOG_V(TAG, "Error :: Existing Monitored ID received:: %u\n", monId[i]);
                 EDGE_LOG_V(TAG, "Existing Node Details : Sub ID %d, Monitored ID :: %u\n"
 
-                    "Error :: %s Not added to subscription list\n\n ", subId, monId[i], client_alias[i]->valueAlias);
+                    "Error :: %s Not added to subscription list\n\n ", subId, monId[i], subInfos[i]->valueAlias);
+                /* Removed, so that open62541 drops it as the context of the item */
+                UA_Client_Subscriptions_removeMonitoredItem(client, subId, monId[i]);
+                freeSubInfo(subInfos[i]);
+                subInfos[i] = NULL;
                 continue;
             }
 
@@ -656,7 +765,8 @@ static UA_StatusCode createSub(UA_Client *client, const EdgeMessage *msg)
         {
             // TODO: Handle Error
             EDGE_LOG_V(TAG, "ERROR : INVALID Monitoring ID Recevived for item :: #%d,  Error : %d\n", i, retMon);
-            return UA_STATUSCODE_BADMONITOREDITEMIDINVALID;
+            retVal = UA_STATUSCODE_BADMONITOREDITEMIDINVALID;
+            goto EXIT;
         }
 
         if (itemResults[i] == UA_STATUSCODE_GOOD)
@@ -666,85 +776,72 @@ static UA_StatusCode createSub(UA_Client *client, const EdgeMessage *msg)
         else
         {
             EDGE_LOG_V(TAG, "ERROR Result Recevied for this item : %s\n", UA_StatusCode_name(itemResults[i]));
-            return itemResults[i];
+            retVal = itemResults[i];
+            goto EXIT;
         }
 
-        if (IS_NULL(clientSub))
+        subscriptionInfo *subInfo = subInfos[i];
+        subInfo->msg = cloneEdgeMessage((EdgeMessage*) msg);
+        if(IS_NULL(subInfo->msg))
         {
-            EDGE_LOG(TAG, "subscription list for the client is empty\n");
-            clientSub = (clientSubscription*) EdgeMalloc(sizeof(clientSubscription));
-            if(IS_NULL(clientSub))
-            {
-                EDGE_LOG(TAG, "Error : Malloc failed for clientSub in create subscription\n");
-                goto EXIT;
-            }
-            clientSub->subscriptionCount = 0;
-            clientSub->subscriptionList = NULL;
+            EDGE_LOG(TAG, "Error : Malloc failed for msgCopy in create subscription");
+            retVal = UA_STATUSCODE_BADOUTOFMEMORY;
+            goto EXIT;
         }
+        subInfo->monId = monId[i];
 
-        if (IS_NULL(clientSub->subscriptionList))
+        EDGE_LOG_V(TAG, "Inserting MAP ELEMENT valueAlias :: %s \n", subInfo->valueAlias);
+        if (!addMonitoredItem(clientSub, subInfo))
         {
-            clientSub->subscriptionList = createMap();
+            retVal = UA_STATUSCODE_BADOUTOFMEMORY;
+            goto EXIT;
         }
-        if (clientSub->subscriptionList)
-        {
-            subscriptionInfo *subInfo = (subscriptionInfo *) EdgeMalloc(sizeof(subscriptionInfo));
-            if(IS_NULL(subInfo))
-            {
-                EDGE_LOG(TAG, "Error : Malloc failed for subInfo in create subscription");
-                goto EXIT;
-            }
-            EdgeMessage *msgCopy = cloneEdgeMessage((EdgeMessage*) msg);      //    (EdgeMessage *) EdgeMalloc(sizeof(EdgeMessage));
-            if(IS_NULL(msgCopy))
-            {
-                EdgeFree(subInfo);
-                EDGE_LOG(TAG, "Error : Malloc failed for msgCopy in create subscription");
-                goto EXIT;
-            }
+        subInfos[i] = NULL;
+    }
 
-            subInfo->msg = msgCopy;
-            subInfo->subId = subId;
-            subInfo->monId = monId[i];
-            subInfo->hfContext = client_alias[i];
-            EDGE_LOG_V(TAG, "Inserting MAP ELEMENT valueAlias :: %s \n",
-                   msgCopy->requests[i]->nodeInfo->valueAlias);
-            char *valueAlias = (char *)EdgeMalloc(sizeof(char) * (strlen(msgCopy->requests[i]->nodeInfo->valueAlias) + 1));
-            if(IS_NULL(valueAlias))
+    EXIT:
+    if (subInfos)
+    {
+        /* Items not added to the lists are removed, so that open62541 drops their contexts */
+        bool hasItems = hasSubscriptionId(clientSub, subId);
+        for (int i = 0; i < itemSize; i++)
+        {
+            if (subInfos[i])
             {
-                EdgeFree(subInfo);
-                EDGE_LOG(TAG, "Error : Malloc failed for valueAlias in create subscription");
-                goto EXIT;
+                if (hasItems && monId && monId[i])
+                {
+                    UA_Client_Subscriptions_removeMonitoredItem(client, subId, monId[i]);
+                }
+                freeSubInfo(subInfos[i]);
             }
-
-            strncpy(valueAlias, msgCopy->requests[i]->nodeInfo->valueAlias,
-                strlen(msgCopy->requests[i]->nodeInfo->valueAlias)+1);
-            insertMapElement(clientSub->subscriptionList, (keyValue) valueAlias,
-                             (keyValue) subInfo);
         }
     }
 
-    if (NULL == clientSubMap)
+    if (hasSubscriptionId(clientSub, subId))
     {
-        clientSubMap = createMap();
+        if (0 == clientSub->subscriptionCount)
+        {
+            /* initiate thread for manually sending publish request. The flag is set before,
+             * so that a deleteSub right after stops the thread. */
+            __atomic_store_n(&clientSub->subscription_thread_running, true, __ATOMIC_RELEASE);
+            pthread_create(&(clientSub->subscription_thread), NULL, &subscription_thread_handler,
+                (void *) clientSub);
+        }
+        clientSub->subscriptionCount++;
     }
-    insertMapElement(clientSubMap, (keyValue) client, (keyValue) clientSub);
-
-    if (0 == clientSub->subscriptionCount)
+    else
     {
-        /* initiate thread for manually sending publish request. */
-        pthread_create(&(clientSub->subscription_thread), NULL, &subscription_thread_handler,
-            (void *) client);
+        UA_Client_Subscriptions_remove(client, subId);
     }
-    clientSub->subscriptionCount++;
 
-    EXIT:
     /* Free memory */
+    EdgeFree(subInfos);
     EdgeFree(monId);
     EdgeFree(hfs);
     EdgeFree(itemResults);
     EdgeFree(items);
 
-    return UA_STATUSCODE_GOOD;
+    return retVal;
 }
 
 static UA_StatusCode deleteSub(UA_Client *client, const EdgeMessage *msg)
@@ -754,7 +851,8 @@ static UA_StatusCode deleteSub(UA_Client *client, const EdgeMessage *msg)
     clientSub = (clientSubscription*) get_subscription_list(client);
     VERIFY_NON_NULL_MSG(clientSub, "NULL clientsub in deleteSub\n", UA_STATUSCODE_BADNOSUBSCRIPTION);
 
-    subInfo = (subscriptionInfo *) getSubInfo(clientSub->subscriptionList, msg->request->nodeInfo->valueAlias);
+    const char *valueAlias = findValueAlias(msg->request->nodeInfo->valueAlias);
+    subInfo = (subscriptionInfo *) getSubInfo(clientSub->subscriptionList, valueAlias);
     VERIFY_NON_NULL_MSG(subInfo, "NULL subInfo in deleteSub\n", UA_STATUSCODE_BADNOSUBSCRIPTION);
 
     EDGE_LOG(TAG, "Deleting following Subscription \n");
@@ -772,32 +870,20 @@ static UA_StatusCode deleteSub(UA_Client *client, const EdgeMessage *msg)
     }
     else
     {
-        EDGE_LOG(TAG, "Monitoring deleted successfully\n\n");        
-        edgeMapNode *removed = removeSubFromMap(clientSub->subscriptionList,
-            msg->request->nodeInfo->valueAlias);
-        if (removed != NULL)
-        {
-            subscriptionInfo *info = (subscriptionInfo *) removed->value;
-            if (IS_NOT_NULL(info))
-            {
-                client_valueAlias *alias = (client_valueAlias*) info->hfContext;
-                EdgeFree(alias->valueAlias);
-                EdgeFree(alias);
-                EdgeFree(info->msg);
-                EdgeFree(info);
-            }
-            EdgeFree(removed->key);
-            EdgeFree(removed);
-        }
+        EDGE_LOG(TAG, "Monitoring deleted successfully\n\n");
+        removeMonitoredItem(clientSub, subInfo);
     }
 
-    if (!hasSubscriptionId(clientSub->subscriptionList, subInfo->subId))
+    UA_UInt32 subId = subInfo->subId;
+    freeSubInfo(subInfo);
+
+    if (!hasSubscriptionId(clientSub, subId))
     {
-        EDGE_LOG_V(TAG, "Removing the subscription  SID %d \n", subInfo->subId);
-        UA_StatusCode retVal = UA_Client_Subscriptions_remove(client, subInfo->subId);
+        EDGE_LOG_V(TAG, "Removing the subscription  SID %d \n", subId);
+        UA_StatusCode retVal = UA_Client_Subscriptions_remove(client, subId);
         if (UA_STATUSCODE_GOOD != retVal)
         {
-            EDGE_LOG_V(TAG, "Error in removing subscription  SID %d \n", subInfo->subId);
+            EDGE_LOG_V(TAG, "Error in removing subscription  SID %d \n", subId);
             return retVal;
         }
         clientSub->subscriptionCount--;
@@ -806,7 +892,7 @@ static UA_StatusCode deleteSub(UA_Client *client, const EdgeMessage *msg)
             /* destroy the subscription thread */
             /* delete the subscription thread as there are no existing subscriptions request */
             EDGE_LOG(TAG, "subscription thread destroy\n");
-            clientSub->subscription_thread_running = false;
+            __atomic_store_n(&clientSub->subscription_thread_running, false, __ATOMIC_RELEASE);
             pthread_join(clientSub->subscription_thread, NULL);
         }
     }
@@ -822,7 +908,7 @@ static UA_StatusCode modifySub(UA_Client *client, const EdgeMessage *msg)
     VERIFY_NON_NULL_MSG(clientSub, "NULL clientSubs in modifySub\n", UA_STATUSCODE_BADNOSUBSCRIPTION);
 
     subInfo =  (subscriptionInfo *) getSubInfo(clientSub->subscriptionList,
-                                     msg->request->nodeInfo->valueAlias);
+                                     findValueAlias(msg->request->nodeInfo->valueAlias));
     //EDGE_LOG(TAG, "subscription id retrieved from map :: %d \n\n", subInfo->subId);
 
     VERIFY_NON_NULL_MSG(subInfo, "NULL subInfo in modifySub\n", UA_STATUSCODE_BADNOSUBSCRIPTION);
@@ -1016,7 +1102,7 @@ static UA_StatusCode rePublish(UA_Client *client, const EdgeMessage *msg)
     VERIFY_NON_NULL_MSG(clientSub, "ClientSubs is NULL in rePublish\n", UA_STATUSCODE_BADNOSUBSCRIPTION);
 
     subInfo =  (subscriptionInfo *) getSubInfo(clientSub->subscriptionList,
-            msg->request->nodeInfo->valueAlias);
+            findValueAlias(msg->request->nodeInfo->valueAlias));
     //EDGE_LOG(TAG, "subscription id retrieved from map :: %d \n\n", subInfo->subId);
     VERIFY_NON_NULL_MSG(subInfo, "subInfo is NULL in rePublish\n", UA_STATUSCODE_BADNOSUBSCRIPTION);
 
@@ -1058,30 +1144,20 @@ static UA_StatusCode rePublish(UA_Client *client, const EdgeMessage *msg)
     return UA_STATUSCODE_GOOD;
 }
 
-EdgeResult executeSub(UA_Client *client, const EdgeMessage *msg)
+EdgeResult executeSub(UA_Client *client, pthread_mutex_t *clientLock, const EdgeMessage *msg)
 {
     EdgeResult result;
     result.code = STATUS_ERROR;
     VERIFY_NON_NULL_MSG(client, "Client param is NULL in executeSub\n", result);
 
-    EdgeSubRequest *subReq;
-
     UA_StatusCode retVal = UA_STATUSCODE_GOOD;
-    if (msg->type == SEND_REQUESTS)
-    {
-        EdgeRequest **req = msg->requests;
-        subReq = req[0]->subMsg;
-    }
-    else
-    {
-        EdgeRequest *req = msg->request;
-        subReq = req->subMsg;
-    }
+    EdgeSubRequest *subReq = getSubRequest(msg);
 
+    /* The subscriptions of the client are guarded by clientLock, held by the caller */
     if (subReq->subType == Edge_Create_Sub)
     {
         /* Create Subscription */
-        retVal = createSub(client, msg);
+        retVal = createSub(client, clientLock, msg);
     }
     else if (subReq->subType == Edge_Modify_Sub)
     {
@@ -1110,3 +1186,237 @@ EdgeResult executeSub(UA_Client *client, const EdgeMessage *msg)
 
     return result;
 }
+
+/**
+ * @brief stopSubscriptionThread - Stops the publish requests of the client
+ * @param clientSub - client subscription
+ */
+static void stopSubscriptionThread(clientSubscription *clientSub)
+{
+    if (clientSub->subscriptionCount > 0)
+    {
+        EDGE_LOG(TAG, "subscription thread destroy\n");
+        __atomic_store_n(&clientSub->subscription_thread_running, false, __ATOMIC_RELEASE);
+        pthread_join(clientSub->subscription_thread, NULL);
+        clientSub->subscriptionCount = 0;
+    }
+}
+
+/**
+ * @brief recreateSub - Creates a subscription with its monitored items again
+ * @param client - Client handle
+ * @param items - subscription information of the items keyed by monitored item Id
+ * @param subId - Id of the new subscription
+ * @param monIds - Ids of the new monitored items, in the order of items
+ * @return UA_STATUSCODE_GOOD if the subscription and all its items were created, otherwise
+ *         nothing is left on the server
+ */
+static UA_StatusCode recreateSub(UA_Client *client, edgeMap *items, UA_UInt32 *subId,
+        UA_UInt32 *monIds)
+{
+    size_t itemSize = items->count;
+    EdgeRequest *firstRequest = getItemRequest((subscriptionInfo *) items->head->value);
+    VERIFY_NON_NULL_MSG(firstRequest, "NULL subscription request in recreateSub\n",
+        UA_STATUSCODE_BADUNEXPECTEDERROR);
+    EdgeSubRequest *subReq = firstRequest->subMsg;
+    UA_SubscriptionSettings settings =
+    { subReq->publishingInterval, /* .requestedPublishingInterval */
+    subReq->lifetimeCount, /* .requestedLifetimeCount */
+    subReq->maxKeepAliveCount, /* .requestedMaxKeepAliveCount */
+    subReq->maxNotificationsPerPublish, /* .maxNotificationsPerPublish */
+    subReq->publishingEnabled, /* .publishingEnabled */
+    subReq->priority /* .priority */
+    };
+
+    *subId = 0;
+    UA_StatusCode retVal = UA_Client_Subscriptions_new(client, settings, subId);
+    if (!*subId)
+    {
+        EDGE_LOG_V(TAG, "Error in re-creating subscription :: %s\n", UA_StatusCode_name(retVal));
+        return (UA_STATUSCODE_GOOD == retVal) ? UA_STATUSCODE_BADSUBSCRIPTIONIDINVALID : retVal;
+    }
+
+    UA_MonitoredItemCreateRequest *monItems = (UA_MonitoredItemCreateRequest *) EdgeMalloc(
+            sizeof(UA_MonitoredItemCreateRequest) * itemSize);
+    UA_StatusCode *itemResults = (UA_StatusCode *) EdgeMalloc(sizeof(UA_StatusCode) * itemSize);
+    UA_MonitoredItemHandlingFunction *hfs = (UA_MonitoredItemHandlingFunction *) EdgeMalloc(
+            sizeof(UA_MonitoredItemHandlingFunction) * itemSize);
+    void **contexts = (void **) EdgeMalloc(sizeof(void *) * itemSize);
+    if (IS_NULL(monItems) || IS_NULL(itemResults) || IS_NULL(hfs) || IS_NULL(contexts))
+    {
+        EDGE_LOG(TAG, "Error : Malloc failed for monitored items in recreateSub");
+        retVal = UA_STATUSCODE_BADOUTOFMEMORY;
+        goto EXIT;
+    }
+
+    /* The subscription information stays the context of its item */
+    size_t i = 0;
+    for (edgeMapNode *node = items->head; node; node = node->next, i++)
+    {
+        subscriptionInfo *subInfo = (subscriptionInfo *) node->value;
+        EdgeRequest *request = getItemRequest(subInfo);
+        if (IS_NULL(request))
+        {
+            EDGE_LOG_V(TAG, "Error : Request of %s not found in recreateSub\n", subInfo->valueAlias);
+            retVal = UA_STATUSCODE_BADUNEXPECTEDERROR;
+            goto EXIT;
+        }
+        initMonitoredItem(&monItems[i], request);
+        hfs[i] = &monitoredItemHandler;
+        contexts[i] = subInfo;
+        monIds[i] = 0;
+    }
+
+    retVal = UA_Client_Subscriptions_addMonitoredItems(client, *subId, monItems, itemSize, hfs,
+            contexts, itemResults, monIds);
+    for (i = 0; UA_STATUSCODE_GOOD == retVal && i < itemSize; i++)
+    {
+        if (!monIds[i] || UA_STATUSCODE_GOOD != itemResults[i])
+        {
+            EDGE_LOG_V(TAG, "Error in re-creating monitored item #%zu :: %s\n", i,
+                    UA_StatusCode_name(itemResults[i]));
+            retVal = monIds[i] ? itemResults[i] : UA_STATUSCODE_BADMONITOREDITEMIDINVALID;
+        }
+    }
+
+    EXIT:
+    if (UA_STATUSCODE_GOOD != retVal)
+    {
+        /* Removing the subscription removes its items */
+        UA_Client_Subscriptions_remove(client, *subId);
+    }
+    EdgeFree(contexts);
+    EdgeFree(hfs);
+    EdgeFree(itemResults);
+    EdgeFree(monItems);
+    return retVal;
+}
+
+UA_StatusCode recreateSubscriptions(UA_Client *client)
+{
+    UA_StatusCode retVal = UA_STATUSCODE_GOOD;
+    clientSubscription *clientSub = (clientSubscription *) get_subscription_list(client);
+    if (IS_NULL(clientSub) || 0 == clientSub->monitoredItems->count)
+    {
+        return UA_STATUSCODE_GOOD;
+    }
+
+    edgeMap *oldItems = clientSub->monitoredItems;
+    size_t subCount = oldItems->count;
+    UA_UInt32 *subIds = (UA_UInt32 *) EdgeCalloc(subCount, sizeof(UA_UInt32));
+    UA_UInt32 **monIds = (UA_UInt32 **) EdgeCalloc(subCount, sizeof(UA_UInt32 *));
+    edgeMap *newItems = createMap();
+    if (IS_NULL(subIds) || IS_NULL(monIds) || IS_NULL(newItems))
+    {
+        EDGE_LOG(TAG, "Error : Malloc failed in recreateSubscriptions");
+        retVal = UA_STATUSCODE_BADOUTOFMEMORY;
+        goto EXIT;
+    }
+
+    /* Subscriptions of the lost session are re-created with the same parameters */
+    size_t created = 0;
+    for (edgeMapNode *node = oldItems->head; node; node = node->next, created++)
+    {
+        edgeMap *items = (edgeMap *) node->value;
+        monIds[created] = (UA_UInt32 *) EdgeCalloc(items->count, sizeof(UA_UInt32));
+        if (IS_NULL(monIds[created]))
+        {
+            retVal = UA_STATUSCODE_BADOUTOFMEMORY;
+            break;
+        }
+        retVal = recreateSub(client, items, &subIds[created], monIds[created]);
+        if (UA_STATUSCODE_GOOD != retVal)
+        {
+            break;
+        }
+    }
+
+    if (UA_STATUSCODE_GOOD != retVal)
+    {
+        /* Keep the subscription information for the next attempt */
+        for (size_t i = 0; i < created; i++)
+        {
+            UA_Client_Subscriptions_remove(client, subIds[i]);
+        }
+        goto EXIT;
+    }
+
+    /* All created, give the subscription information their new ids */
+    size_t index = 0;
+    for (edgeMapNode *node = oldItems->head; node; node = node->next, index++)
+    {
+        edgeMap *items = (edgeMap *) node->value;
+        size_t i = 0;
+        for (edgeMapNode *item = items->head; item; item = item->next, i++)
+        {
+            subscriptionInfo *subInfo = (subscriptionInfo *) item->value;
+            subInfo->subId = subIds[index];
+            subInfo->monId = monIds[index][i];
+            insertMonitoredItem(newItems, subInfo);
+        }
+        deleteMap(items);
+        EdgeFree(items);
+    }
+    deleteMap(oldItems);
+    EdgeFree(oldItems);
+    clientSub->monitoredItems = newItems;
+    newItems = NULL;
+    EDGE_LOG_V(TAG, "%zu subscriptions re-created\n", subCount);
+
+    EXIT:
+    if (newItems)
+    {
+        deleteMap(newItems);
+        EdgeFree(newItems);
+    }
+    for (size_t i = 0; monIds && i < subCount; i++)
+    {
+        EdgeFree(monIds[i]);
+    }
+    EdgeFree(monIds);
+    EdgeFree(subIds);
+    return retVal;
+}
+
+void deleteSubscriptions(UA_Client *client)
+{
+    pthread_mutex_lock(&subscriptionMutex);
+    edgeMapNode *removed = removeMapElement(clientSubMap, (keyValue) client);
+    clientSubscription *clientSub = removed ? (clientSubscription *) removed->value : NULL;
+    EdgeFree(removed);
+    if (clientSubMap && 0 == clientSubMap->count)
+    {
+        deleteMap(clientSubMap);
+        EdgeFree(clientSubMap);
+        clientSubMap = NULL;
+    }
+    pthread_mutex_unlock(&subscriptionMutex);
+    if (IS_NULL(clientSub))
+    {
+        return;
+    }
+
+    stopSubscriptionThread(clientSub);
+
+    /* Removing the client removes its subscriptions, only the information is freed */
+    for (edgeMapNode *node = clientSub->monitoredItems->head; node; node = node->next)
+    {
+        edgeMap *items = (edgeMap *) node->value;
+        for (edgeMapNode *item = items->head; item; item = item->next)
+        {
+            freeSubInfo((subscriptionInfo *) item->value);
+        }
+        deleteMap(items);
+        EdgeFree(items);
+    }
+    deleteMap(clientSub->monitoredItems);
+    EdgeFree(clientSub->monitoredItems);
+
+    for (edgeMapNode *node = clientSub->subscriptionList->head; node; node = node->next)
+    {
+        EdgeInternRelease(node->key);
+    }
+    deleteMap(clientSub->subscriptionList);
+    EdgeFree(clientSub->subscriptionList);
+    EdgeFree(clientSub);
+}
@@ -32,6 +32,8 @@
 
 #include "edge_utils.h"
 
+#include <pthread.h>
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -40,13 +42,33 @@ extern "C"
 /**
  * @brief Executes Subscription operation
  * @param[in]  client Client Handle.
+ * @param[in]  clientLock Lock serializing the service calls on the client, held by the caller.
+ *             The publish requests of the subscriptions are sent while holding it.
  * @param[in]  msg EdgeMessage request data
  * @return @c EdgeResult code is 0 on success, otherwise an error value
  * @retval #STATUS_OK Successful
  * @retval #STATUS_PARAM_INVALID Invalid parameter
  * @retval #STATUS_ERROR Operation failed
  */
-EdgeResult executeSub(UA_Client *client, const EdgeMessage *msg);
+EdgeResult executeSub(UA_Client *client, pthread_mutex_t *clientLock, const EdgeMessage *msg);
+
+/**
+ * @brief Creates the subscriptions and monitored items of a client again, after its session
+ *        was lost and the client connected again.
+ * @remarks Should be called with the client lock held. On failure nothing is created and the
+ *          subscriptions are kept for the next attempt.
+ * @param[in]  client Client Handle.
+ * @return UA_STATUSCODE_GOOD on success, otherwise the status of the failed service call
+ */
+UA_StatusCode recreateSubscriptions(UA_Client *client);
+
+/**
+ * @brief Stops the publish requests of a client and frees its subscriptions.
+ * @remarks Should be called before the client is deleted, the subscriptions on the server
+ *          are left to close with the session.
+ * @param[in]  client Client Handle.
+ */
+void deleteSubscriptions(UA_Client *client);
 
 #ifdef __cplusplus
 }
@@ -186,7 +186,7 @@ static void writeGroup(UA_Client *client, const EdgeMessage *msg)
         goto ERROR;
     }
 
-    resultMsg->endpointInfo = cloneEdgeEndpointInfo(msg->endpointInfo);
+    resultMsg->endpointInfo = shareEdgeEndpointInfo(msg->endpointInfo);
     if (IS_NULL(resultMsg->endpointInfo))
     {
         EDGE_LOG(TAG, "Error : Malloc Failed for resultMsg->endpointInfo in Write Group");
@@ -254,7 +254,7 @@ static void writeGroup(UA_Client *client, const EdgeMessage *msg)
             }
             const char *retCode = UA_StatusCode_name(code);
             size_t len = strlen(retCode);
-            char *code = (char*) malloc(len+1);
+            char *code = (char*) EdgeMalloc(len+1);
             strncpy(code, retCode, len+1);
 
             response->message->value = (void *) code;
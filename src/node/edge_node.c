@@ -21,6 +21,7 @@
 #include "edge_node.h"
 #include "edge_utils.h"
 #include "edge_map.h"
+#include "edge_intern.h"
 #include "edge_logger.h"
 #include "edge_malloc.h"
 
@@ -569,16 +570,15 @@ static void addReferenceTypeNode(UA_Server *server, uint16_t nsIndex, const Edge
     }
 }
 
-static keyValue getMethodMapElement(const edgeMap *map, keyValue key)
+static keyValue getMethodMapElement(edgeMap *map, const UA_String *name)
 {
-    edgeMapNode *temp = map->head;
-    while (temp != NULL)
+    // the map is keyed by interned browse names.
+    const char *key = EdgeInternFind((const char *) name->data, name->length);
+    if (IS_NULL(map) || IS_NULL(key))
     {
-        if (!strcmp(temp->key, key))
-            return temp->value;
-        temp = temp->next;
+        return NULL;
     }
-    return NULL;
+    return getMapElement(map, (keyValue) key);
 }
 
 static void destroyInputArgs(void **inp, size_t inputSize, const UA_Variant *input)
@@ -615,8 +615,7 @@ static UA_StatusCode methodCallback(UA_Server *server, const UA_NodeId *sessionI
         const UA_NodeId *objectId, void *objectContext, size_t inputSize, const UA_Variant *input,
         size_t outputSize, UA_Variant *output)
 {
-    char *key = (char *) methodId->identifier.string.data;
-    keyValue value = getMethodMapElement(methodNodeMap, (keyValue) key);
+    keyValue value = getMethodMapElement(methodNodeMap, &methodId->identifier.string);
     if (value != NULL)
     {
         EdgeMethod *method = (EdgeMethod *) value;
@@ -910,10 +909,8 @@ EdgeResult addMethodNode(UA_Server *server, uint16_t nsIndex, const EdgeNodeItem
         if (NULL == methodNodeMap)
             methodNodeMap = createMap();
 
-        char *browseName = (char *) EdgeMalloc(strlen(item->browseName) + 1);
-        VERIFY_NON_NULL_MSG(browseName, "EdgeMalloc FAILED for browseName in addMethodNode\n", result);
-        strncpy(browseName, item->browseName, strlen(item->browseName));
-        browseName[strlen(item->browseName)] = '\0';
+        const char *browseName = EdgeInternString(item->browseName);
+        VERIFY_NON_NULL_MSG(browseName, "EdgeInternString FAILED for browseName in addMethodNode\n", result);
         insertMapElement(methodNodeMap, (void *) browseName, method);
         methodNodeCount += 1;
     }
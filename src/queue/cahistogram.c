@@ -0,0 +1,110 @@
+/* ****************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include "cahistogram.h"
+
+static uint32_t CAHistogramIndex(uint64_t value)
+{
+    if (value < CA_HISTOGRAM_SUB_BUCKETS)
+    {
+        return (uint32_t) value;
+    }
+
+    // the top CA_HISTOGRAM_SUB_BUCKET_BITS + 1 bits select the bucket.
+    uint32_t shift = (63 - __builtin_clzll(value)) - CA_HISTOGRAM_SUB_BUCKET_BITS;
+    uint32_t sub = (uint32_t) (value >> shift) & (CA_HISTOGRAM_SUB_BUCKETS - 1);
+    return (shift + 1) * CA_HISTOGRAM_SUB_BUCKETS + sub;
+}
+
+static uint64_t CAHistogramHighestValue(uint32_t index)
+{
+    if (index < CA_HISTOGRAM_SUB_BUCKETS)
+    {
+        return index;
+    }
+
+    uint32_t shift = index / CA_HISTOGRAM_SUB_BUCKETS - 1;
+    uint64_t sub = CA_HISTOGRAM_SUB_BUCKETS + index % CA_HISTOGRAM_SUB_BUCKETS;
+    return ((sub + 1) << shift) - 1;
+}
+
+void CAHistogramRecord(CAHistogram_t *histogram, uint64_t value)
+{
+    __atomic_fetch_add(&histogram->counts[CAHistogramIndex(value)], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&histogram->count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&histogram->sum, value, __ATOMIC_RELAXED);
+
+    uint64_t max = __atomic_load_n(&histogram->max, __ATOMIC_RELAXED);
+    while (value > max
+            && !__atomic_compare_exchange_n(&histogram->max, &max, value, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+uint64_t CAHistogramPercentile(const CAHistogram_t *histogram, double percentile)
+{
+    // count the buckets themselves, the total may be ahead of them.
+    uint64_t counts[CA_HISTOGRAM_BUCKETS];
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < CA_HISTOGRAM_BUCKETS; i++)
+    {
+        counts[i] = __atomic_load_n(&histogram->counts[i], __ATOMIC_RELAXED);
+        total += counts[i];
+    }
+    if (0 == total)
+    {
+        return 0;
+    }
+
+    uint64_t rank = (uint64_t) (percentile / 100.0 * total + 0.5);
+    rank = (rank < 1) ? 1 : (rank > total) ? total : rank;
+
+    uint64_t max = __atomic_load_n(&histogram->max, __ATOMIC_RELAXED);
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < CA_HISTOGRAM_BUCKETS; i++)
+    {
+        seen += counts[i];
+        if (seen >= rank)
+        {
+            uint64_t value = CAHistogramHighestValue(i);
+            return (value < max) ? value : max;
+        }
+    }
+    return max;
+}
+
+uint64_t CAHistogramMean(const CAHistogram_t *histogram)
+{
+    uint64_t count = __atomic_load_n(&histogram->count, __ATOMIC_RELAXED);
+    uint64_t sum = __atomic_load_n(&histogram->sum, __ATOMIC_RELAXED);
+    return count ? sum / count : 0;
+}
+
+void CAHistogramReset(CAHistogram_t *histogram)
+{
+    for (uint32_t i = 0; i < CA_HISTOGRAM_BUCKETS; i++)
+    {
+        __atomic_store_n(&histogram->counts[i], 0, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&histogram->count, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&histogram->sum, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&histogram->max, 0, __ATOMIC_RELAXED);
+}
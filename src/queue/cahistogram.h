@@ -0,0 +1,93 @@
+/* ****************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file
+ *
+ * This file contains a lock-free histogram with logarithmic buckets in the style of
+ * HdrHistogram.  Each power of two is split into CA_HISTOGRAM_SUB_BUCKETS linear buckets,
+ * so recorded values keep a relative precision of 1/CA_HISTOGRAM_SUB_BUCKETS.  Any
+ * number of threads may record and read at the same time.
+ */
+
+#ifndef CA_HISTOGRAM_H_
+#define CA_HISTOGRAM_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** log2 of the number of buckets per power of two. **/
+#define CA_HISTOGRAM_SUB_BUCKET_BITS 3
+
+/** Number of buckets per power of two. **/
+#define CA_HISTOGRAM_SUB_BUCKETS (1 << CA_HISTOGRAM_SUB_BUCKET_BITS)
+
+/** Number of buckets covering all uint64_t values. **/
+#define CA_HISTOGRAM_BUCKETS ((64 - CA_HISTOGRAM_SUB_BUCKET_BITS + 1) * CA_HISTOGRAM_SUB_BUCKETS)
+
+typedef struct
+{
+    /** Number of values recorded in each bucket. **/
+    uint64_t counts[CA_HISTOGRAM_BUCKETS];
+    /** Number of values recorded. **/
+    uint64_t count;
+    /** Sum of the values recorded. **/
+    uint64_t sum;
+    /** Highest value recorded. **/
+    uint64_t max;
+} CAHistogram_t;
+
+/**
+ * Record a value.
+ * @param[in]   histogram    histogram data.
+ * @param[in]   value        value to record.
+ */
+void CAHistogramRecord(CAHistogram_t *histogram, uint64_t value);
+
+/**
+ * Get the value below or at which the given percentage of the recorded values are.
+ * @param[in]   histogram    histogram data.
+ * @param[in]   percentile   percentage, from 0 to 100.
+ * @return  highest value of the bucket holding the percentile, at most the maximum
+ *          recorded value.  0 if nothing was recorded.
+ */
+uint64_t CAHistogramPercentile(const CAHistogram_t *histogram, double percentile);
+
+/**
+ * @param[in]   histogram    histogram data.
+ * @return  mean of the recorded values, 0 if nothing was recorded.
+ */
+uint64_t CAHistogramMean(const CAHistogram_t *histogram);
+
+/**
+ * Remove all recorded values.  Values recorded while resetting may be partly kept.
+ * @param[in]   histogram    histogram data.
+ */
+void CAHistogramReset(CAHistogram_t *histogram);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* CA_HISTOGRAM_H_ */
@@ -0,0 +1,872 @@
+/* ****************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "edge_malloc.h"
+#include "edge_logger.h"
+
+#include "calanedispatcher.h"
+#include "capriority.h"
+
+#define TAG "CA_LANE"
+
+/**
+ * Queued data.  It is linked into the queue of its lane and priority, and into the queue
+ * of its drop class, both in the order the data was added.
+ */
+typedef struct CALaneItem_t
+{
+    void *data;
+    uint32_t size;
+    uint32_t priority;
+    struct CALane_t *lane;
+    struct CALaneItem_t *prev;
+    struct CALaneItem_t *next;
+    struct CALaneDropClass_t *dropClass;
+    struct CALaneItem_t *classPrev;
+    struct CALaneItem_t *classNext;
+} CALaneItem_t;
+
+/** Queued data of one drop class over all lanes, oldest first. **/
+typedef struct CALaneDropClass_t
+{
+    uintptr_t key;
+    CALaneItem_t *oldest;
+    CALaneItem_t *newest;
+} CALaneDropClass_t;
+
+typedef struct
+{
+    CALaneItem_t *head;
+    CALaneItem_t *tail;
+} CALaneQueue_t;
+
+/**
+ * A lane holds one queue per priority class.  A lane only exists while it has data or
+ * is being processed, and then it sits in the ready list or is held by a worker, which
+ * guarantees that at most one worker processes a lane at any time.
+ */
+typedef struct CALane_t
+{
+    char *key;
+    CALaneQueue_t queues[CA_PRIORITY_COUNT];
+    uint32_t count;
+    CAPriorityScheduler_t scheduler;
+    struct CALane_t *nextReady;
+} CALane_t;
+
+/** Context of CALanePopPriority. **/
+typedef struct
+{
+    CALane_t *lane;
+    CALaneItem_t *item;
+} CALanePopContext_t;
+
+// dispatcher whose task is running on the calling thread, if any.
+static __thread const CALaneDispatcher_t *t_currentDispatcher = NULL;
+
+static void CALaneDestroyData(CALaneDispatcher_t *dispatcher, CALaneItem_t *item)
+{
+    if (NULL != dispatcher->destroy)
+    {
+        dispatcher->destroy(item->data, item->size);
+    }
+    else
+    {
+        EdgeFree(item->data);
+    }
+}
+
+static void CALaneDropData(CALaneDispatcher_t *dispatcher, CALaneItem_t *item)
+{
+    if (NULL != dispatcher->drop)
+    {
+        dispatcher->drop(item->data, item->size);
+    }
+    else
+    {
+        CALaneDestroyData(dispatcher, item);
+    }
+}
+
+static CALane_t *CALaneFind(CALaneDispatcher_t *dispatcher, const char *laneKey)
+{
+    return (CALane_t *) getMapElement(dispatcher->lanes, (keyValue) laneKey);
+}
+
+static CALane_t *CALaneCreate(CALaneDispatcher_t *dispatcher, const char *laneKey)
+{
+    CALane_t *lane = (CALane_t *) EdgeCalloc(1, sizeof(CALane_t));
+    if (NULL == lane)
+    {
+        return NULL;
+    }
+
+    size_t keyLen = strlen(laneKey);
+    lane->key = (char *) EdgeMalloc(keyLen + 1);
+    if (NULL == lane->key)
+    {
+        EdgeFree(lane);
+        return NULL;
+    }
+    memcpy(lane->key, laneKey, keyLen + 1);
+
+    insertMapElement(dispatcher->lanes, (keyValue) lane->key, lane);
+    if (getMapElement(dispatcher->lanes, (keyValue) lane->key) != lane)
+    {
+        EdgeFree(lane->key);
+        EdgeFree(lane);
+        return NULL;
+    }
+    EDGE_LOG_V(TAG, "lane created for %s", laneKey);
+    return lane;
+}
+
+/** Frees an empty lane.  Should be called with laneMutex held. **/
+static void CALaneRelease(CALaneDispatcher_t *dispatcher, CALane_t *lane)
+{
+    EdgeFree(removeMapElement(dispatcher->lanes, (keyValue) lane->key));
+    EdgeFree(lane->key);
+    EdgeFree(lane);
+}
+
+static void CALaneFree(CALaneDispatcher_t *dispatcher, CALane_t *lane)
+{
+    for (uint32_t priority = 0; priority < CA_PRIORITY_COUNT; priority++)
+    {
+        CALaneItem_t *item = lane->queues[priority].head;
+        while (item)
+        {
+            CALaneItem_t *next = item->next;
+            CALaneDestroyData(dispatcher, item);
+            EdgeFree(item);
+            item = next;
+        }
+    }
+    EdgeFree(lane->key);
+    EdgeFree(lane);
+}
+
+static uintptr_t CALaneGetDropClassKey(CALaneDispatcher_t *dispatcher, const void *data)
+{
+    return dispatcher->dropClass ? dispatcher->dropClass(data) : 0;
+}
+
+static CALaneDropClass_t *CALaneGetDropClass(CALaneDispatcher_t *dispatcher, const void *data)
+{
+    uintptr_t key = CALaneGetDropClassKey(dispatcher, data);
+    CALaneDropClass_t *dropClass =
+            (CALaneDropClass_t *) getMapElement(dispatcher->dropClasses, (keyValue) key);
+    if (dropClass)
+    {
+        return dropClass;
+    }
+
+    dropClass = (CALaneDropClass_t *) EdgeCalloc(1, sizeof(CALaneDropClass_t));
+    if (NULL == dropClass)
+    {
+        return NULL;
+    }
+    dropClass->key = key;
+
+    // classes are kept until the dispatcher is destroyed.
+    insertMapElement(dispatcher->dropClasses, (keyValue) dropClass->key, dropClass);
+    if (getMapElement(dispatcher->dropClasses, (keyValue) dropClass->key) != dropClass)
+    {
+        EdgeFree(dropClass);
+        return NULL;
+    }
+    return dropClass;
+}
+
+/** Should be called with laneMutex held. **/
+static bool CALanePush(CALaneDispatcher_t *dispatcher, CALane_t *lane, uint32_t priority,
+                       void *data, uint32_t size)
+{
+    CALaneDropClass_t *dropClass = CALaneGetDropClass(dispatcher, data);
+    CALaneItem_t *item = dropClass ? (CALaneItem_t *) EdgeCalloc(1, sizeof(CALaneItem_t)) : NULL;
+    if (NULL == item)
+    {
+        return false;
+    }
+    item->data = data;
+    item->size = size;
+    item->priority = priority;
+    item->lane = lane;
+
+    CALaneQueue_t *queue = &lane->queues[priority];
+    item->prev = queue->tail;
+    if (queue->tail)
+    {
+        queue->tail->next = item;
+    }
+    else
+    {
+        queue->head = item;
+    }
+    queue->tail = item;
+
+    item->dropClass = dropClass;
+    item->classPrev = dropClass->newest;
+    if (dropClass->newest)
+    {
+        dropClass->newest->classNext = item;
+    }
+    else
+    {
+        dropClass->oldest = item;
+    }
+    dropClass->newest = item;
+
+    lane->count++;
+    dispatcher->count++;
+    return true;
+}
+
+/** Takes data out of its lane and drop class.  Should be called with laneMutex held. **/
+static void CALaneUnlink(CALaneDispatcher_t *dispatcher, CALaneItem_t *item)
+{
+    CALaneQueue_t *queue = &item->lane->queues[item->priority];
+    if (item->prev)
+    {
+        item->prev->next = item->next;
+    }
+    else
+    {
+        queue->head = item->next;
+    }
+    if (item->next)
+    {
+        item->next->prev = item->prev;
+    }
+    else
+    {
+        queue->tail = item->prev;
+    }
+
+    CALaneDropClass_t *dropClass = item->dropClass;
+    if (item->classPrev)
+    {
+        item->classPrev->classNext = item->classNext;
+    }
+    else
+    {
+        dropClass->oldest = item->classNext;
+    }
+    if (item->classNext)
+    {
+        item->classNext->classPrev = item->classPrev;
+    }
+    else
+    {
+        dropClass->newest = item->classPrev;
+    }
+
+    item->lane->count--;
+    dispatcher->count--;
+}
+
+static bool CALanePopPriority(void *context, uint32_t priority)
+{
+    CALanePopContext_t *pop = (CALanePopContext_t *) context;
+    pop->item = pop->lane->queues[priority].head;
+    return (NULL != pop->item);
+}
+
+static CALaneItem_t *CALanePop(CALane_t *lane)
+{
+    CALanePopContext_t context = { .lane = lane };
+    CAPrioritySchedulerPop(&lane->scheduler, CALanePopPriority, &context);
+    return context.item;
+}
+
+/**
+ * Removes the oldest data of the drop class of data.
+ * Should be called with laneMutex held.
+ */
+static bool CALaneRemoveOldest(CALaneDispatcher_t *dispatcher, const void *data,
+                               CALaneItem_t *removed)
+{
+    CALaneDropClass_t *dropClass = (CALaneDropClass_t *) getMapElement(dispatcher->dropClasses,
+            (keyValue) CALaneGetDropClassKey(dispatcher, data));
+    if (NULL == dropClass || NULL == dropClass->oldest)
+    {
+        return false;
+    }
+
+    // an emptied lane is still scheduled, its worker frees it.
+    CALaneItem_t *item = dropClass->oldest;
+    CALaneUnlink(dispatcher, item);
+    *removed = *item;
+    EdgeFree(item);
+    return true;
+}
+
+static uint64_t CALaneGetTimeMs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000 + (uint64_t) ts.tv_nsec / 1000000;
+}
+
+/**
+ * Applies the full queue policy until there is room for one more data.
+ * Should be called with laneMutex held.
+ */
+static bool CALaneMakeRoom(CALaneDispatcher_t *dispatcher, const void *data,
+                           CALaneItem_t *dropped, bool *isDropped)
+{
+    if (0 == dispatcher->capacity || dispatcher->count < dispatcher->capacity)
+    {
+        return true;
+    }
+
+    if (CA_QUEUE_FULL_BLOCK == dispatcher->fullPolicy)
+    {
+        // a worker waiting for room could wait for itself.
+        if (CALaneDispatcherIsWorkerThread(dispatcher))
+        {
+            EDGE_LOG(TAG, "dispatcher is full, a worker cannot wait for room..");
+            dispatcher->fullStats.rejected++;
+            return false;
+        }
+
+        dispatcher->fullStats.blocked++;
+        uint64_t deadline = CALaneGetTimeMs() + dispatcher->blockTimeoutMs;
+        while (dispatcher->capacity && dispatcher->count >= dispatcher->capacity
+                && !dispatcher->isStop)
+        {
+            if (0 == dispatcher->blockTimeoutMs)
+            {
+                oc_cond_wait(dispatcher->spaceCond, dispatcher->laneMutex);
+                continue;
+            }
+
+            uint64_t now = CALaneGetTimeMs();
+            if (now >= deadline)
+            {
+                dispatcher->fullStats.blockTimeouts++;
+                return false;
+            }
+            oc_cond_wait_for(dispatcher->spaceCond, dispatcher->laneMutex, (deadline - now) * 1000);
+        }
+        return !dispatcher->isStop;
+    }
+
+    if (CA_QUEUE_FULL_DROP_OLDEST == dispatcher->fullPolicy
+            && CALaneRemoveOldest(dispatcher, data, dropped))
+    {
+        dispatcher->fullStats.dropped++;
+        *isDropped = true;
+        return true;
+    }
+
+    dispatcher->fullStats.rejected++;
+    return false;
+}
+
+static void CALaneAppendReady(CALaneDispatcher_t *dispatcher, CALane_t *lane)
+{
+    lane->nextReady = NULL;
+    if (dispatcher->readyTail)
+    {
+        dispatcher->readyTail->nextReady = lane;
+    }
+    else
+    {
+        dispatcher->readyHead = lane;
+    }
+    dispatcher->readyTail = lane;
+}
+
+static CALane_t *CALanePopReady(CALaneDispatcher_t *dispatcher)
+{
+    CALane_t *lane = dispatcher->readyHead;
+    if (lane)
+    {
+        dispatcher->readyHead = lane->nextReady;
+        if (NULL == dispatcher->readyHead)
+        {
+            dispatcher->readyTail = NULL;
+        }
+        lane->nextReady = NULL;
+    }
+    return lane;
+}
+
+/** Should be called with laneMutex held whenever a worker takes data out of a lane. **/
+static void CALaneTake(CALaneDispatcher_t *dispatcher, CALaneItem_t *item)
+{
+    CALaneUnlink(dispatcher, item);
+    if (dispatcher->capacity)
+    {
+        oc_cond_signal(dispatcher->spaceCond);
+    }
+}
+
+/**
+ * Adds the data following items[0] in the queue of the given priority to the batch,
+ * waiting up to batchWindowMs for more.  Should be called with laneMutex held.
+ * @return number of items in the batch.
+ */
+static uint32_t CALaneCollectBatch(CALaneDispatcher_t *dispatcher, CALane_t *lane,
+                                   uint32_t priority, CALaneItem_t **items, uint32_t maxBatch)
+{
+    CALaneQueue_t *queue = &lane->queues[priority];
+    uint64_t deadline = CALaneGetTimeMs() + dispatcher->batchWindowMs;
+    uint32_t count = 1;
+
+    while (!dispatcher->isStop)
+    {
+        while (count < maxBatch && queue->head
+                && dispatcher->batchMatch(queue->head->data, items[0]->data))
+        {
+            CALaneItem_t *item = queue->head;
+            CALaneTake(dispatcher, item);
+            items[count++] = item;
+        }
+
+        // stop at data which cannot join, so that the lane keeps its order.
+        if (count >= maxBatch || queue->head || 0 == dispatcher->batchWindowMs)
+        {
+            break;
+        }
+
+        uint64_t now = CALaneGetTimeMs();
+        if (now >= deadline)
+        {
+            break;
+        }
+        dispatcher->batchWaiters++;
+        oc_cond_wait_for(dispatcher->dataCond, dispatcher->laneMutex, (deadline - now) * 1000);
+        dispatcher->batchWaiters--;
+    }
+
+    return count;
+}
+
+/**
+ * Runs the data taken from a lane, collecting a batch first if enabled.
+ * Called with laneMutex held, which is released while the tasks run.
+ */
+static void CALaneRunData(CALaneDispatcher_t *dispatcher, CALane_t *lane)
+{
+    CALaneItem_t *item = CALanePop(lane);
+    CALaneTake(dispatcher, item);
+
+    CALaneItem_t **items = &item;
+    uint32_t count = 1;
+    uint32_t maxBatch = dispatcher->maxBatch;
+    if (maxBatch > 1 && dispatcher->batchMatch(item->data, item->data))
+    {
+        CALaneItem_t **batch = (CALaneItem_t **) EdgeMalloc(maxBatch * sizeof(CALaneItem_t *));
+        if (batch)
+        {
+            batch[0] = item;
+            items = batch;
+            count = CALaneCollectBatch(dispatcher, lane, item->priority, items, maxBatch);
+        }
+    }
+    CABatchTask batchTask = dispatcher->batchTask;
+    oc_mutex_unlock(dispatcher->laneMutex);
+
+    void **data = NULL;
+    if (count > 1)
+    {
+        data = (void **) EdgeMalloc(count * sizeof(void *));
+    }
+
+    if (data)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            data[i] = items[i]->data;
+        }
+        batchTask(data, count);
+        EdgeFree(data);
+    }
+    else
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            dispatcher->threadTask(items[i]->data);
+        }
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        CALaneDestroyData(dispatcher, items[i]);
+        EdgeFree(items[i]);
+    }
+    if (items != &item)
+    {
+        EdgeFree(items);
+    }
+
+    oc_mutex_lock(dispatcher->laneMutex);
+}
+
+static void CALaneDispatcherWorker(void *threadValue)
+{
+    CALaneDispatcher_t *dispatcher = (CALaneDispatcher_t *) threadValue;
+    t_currentDispatcher = dispatcher;
+
+    oc_mutex_lock(dispatcher->laneMutex);
+    while (!dispatcher->isStop && dispatcher->readyHead)
+    {
+        CALane_t *lane = CALanePopReady(dispatcher);
+
+        // process a bounded number of data, then give the other ready lanes a turn.
+        for (uint32_t n = 0; n < CA_LANE_BATCH_SIZE && lane->count > 0 && !dispatcher->isStop; n++)
+        {
+            CALaneRunData(dispatcher, lane);
+        }
+
+        if (lane->count > 0)
+        {
+            CALaneAppendReady(dispatcher, lane);
+        }
+        else
+        {
+            // idle lanes are freed, so the lane map only grows with the endpoints in use.
+            CALaneRelease(dispatcher, lane);
+        }
+    }
+
+    dispatcher->activeWorkers--;
+    oc_cond_broadcast(dispatcher->idleCond);
+    oc_mutex_unlock(dispatcher->laneMutex);
+
+    t_currentDispatcher = NULL;
+}
+
+static void CALaneFreeMap(edgeMap **map)
+{
+    if (*map)
+    {
+        deleteMap(*map);
+        EdgeFree(*map);
+        *map = NULL;
+    }
+}
+
+CAResult_t CALaneDispatcherInitialize(CALaneDispatcher_t *dispatcher, ca_thread_pool_t handle,
+                                      uint32_t maxWorkers, CAThreadTask task,
+                                      CADataDestroyFunction destroy)
+{
+    if (NULL == dispatcher)
+    {
+        EDGE_LOG(TAG, "dispatcher instance is empty..");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    if (NULL == handle || 0 == maxWorkers)
+    {
+        EDGE_LOG(TAG, "thread pool handle is empty..");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    memset(dispatcher, 0, sizeof(CALaneDispatcher_t));
+    dispatcher->threadPool = handle;
+    dispatcher->maxWorkers = maxWorkers;
+    dispatcher->threadTask = task;
+    dispatcher->destroy = destroy;
+    dispatcher->laneMutex = oc_mutex_new();
+    dispatcher->idleCond = oc_cond_new();
+    dispatcher->spaceCond = oc_cond_new();
+    dispatcher->dataCond = oc_cond_new();
+    dispatcher->lanes = createStringMap();
+    dispatcher->dropClasses = createMap();
+    if (NULL == dispatcher->laneMutex || NULL == dispatcher->idleCond
+            || NULL == dispatcher->spaceCond || NULL == dispatcher->dataCond
+            || NULL == dispatcher->lanes || NULL == dispatcher->dropClasses)
+    {
+        if (dispatcher->laneMutex)
+        {
+            oc_mutex_free(dispatcher->laneMutex);
+            dispatcher->laneMutex = NULL;
+        }
+        if (dispatcher->idleCond)
+        {
+            oc_cond_free(dispatcher->idleCond);
+            dispatcher->idleCond = NULL;
+        }
+        if (dispatcher->spaceCond)
+        {
+            oc_cond_free(dispatcher->spaceCond);
+            dispatcher->spaceCond = NULL;
+        }
+        if (dispatcher->dataCond)
+        {
+            oc_cond_free(dispatcher->dataCond);
+            dispatcher->dataCond = NULL;
+        }
+        CALaneFreeMap(&dispatcher->lanes);
+        CALaneFreeMap(&dispatcher->dropClasses);
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+
+    return CA_STATUS_OK;
+}
+
+CAResult_t CALaneDispatcherSetCapacity(CALaneDispatcher_t *dispatcher, uint32_t capacity,
+                                       CAQueueFullPolicy policy, uint32_t timeoutMs,
+                                       CADataClassFunction dropClass, CADataDestroyFunction drop)
+{
+    if (NULL == dispatcher || NULL == dispatcher->laneMutex)
+    {
+        EDGE_LOG(TAG, "dispatcher instance is empty..");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    oc_mutex_lock(dispatcher->laneMutex);
+    dispatcher->capacity = capacity;
+    dispatcher->fullPolicy = policy;
+    dispatcher->blockTimeoutMs = timeoutMs;
+    dispatcher->dropClass = dropClass;
+    dispatcher->drop = drop;
+    // a larger capacity may let blocked callers in.
+    oc_cond_broadcast(dispatcher->spaceCond);
+    oc_mutex_unlock(dispatcher->laneMutex);
+
+    return CA_STATUS_OK;
+}
+
+CAResult_t CALaneDispatcherSetBatch(CALaneDispatcher_t *dispatcher, CADataMatchFunction match,
+                                    CABatchTask task, uint32_t maxBatch, uint32_t windowMs)
+{
+    if (NULL == dispatcher || NULL == dispatcher->laneMutex || (match && NULL == task))
+    {
+        EDGE_LOG(TAG, "dispatcher instance is empty..");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    oc_mutex_lock(dispatcher->laneMutex);
+    dispatcher->batchMatch = match;
+    dispatcher->batchTask = task;
+    dispatcher->maxBatch = match ? maxBatch : 0;
+    dispatcher->batchWindowMs = windowMs;
+    oc_mutex_unlock(dispatcher->laneMutex);
+
+    return CA_STATUS_OK;
+}
+
+CAResult_t CALaneDispatcherGetFullStats(CALaneDispatcher_t *dispatcher, CAQueueFullStats_t *stats)
+{
+    if (NULL == dispatcher || NULL == dispatcher->laneMutex || NULL == stats)
+    {
+        EDGE_LOG(TAG, "dispatcher instance is empty..");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    oc_mutex_lock(dispatcher->laneMutex);
+    *stats = dispatcher->fullStats;
+    oc_mutex_unlock(dispatcher->laneMutex);
+
+    return CA_STATUS_OK;
+}
+
+CAResult_t CALaneDispatcherAddData(CALaneDispatcher_t *dispatcher, const char *laneKey,
+                                   void *data, uint32_t size)
+{
+    return CALaneDispatcherAddDataWithPriority(dispatcher, laneKey, data, size, 0);
+}
+
+static CAResult_t CALaneAddData(CALaneDispatcher_t *dispatcher, const char *laneKey,
+                                const char *followKey, void *data, uint32_t size,
+                                uint32_t priority)
+{
+    if (NULL == dispatcher || NULL == dispatcher->laneMutex || NULL == laneKey
+            || priority >= CA_PRIORITY_COUNT)
+    {
+        EDGE_LOG(TAG, "dispatcher instance is empty..");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    if (NULL == data || 0 == size)
+    {
+        EDGE_LOG(TAG, "data is empty..");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    CALaneItem_t dropped;
+    bool isDropped = false;
+
+    oc_mutex_lock(dispatcher->laneMutex);
+    if (dispatcher->isStop)
+    {
+        oc_mutex_unlock(dispatcher->laneMutex);
+        EDGE_LOG(TAG, "dispatcher is stopped..");
+        return CA_STATUS_FAILED;
+    }
+
+    if (!CALaneMakeRoom(dispatcher, data, &dropped, &isDropped))
+    {
+        oc_mutex_unlock(dispatcher->laneMutex);
+        EDGE_LOG(TAG, "dispatcher is full..");
+        return CA_STATUS_FAILED;
+    }
+
+    CALane_t *lane = followKey ? CALaneFind(dispatcher, followKey) : NULL;
+    if (NULL == lane)
+    {
+        lane = CALaneFind(dispatcher, laneKey);
+    }
+    bool isNewLane = (NULL == lane);
+    if (isNewLane)
+    {
+        lane = CALaneCreate(dispatcher, laneKey);
+    }
+
+    if (NULL == lane || !CALanePush(dispatcher, lane, priority, data, size))
+    {
+        if (isNewLane && lane)
+        {
+            CALaneRelease(dispatcher, lane);
+        }
+        oc_mutex_unlock(dispatcher->laneMutex);
+        EDGE_LOG(TAG, "memory error!!");
+        if (isDropped)
+        {
+            CALaneDropData(dispatcher, &dropped);
+        }
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+    if (dispatcher->batchWaiters)
+    {
+        oc_cond_broadcast(dispatcher->dataCond);
+    }
+
+    // an existing lane is already in the ready list or held by a worker.
+    bool spawnWorker = false;
+    if (isNewLane)
+    {
+        CALaneAppendReady(dispatcher, lane);
+        if (dispatcher->activeWorkers < dispatcher->maxWorkers)
+        {
+            dispatcher->activeWorkers++;
+            spawnWorker = true;
+        }
+    }
+    oc_mutex_unlock(dispatcher->laneMutex);
+
+    if (isDropped)
+    {
+        EDGE_LOG(TAG, "dispatcher is full, oldest data dropped..");
+        CALaneDropData(dispatcher, &dropped);
+    }
+
+    if (spawnWorker
+            && CA_STATUS_OK != ca_thread_pool_add_task(dispatcher->threadPool,
+                    CALaneDispatcherWorker, dispatcher, NULL))
+    {
+        // the lane stays ready and is picked up by the next worker.
+        EDGE_LOG(TAG, "thread pool add task error(lane worker).");
+        oc_mutex_lock(dispatcher->laneMutex);
+        dispatcher->activeWorkers--;
+        oc_cond_broadcast(dispatcher->idleCond);
+        oc_mutex_unlock(dispatcher->laneMutex);
+    }
+
+    return CA_STATUS_OK;
+}
+
+CAResult_t CALaneDispatcherAddDataWithPriority(CALaneDispatcher_t *dispatcher, const char *laneKey,
+                                               void *data, uint32_t size, uint32_t priority)
+{
+    return CALaneAddData(dispatcher, laneKey, NULL, data, size, priority);
+}
+
+CAResult_t CALaneDispatcherAddDataFollowing(CALaneDispatcher_t *dispatcher, const char *laneKey,
+                                            const char *followKey, void *data, uint32_t size,
+                                            uint32_t priority)
+{
+    return CALaneAddData(dispatcher, laneKey, followKey, data, size, priority);
+}
+
+CAResult_t CALaneDispatcherStop(CALaneDispatcher_t *dispatcher)
+{
+    if (NULL == dispatcher || NULL == dispatcher->laneMutex)
+    {
+        EDGE_LOG(TAG, "dispatcher instance is empty..");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    EDGE_LOG(TAG, "dispatcher stop request!!");
+
+    // a worker calling this cannot wait for itself.
+    uint32_t self = CALaneDispatcherIsWorkerThread(dispatcher) ? 1 : 0;
+
+    oc_mutex_lock(dispatcher->laneMutex);
+    dispatcher->isStop = true;
+    oc_cond_broadcast(dispatcher->spaceCond);
+    oc_cond_broadcast(dispatcher->dataCond);
+    while (dispatcher->activeWorkers > self)
+    {
+        oc_cond_wait(dispatcher->idleCond, dispatcher->laneMutex);
+    }
+    oc_mutex_unlock(dispatcher->laneMutex);
+
+    return CA_STATUS_OK;
+}
+
+CAResult_t CALaneDispatcherDestroy(CALaneDispatcher_t *dispatcher)
+{
+    if (NULL == dispatcher || NULL == dispatcher->laneMutex)
+    {
+        EDGE_LOG(TAG, "dispatcher instance is empty..");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    EDGE_LOG(TAG, "dispatcher destroy..");
+
+    for (edgeMapNode *node = dispatcher->lanes->head; node; node = node->next)
+    {
+        CALaneFree(dispatcher, (CALane_t *) node->value);
+    }
+    CALaneFreeMap(&dispatcher->lanes);
+    for (edgeMapNode *node = dispatcher->dropClasses->head; node; node = node->next)
+    {
+        EdgeFree(node->value);
+    }
+    CALaneFreeMap(&dispatcher->dropClasses);
+    dispatcher->readyHead = NULL;
+    dispatcher->readyTail = NULL;
+    dispatcher->count = 0;
+
+    oc_mutex_free(dispatcher->laneMutex);
+    dispatcher->laneMutex = NULL;
+    oc_cond_free(dispatcher->idleCond);
+    dispatcher->idleCond = NULL;
+    oc_cond_free(dispatcher->spaceCond);
+    dispatcher->spaceCond = NULL;
+    oc_cond_free(dispatcher->dataCond);
+    dispatcher->dataCond = NULL;
+
+    return CA_STATUS_OK;
+}
+
+bool CALaneDispatcherIsWorkerThread(const CALaneDispatcher_t *dispatcher)
+{
+    return (NULL != dispatcher && t_currentDispatcher == dispatcher);
+}
@@ -0,0 +1,259 @@
+/* ****************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file
+ *
+ * This file contains a dispatcher that runs data through serial lanes.  Data added
+ * with the same lane key is processed one at a time, while different lanes are
+ * processed in parallel by at most maxWorkers thread pool tasks.  Lanes are kept in a map
+ * by key and freed once they are empty.  Within a lane, data
+ * of the same priority is processed in the order it was added and the priorities
+ * share the lane in weighted round-robin order (see capriority.h).
+ */
+
+#ifndef CA_LANE_DISPATCHER_H_
+#define CA_LANE_DISPATCHER_H_
+
+#include <stdint.h>
+
+#include "cathreadpool.h"
+#include "caqueueingthread.h"
+#include "octhread.h"
+#include "cacommon.h"
+#include "edge_map.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** Number of data a worker processes from one lane before moving to the next lane. **/
+#define CA_LANE_BATCH_SIZE 16
+
+/** Behaviour of CALaneDispatcherAddData when the dispatcher already holds capacity data. **/
+typedef enum
+{
+    /** Fail immediately. **/
+    CA_QUEUE_FULL_REJECT = 0,
+    /**
+     * Wait up to the block timeout for a worker to make room.  Data added from a task of
+     * the dispatcher is rejected instead, since its worker would wait for itself.
+     */
+    CA_QUEUE_FULL_BLOCK,
+    /** Drop the oldest queued data of the same drop class, or fail if there is none. **/
+    CA_QUEUE_FULL_DROP_OLDEST
+} CAQueueFullPolicy;
+
+/** Returns true if the queued data may join a batch started by data. **/
+typedef bool (*CADataMatchFunction)(const void *queued, const void *data);
+
+/** Returns the drop class of data, CA_QUEUE_FULL_DROP_OLDEST drops data of the same class. **/
+typedef uintptr_t (*CADataClassFunction)(const void *data);
+
+/** Number of times each full queue policy was applied. **/
+typedef struct
+{
+    uint32_t rejected;
+    uint32_t blocked;
+    uint32_t blockTimeouts;
+    uint32_t dropped;
+} CAQueueFullStats_t;
+
+struct CALane_t;
+
+typedef struct
+{
+    /** Thread pool the lane workers run on. **/
+    ca_thread_pool_t threadPool;
+    /** mutex guarding the lanes and the ready list. **/
+    oc_mutex laneMutex;
+    /** signalled whenever a worker exits. **/
+    oc_cond idleCond;
+    /** Thread function to be invoked. **/
+    CAThreadTask threadTask;
+    /** Data destroy function. **/
+    CADataDestroyFunction destroy;
+    /** Maximum number of lanes processed at the same time. **/
+    uint32_t maxWorkers;
+    /** Number of worker tasks currently scheduled on the pool. **/
+    uint32_t activeWorkers;
+    /** Variable to inform the workers to stop. **/
+    bool isStop;
+    /** Maximum number of queued data over all lanes, 0 if unbounded. **/
+    uint32_t capacity;
+    /** Number of queued data over all lanes. **/
+    uint32_t count;
+    /** signalled whenever a worker takes data out of a lane. **/
+    oc_cond spaceCond;
+    /** Policy applied when capacity is reached. **/
+    CAQueueFullPolicy fullPolicy;
+    /** Time to wait for room with CA_QUEUE_FULL_BLOCK, 0 to wait without limit. **/
+    uint32_t blockTimeoutMs;
+    /** Selects the data CA_QUEUE_FULL_DROP_OLDEST may drop. **/
+    CADataClassFunction dropClass;
+    /** Called instead of destroy for dropped data. **/
+    CADataDestroyFunction drop;
+    /** Full queue policy counters. **/
+    CAQueueFullStats_t fullStats;
+    /** Selects the data that may join a batch, see CALaneDispatcherSetBatch. **/
+    CADataMatchFunction batchMatch;
+    /** Function called for batches of more than one data. **/
+    CABatchTask batchTask;
+    /** Maximum number of data in a batch, batching is disabled below 2. **/
+    uint32_t maxBatch;
+    /** Time a worker waits for more data to complete a batch. **/
+    uint32_t batchWindowMs;
+    /** Number of workers waiting for data to complete a batch. **/
+    uint32_t batchWaiters;
+    /** signalled when data is added while a worker waits to complete a batch. **/
+    oc_cond dataCond;
+    /** Lanes which have data or are being processed, by lane key. **/
+    edgeMap *lanes;
+    /** Queued data of each drop class in the order it was added, by class. **/
+    edgeMap *dropClasses;
+    /** Lanes that have data and are not being processed. **/
+    struct CALane_t *readyHead;
+    struct CALane_t *readyTail;
+} CALaneDispatcher_t;
+
+/**
+ * Initializes the lane dispatcher.
+ * @param[in]   dispatcher   dispatcher data.
+ * @param[in]   handle       thread pool handle created.
+ * @param[in]   maxWorkers   maximum number of lanes processed in parallel.
+ * @param[in]   task         function to be called for each data.
+ * @param[in]   destroy      function to data destroy.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CALaneDispatcherInitialize(CALaneDispatcher_t *dispatcher, ca_thread_pool_t handle,
+                                      uint32_t maxWorkers, CAThreadTask task,
+                                      CADataDestroyFunction destroy);
+
+/**
+ * Bound the number of data queued over all lanes.
+ * @param[in]   dispatcher   dispatcher data.
+ * @param[in]   capacity     maximum number of queued data, 0 for unbounded.
+ * @param[in]   policy       behaviour of CALaneDispatcherAddData when capacity is reached.
+ * @param[in]   timeoutMs    time to wait for room with CA_QUEUE_FULL_BLOCK, 0 without limit.
+ * @param[in]   dropClass    class of the data CA_QUEUE_FULL_DROP_OLDEST may drop. NULL puts
+ *                           all data in one class.  Classes are kept until the dispatcher
+ *                           is destroyed, so it should only return a few values.
+ * @param[in]   drop         function called for dropped data. NULL uses the destroy function.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CALaneDispatcherSetCapacity(CALaneDispatcher_t *dispatcher, uint32_t capacity,
+                                       CAQueueFullPolicy policy, uint32_t timeoutMs,
+                                       CADataClassFunction dropClass, CADataDestroyFunction drop);
+
+/**
+ * Enable batching.  When a worker takes data for which match(data, data) is true, it also
+ * takes the following data of the same lane and priority for which match(next, data) is
+ * true, up to maxBatch data.  If the batch is not full, it waits up to windowMs for more.
+ * Batches of more than one data are given to task instead of the thread task.
+ * @param[in]   dispatcher   dispatcher data.
+ * @param[in]   match        selects the data of a batch. NULL disables batching.
+ * @param[in]   task         function called for a batch.
+ * @param[in]   maxBatch     maximum number of data in a batch.
+ * @param[in]   windowMs     time to wait for more data, 0 to only batch queued data.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CALaneDispatcherSetBatch(CALaneDispatcher_t *dispatcher, CADataMatchFunction match,
+                                    CABatchTask task, uint32_t maxBatch, uint32_t windowMs);
+
+/**
+ * Read the full queue policy counters.
+ * @param[in]   dispatcher   dispatcher data.
+ * @param[out]  stats        counters.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CALaneDispatcherGetFullStats(CALaneDispatcher_t *dispatcher, CAQueueFullStats_t *stats);
+
+/**
+ * Add data with the highest priority to the lane identified by laneKey.  The lane is
+ * created on first use and freed once it is empty.
+ * @param[in]   dispatcher   dispatcher data.
+ * @param[in]   laneKey      key of the lane. Copied by the dispatcher.
+ * @param[in]   data         data to be given to the task.
+ * @param[in]   size         length of the data.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h). Ownership
+ *          of data stays with the caller on failure. CA_STATUS_FAILED is returned when the
+ *          dispatcher is stopped or full.
+ */
+CAResult_t CALaneDispatcherAddData(CALaneDispatcher_t *dispatcher, const char *laneKey,
+                                   void *data, uint32_t size);
+
+/**
+ * Add data with the given priority to the lane identified by laneKey.
+ * @param[in]   dispatcher   dispatcher data.
+ * @param[in]   laneKey      key of the lane. Copied by the dispatcher.
+ * @param[in]   data         data to be given to the task.
+ * @param[in]   size         length of the data.
+ * @param[in]   priority     priority class, 0 is the highest (below CA_PRIORITY_COUNT).
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h). Ownership
+ *          of data stays with the caller on failure.
+ */
+CAResult_t CALaneDispatcherAddDataWithPriority(CALaneDispatcher_t *dispatcher, const char *laneKey,
+                                               void *data, uint32_t size, uint32_t priority);
+
+/**
+ * Add data with the given priority to the lane identified by followKey while that lane has
+ * data or is being processed, so that the data runs after it, and to the lane identified by
+ * laneKey otherwise.
+ * @param[in]   dispatcher   dispatcher data.
+ * @param[in]   laneKey      key of the lane used when the followed lane is idle.
+ * @param[in]   followKey    key of the lane to follow. NULL always uses laneKey.
+ * @param[in]   data         data to be given to the task.
+ * @param[in]   size         length of the data.
+ * @param[in]   priority     priority class, 0 is the highest (below CA_PRIORITY_COUNT).
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h). Ownership
+ *          of data stays with the caller on failure.
+ */
+CAResult_t CALaneDispatcherAddDataFollowing(CALaneDispatcher_t *dispatcher, const char *laneKey,
+                                            const char *followKey, void *data, uint32_t size,
+                                            uint32_t priority);
+
+/**
+ * Stop the dispatcher and wait for the running workers to finish their current data.
+ * Data that has not been processed yet stays queued until CALaneDispatcherDestroy.
+ * Callers blocked in CALaneDispatcherAddData fail.
+ * @param[in]   dispatcher   dispatcher data.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CALaneDispatcherStop(CALaneDispatcher_t *dispatcher);
+
+/**
+ * Destroy all lanes and the data still queued in them.
+ * @param[in]   dispatcher   dispatcher data.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CALaneDispatcherDestroy(CALaneDispatcher_t *dispatcher);
+
+/**
+ * @param[in]   dispatcher   dispatcher data.
+ * @return  true if the calling thread is running a task of this dispatcher.
+ */
+bool CALaneDispatcherIsWorkerThread(const CALaneDispatcher_t *dispatcher);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* CA_LANE_DISPATCHER_H_ */
@@ -0,0 +1,41 @@
+/* ****************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include "capriority.h"
+
+static const uint32_t CA_PRIORITY_WEIGHTS[CA_PRIORITY_COUNT] = { 8, 4, 2, 1 };
+
+bool CAPrioritySchedulerPop(CAPriorityScheduler_t *scheduler, CAPriorityPopFunction pop,
+                            void *context)
+{
+    // one extra step comes back to the starting class with fresh credit.
+    for (uint32_t i = 0; i <= CA_PRIORITY_COUNT; i++)
+    {
+        uint32_t priority = scheduler->current;
+        if (scheduler->credit < CA_PRIORITY_WEIGHTS[priority] && pop(context, priority))
+        {
+            scheduler->credit++;
+            return true;
+        }
+        scheduler->current = (priority + 1) % CA_PRIORITY_COUNT;
+        scheduler->credit = 0;
+    }
+    return false;
+}
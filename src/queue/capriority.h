@@ -0,0 +1,75 @@
+/* ****************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file
+ *
+ * This file contains the weighted round-robin scheduler shared by the dispatchers.
+ * Priority 0 is the highest.  Every priority gets CA_PRIORITY_WEIGHTS[priority] data
+ * in each round, so lower priorities are delayed but never starved.
+ */
+
+#ifndef CA_PRIORITY_H_
+#define CA_PRIORITY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** Number of priority classes. **/
+#define CA_PRIORITY_COUNT 4
+
+/** Lowest priority class. **/
+#define CA_PRIORITY_LOWEST (CA_PRIORITY_COUNT - 1)
+
+/** Round-robin state of one consumer. **/
+typedef struct
+{
+    uint32_t current;
+    uint32_t credit;
+} CAPriorityScheduler_t;
+
+/**
+ * Takes the next data of the given priority.
+ * @param context   consumer data.
+ * @param priority  priority class to take the data from.
+ * @return true if data was taken, false if the priority class is empty.
+ */
+typedef bool (*CAPriorityPopFunction)(void *context, uint32_t priority);
+
+/**
+ * Takes the next data in weighted round-robin order.
+ * @param scheduler round-robin state.
+ * @param pop       function taking data of one priority class.
+ * @param context   consumer data given to pop.
+ * @return true if data was taken, false if all priority classes are empty.
+ */
+bool CAPrioritySchedulerPop(CAPriorityScheduler_t *scheduler, CAPriorityPopFunction pop,
+                            void *context);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* CA_PRIORITY_H_ */
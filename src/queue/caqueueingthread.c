@@ -31,6 +31,95 @@
 
 #define TAG "OIC_CA_QING"
 
+static void CAQueueingThreadDestroyData(CAQueueingThread_t *thread, void *data, uint32_t size)
+{
+    if (NULL != thread->destroy)
+    {
+        thread->destroy(data, size);
+    }
+    else
+    {
+        EdgeFree(data);
+    }
+}
+
+/** Context of CAQueueingThreadPopPriority. **/
+typedef struct
+{
+    CAQueueingThread_t *thread;
+    void *data;
+    uint32_t size;
+} CAQueueingThreadPopContext_t;
+
+static bool CAQueueingThreadPopPriority(void *context, uint32_t priority)
+{
+    CAQueueingThreadPopContext_t *pop = (CAQueueingThreadPopContext_t *) context;
+    return u_mpsc_queue_pop(pop->thread->dataQueues[priority], &pop->data, &pop->size);
+}
+
+static bool CAQueueingThreadPop(CAQueueingThread_t *thread, void **data, uint32_t *size)
+{
+    CAQueueingThreadPopContext_t context = { .thread = thread };
+    if (!CAPrioritySchedulerPop(&thread->scheduler, CAQueueingThreadPopPriority, &context))
+    {
+        return false;
+    }
+    *data = context.data;
+    *size = context.size;
+    return true;
+}
+
+static void CAQueueingThreadDeleteQueues(CAQueueingThread_t *thread)
+{
+    for (uint32_t priority = 0; priority < CA_PRIORITY_COUNT; priority++)
+    {
+        if (thread->dataQueues[priority])
+        {
+            u_mpsc_queue_delete(thread->dataQueues[priority]);
+            thread->dataQueues[priority] = NULL;
+        }
+    }
+}
+
+static uint32_t CAQueueingThreadDrain(CAQueueingThread_t *thread, void **data, uint32_t *sizes)
+{
+    uint32_t count = 0;
+    while (count < thread->maxBatch && CAQueueingThreadPop(thread, &data[count], &sizes[count]))
+    {
+        count++;
+    }
+    return count;
+}
+
+static void CAQueueingThreadRun(CAQueueingThread_t *thread, void **data, uint32_t *sizes,
+                                uint32_t count)
+{
+    // data left when the thread is stopped is destroyed without processing,
+    // as CAQueueingThreadDestroy does with the queued data.
+    if (count > 1 && thread->batchTask)
+    {
+        if (!thread->isStop)
+        {
+            thread->batchTask(data, count);
+        }
+    }
+    else
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (!thread->isStop)
+            {
+                thread->threadTask(data[i]);
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        CAQueueingThreadDestroyData(thread, data[i], sizes[i]);
+    }
+}
+
 static void CAQueueingThreadBaseRoutine(void *threadValue)
 {
     EDGE_LOG( TAG, "message handler main thread start..");
@@ -43,53 +132,39 @@ static void CAQueueingThreadBaseRoutine(void *threadValue)
         return;
     }
 
+    void *data[CA_QUEUEING_THREAD_MAX_BATCH];
+    uint32_t sizes[CA_QUEUEING_THREAD_MAX_BATCH];
+
     while (!thread->isStop)
     {
-        // mutex lock
-        oc_mutex_lock(thread->threadMutex);
-
-        // if queue is empty, thread will wait
-        if (!thread->isStop && u_queue_get_size(thread->dataQueue) <= 0)
+        // get all pending data, up to maxBatch
+        uint32_t count = CAQueueingThreadDrain(thread, data, sizes);
+        if (0 == count)
         {
-            EDGE_LOG(TAG, "wait..");
-
-            // wait
-            oc_cond_wait(thread->threadCond, thread->threadMutex);
-
-            EDGE_LOG(TAG, "wake up..");
-        }
+            // queue looks empty; announce that we are going to sleep and check
+            // again under the lock, so a producer that missed the flag has
+            // already published its data.
+            oc_mutex_lock(thread->threadMutex);
+            __atomic_store_n(&thread->isWaiting, true, __ATOMIC_SEQ_CST);
+            __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+            count = CAQueueingThreadDrain(thread, data, sizes);
+            if (0 == count && !thread->isStop)
+            {
+                oc_cond_wait(thread->threadCond, thread->threadMutex);
+            }
 
-        // check stop flag
-        if (thread->isStop)
-        {
-            // mutex unlock
+            __atomic_store_n(&thread->isWaiting, false, __ATOMIC_RELAXED);
             oc_mutex_unlock(thread->threadMutex);
-            continue;
-        }
 
-        // get data
-        u_queue_message_t *message = u_queue_get_element(thread->dataQueue);
-        // mutex unlock
-        oc_mutex_unlock(thread->threadMutex);
-        if (NULL == message)
-        {
-            continue;
-        }
-
-        // process data
-        thread->threadTask(message->msg);
-
-        // free
-        if (NULL != thread->destroy)
-        {
-            thread->destroy(message->msg, message->size);
-        }
-        else
-        {
-            EdgeFree(message->msg);
+            if (0 == count)
+            {
+                continue;
+            }
         }
 
-        EdgeFree(message);
+        // process and free data
+        CAQueueingThreadRun(thread, data, sizes, count);
     }
 
     oc_mutex_lock(thread->threadMutex);
@@ -101,6 +176,15 @@ static void CAQueueingThreadBaseRoutine(void *threadValue)
 
 CAResult_t CAQueueingThreadInitialize(CAQueueingThread_t *thread, ca_thread_pool_t handle,
                                       CAThreadTask task, CADataDestroyFunction destroy)
+{
+    return CAQueueingThreadInitializeWithCapacity(thread, handle, task, destroy,
+                                                  CA_QUEUEING_THREAD_DEFAULT_CAPACITY);
+}
+
+CAResult_t CAQueueingThreadInitializeWithCapacity(CAQueueingThread_t *thread,
+                                                  ca_thread_pool_t handle, CAThreadTask task,
+                                                  CADataDestroyFunction destroy,
+                                                  uint32_t capacity)
 {
     if (NULL == thread)
     {
@@ -118,13 +202,22 @@ CAResult_t CAQueueingThreadInitialize(CAQueueingThread_t *thread, ca_thread_pool
 
     // set send thread data
     thread->threadPool = handle;
-    thread->dataQueue = u_queue_create();
+    memset(&thread->scheduler, 0, sizeof(thread->scheduler));
+    bool hasQueues = true;
+    for (uint32_t priority = 0; priority < CA_PRIORITY_COUNT; priority++)
+    {
+        thread->dataQueues[priority] = u_mpsc_queue_create(capacity);
+        hasQueues = hasQueues && (NULL != thread->dataQueues[priority]);
+    }
     thread->threadMutex = oc_mutex_new();
     thread->threadCond = oc_cond_new();
     thread->isStop = true;
+    thread->isWaiting = false;
     thread->threadTask = task;
     thread->destroy = destroy;
-    if (NULL == thread->dataQueue || NULL == thread->threadMutex || NULL == thread->threadCond)
+    thread->maxBatch = 1;
+    thread->batchTask = NULL;
+    if (!hasQueues || NULL == thread->threadMutex || NULL == thread->threadCond)
     {
         goto ERROR_MEM_FAILURE;
     }
@@ -132,11 +225,7 @@ CAResult_t CAQueueingThreadInitialize(CAQueueingThread_t *thread, ca_thread_pool
     return CA_STATUS_OK;
 
 ERROR_MEM_FAILURE:
-    if (thread->dataQueue)
-    {
-        u_queue_delete(thread->dataQueue);
-        thread->dataQueue = NULL;
-    }
+    CAQueueingThreadDeleteQueues(thread);
     if (thread->threadMutex)
     {
         oc_mutex_free(thread->threadMutex);
@@ -150,6 +239,26 @@ ERROR_MEM_FAILURE:
     return CA_MEMORY_ALLOC_FAILED;
 }
 
+CAResult_t CAQueueingThreadSetBatch(CAQueueingThread_t *thread, uint32_t maxBatch,
+                                    CABatchTask task)
+{
+    if (NULL == thread || 0 == maxBatch || maxBatch > CA_QUEUEING_THREAD_MAX_BATCH)
+    {
+        EDGE_LOG( TAG, "invalid batch parameter..");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    if (false == thread->isStop)
+    {
+        EDGE_LOG( TAG, "queueing thread already running..");
+        return CA_STATUS_FAILED;
+    }
+
+    thread->maxBatch = maxBatch;
+    thread->batchTask = task;
+    return CA_STATUS_OK;
+}
+
 CAResult_t CAQueueingThreadStart(CAQueueingThread_t *thread)
 {
     if (NULL == thread)
@@ -193,7 +302,13 @@ CAResult_t CAQueueingThreadStart(CAQueueingThread_t *thread)
 
 CAResult_t CAQueueingThreadAddData(CAQueueingThread_t *thread, void *data, uint32_t size)
 {
-    if (NULL == thread)
+    return CAQueueingThreadAddDataWithPriority(thread, data, size, 0);
+}
+
+CAResult_t CAQueueingThreadAddDataWithPriority(CAQueueingThread_t *thread, void *data,
+                                               uint32_t size, uint32_t priority)
+{
+    if (NULL == thread || priority >= CA_PRIORITY_COUNT)
     {
         EDGE_LOG( TAG, "thread instance is empty..");
         return CA_STATUS_INVALID_PARAM;
@@ -205,29 +320,21 @@ CAResult_t CAQueueingThreadAddData(CAQueueingThread_t *thread, void *data, uint3
         return CA_STATUS_INVALID_PARAM;
     }
 
-    // create thread data
-    u_queue_message_t *message = (u_queue_message_t *) EdgeMalloc(sizeof(u_queue_message_t));
-
-    if (NULL == message)
+    // add thread data into queue
+    if (!u_mpsc_queue_push(thread->dataQueues[priority], data, size))
     {
-        EDGE_LOG( TAG, "memory error!!");
-        return CA_MEMORY_ALLOC_FAILED;
+        EDGE_LOG( TAG, "queue is full..");
+        return CA_STATUS_FAILED;
     }
 
-    message->msg = data;
-    message->size = size;
-
-    // mutex lock
-    oc_mutex_lock(thread->threadMutex);
-
-    // add thread data into list
-    u_queue_add_element(thread->dataQueue, message);
-
-    // notity the thread
-    oc_cond_signal(thread->threadCond);
-
-    // mutex unlock
-    oc_mutex_unlock(thread->threadMutex);
+    // notify the thread only if it is sleeping
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&thread->isWaiting, __ATOMIC_RELAXED))
+    {
+        oc_mutex_lock(thread->threadMutex);
+        oc_cond_signal(thread->threadCond);
+        oc_mutex_unlock(thread->threadMutex);
+    }
 
     return CA_STATUS_OK;
 }
@@ -242,40 +349,19 @@ CAResult_t CAQueueingThreadDestroy(CAQueueingThread_t *thread)
 
     EDGE_LOG( TAG, "thread destroy..");
 
-    // mutex lock
-    oc_mutex_lock(thread->threadMutex);
-
-    // remove all remained list data.
-    while (u_queue_get_size(thread->dataQueue) > 0)
+    // remove all remained queue data.
+    void *data = NULL;
+    uint32_t size = 0;
+    while (CAQueueingThreadPop(thread, &data, &size))
     {
-        // get data
-        u_queue_message_t *message = u_queue_get_element(thread->dataQueue);
-
-        // free
-        if (NULL != message)
-        {
-            if (NULL != thread->destroy)
-            {
-                thread->destroy(message->msg, message->size);
-            }
-            else
-            {
-                EdgeFree(message->msg);
-            }
-
-            EdgeFree(message);
-        }
+        CAQueueingThreadDestroyData(thread, data, size);
     }
 
-    // mutex unlock
-    oc_mutex_unlock(thread->threadMutex);
-
     oc_mutex_free(thread->threadMutex);
     thread->threadMutex = NULL;
     oc_cond_free(thread->threadCond);
 
-    u_queue_delete(thread->dataQueue);
-    thread->dataQueue = NULL;
+    CAQueueingThreadDeleteQueues(thread);
 
     return CA_STATUS_OK;
 }
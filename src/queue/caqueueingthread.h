@@ -31,7 +31,8 @@
 
 #include "cathreadpool.h"
 #include "octhread.h"
-#include "uqueue.h"
+#include "umpscqueue.h"
+#include "capriority.h"
 #include "cacommon.h"
 
 #ifdef __cplusplus
@@ -39,12 +40,21 @@ extern "C"
 {
 #endif
 
+/** Number of queue slots per priority used by CAQueueingThreadInitialize. **/
+#define CA_QUEUEING_THREAD_DEFAULT_CAPACITY 8192
+
+/** Maximum number of data the thread takes from the queues at once. **/
+#define CA_QUEUEING_THREAD_MAX_BATCH 64
+
 /** Thread function to be invoked. **/
 typedef void (*CAThreadTask)(void *threadData);
 
 /** Data destroy function. **/
 typedef void (*CADataDestroyFunction)(void *data, uint32_t size);
 
+/** Processes several data at once; called instead of the thread task for batches. **/
+typedef void (*CABatchTask)(void **data, uint32_t count);
+
 typedef struct
 {
     /** Thread pool of the thread started. **/
@@ -59,8 +69,16 @@ typedef struct
     CADataDestroyFunction destroy;
     /** Variable to inform the thread to stop. **/
     bool isStop;
-    /** Que on which the thread is operating. **/
-    u_queue_t *dataQueue;
+    /** Set while the thread sleeps on threadCond; producers only signal then. **/
+    bool isWaiting;
+    /** Queues on which the thread is operating, one per priority. **/
+    u_mpsc_queue_t *dataQueues[CA_PRIORITY_COUNT];
+    /** Order in which the thread takes data from the queues. **/
+    CAPriorityScheduler_t scheduler;
+    /** Maximum number of data taken from the queues at once. **/
+    uint32_t maxBatch;
+    /** Function called for batches of more than one data, NULL to call the thread task. **/
+    CABatchTask batchTask;
 } CAQueueingThread_t;
 
 /**
@@ -74,6 +92,34 @@ typedef struct
 CAResult_t CAQueueingThreadInitialize(CAQueueingThread_t *thread, ca_thread_pool_t handle,
                                       CAThreadTask task, CADataDestroyFunction destroy);
 
+/**
+ * Initializes the queuing thread with a queue of the given capacity.
+ * @param[in]   thread       thread data for each thread.
+ * @param[in]   handle       thread pool handle created.
+ * @param[in]   task         function to be called for each data.
+ * @param[in]   destroy      function to data destroy.
+ * @param[in]   capacity     maximum number of queued data per priority, rounded up to a
+ *                           power of two.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAQueueingThreadInitializeWithCapacity(CAQueueingThread_t *thread,
+                                                  ca_thread_pool_t handle, CAThreadTask task,
+                                                  CADataDestroyFunction destroy,
+                                                  uint32_t capacity);
+
+/**
+ * Set the drain mode of the queuing thread.  Each time it runs, the thread takes up to
+ * maxBatch pending data at once and then processes them without touching the queues.
+ * Must be called before CAQueueingThreadStart.
+ * @param[in]   thread       thread data for each thread.
+ * @param[in]   maxBatch     maximum number of data taken at once, 1 to CA_QUEUEING_THREAD_MAX_BATCH.
+ * @param[in]   task         function called for batches of more than one data. NULL calls
+ *                           the thread task for each data.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAQueueingThreadSetBatch(CAQueueingThread_t *thread, uint32_t maxBatch,
+                                    CABatchTask task);
+
 /**
  * Start the queuing thread.
  * @param[in]   thread        thread data that needs to be started.
@@ -82,14 +128,29 @@ CAResult_t CAQueueingThreadInitialize(CAQueueingThread_t *thread, ca_thread_pool
 CAResult_t CAQueueingThreadStart(CAQueueingThread_t *thread);
 
 /**
- * Add queuing thread data for new thread.
+ * Add queuing thread data with the highest priority.  Never blocks; the thread is
+ * only woken up when it is idle.
  * @param[in]   thread       thread data for new thread control.
  * @param[in]   data         data that needs to be given for each thread.
  * @param[in]   size         length of the data.
- * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ * @return  CA_STATUS_OK, or CA_STATUS_FAILED if the queue is full. Ownership of
+ *          data stays with the caller on failure.
  */
 CAResult_t CAQueueingThreadAddData(CAQueueingThread_t *thread, void *data, uint32_t size);
 
+/**
+ * Add queuing thread data with the given priority.  The thread takes data of the
+ * priorities in weighted round-robin order (see capriority.h).
+ * @param[in]   thread       thread data for new thread control.
+ * @param[in]   data         data that needs to be given for each thread.
+ * @param[in]   size         length of the data.
+ * @param[in]   priority     priority class, 0 is the highest (below CA_PRIORITY_COUNT).
+ * @return  CA_STATUS_OK, or CA_STATUS_FAILED if the queue is full. Ownership of
+ *          data stays with the caller on failure.
+ */
+CAResult_t CAQueueingThreadAddDataWithPriority(CAQueueingThread_t *thread, void *data,
+                                               uint32_t size, uint32_t priority);
+
 /**
  * Stop the queuing thread.
  * @param[in]   thread       thread data that needs to be started.
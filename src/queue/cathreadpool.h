@@ -53,7 +53,9 @@ typedef struct ca_thread_pool
 }*ca_thread_pool_t;
 
 /**
- * This function creates a newly allocated thread pool.
+ * This function creates a newly allocated thread pool.  num_of_threads workers are
+ * spawned up front and share a single task queue, so adding a task never creates a
+ * thread.  A task that never returns keeps its worker busy for the pool's lifetime.
  *
  * @param num_of_threads The number of worker thread used in this pool.
  * @param thread_pool_handle Handle to newly create thread pool.
@@ -61,6 +63,19 @@ typedef struct ca_thread_pool
  */
 CAResult_t ca_thread_pool_init(int32_t num_of_threads, ca_thread_pool_t *thread_pool_handle);
 
+/**
+ * This function creates a newly allocated thread pool with optional work stealing.
+ * With work stealing enabled, tasks added from inside a worker are kept in that
+ * worker's local queue, and idle workers steal from the local queues of busy ones.
+ *
+ * @param num_of_threads The number of worker thread used in this pool.
+ * @param work_stealing true to enable per-worker queues with work stealing.
+ * @param thread_pool_handle Handle to newly create thread pool.
+ * @return Error code, CA_STATUS_OK if success, else error number.
+ */
+CAResult_t ca_thread_pool_init_ex(int32_t num_of_threads, bool work_stealing,
+                                  ca_thread_pool_t *thread_pool_handle);
+
 /**
  * This function adds a routine to be executed by the thread pool at some future time.
  *
@@ -77,6 +92,7 @@ CAResult_t ca_thread_pool_add_task(ca_thread_pool_t thread_pool, ca_thread_func
 
 /**
  * This function removes a routine to be executed by the thread pool.
+ * Queued tasks cannot be cancelled, so this waits until the task has finished.
  *
  * @param thread_pool The thread pool structure.
  * @param taskId An unique identifier of task.
@@ -89,6 +105,8 @@ CAResult_t ca_thread_pool_remove_task(ca_thread_pool_t thread_pool, uint32_t tas
 /**
  * This function stops all the worker threads (stop & exit). And frees all the allocated memory.
  * Function will return only after joining all threads executing the currently scheduled tasks.
+ * Tasks that are still queued are run before the workers exit.  Must not be called from
+ * a task running in the same pool.
  *
  * @param thread_pool The thread pool structure.
  */
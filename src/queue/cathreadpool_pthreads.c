@@ -24,61 +24,296 @@
  * This file provides APIs related to thread pool.
  */
 
+
 #ifndef _GNU_SOURCE
 #define _GNU_SOURCE
 #endif
 #include <errno.h>
+#include <stdint.h>
 #include "cathreadpool.h"
 #include "uarraylist.h"
 #include "octhread.h"
 
-#include "edge_random.h"
 #include "edge_malloc.h"
 #include "edge_logger.h"
 
 #define TAG "UTHREADPOOL"
 
 /**
- * empty struct to represent the details.  This implementation has no data
- * that it needs to keep track of, so it only uses NULL for the internal value.
+ * A single unit of work queued in the pool.
  */
-typedef struct ca_thread_pool_details_t
+typedef struct ca_thread_pool_task_t
 {
-    u_arraylist_t* threads_list;
-    oc_mutex list_lock;
-} ca_thread_pool_details_t;
+    ca_thread_func func;
+    void *data;
+    uint32_t taskId;
+    bool tracked;   // true if the caller asked for a taskId and may wait on it.
+    struct ca_thread_pool_task_t *next;
+} ca_thread_pool_task_t;
 
 /**
- * struct to wrap the pthreads callback properly.  The function pointer for
- * pthreads requires a void* return value, however u_thread_func is a void.
+ * FIFO of tasks.  Both ends are kept so that push and pop are O(1).
  */
-typedef struct ca_thread_pool_callback_info_t
+typedef struct ca_thread_pool_task_queue_t
 {
-    ca_thread_func func;
-    void* data;
-} ca_thread_pool_callback_info_t;
+    ca_thread_pool_task_t *head;
+    ca_thread_pool_task_t *tail;
+} ca_thread_pool_task_queue_t;
+
+struct ca_thread_pool_details_t;
 
-typedef struct ca_thread_pool_thread_info_t
+/**
+ * Worker thread state.  The local queue is only used when work stealing is
+ * enabled; it receives the tasks that a worker schedules for itself and is
+ * drained by idle siblings when its owner is busy.  local_lock guards it.
+ */
+typedef struct ca_thread_pool_worker_t
 {
     oc_thread thread;
-    uint32_t taskId;
-} ca_thread_pool_thread_info_t;
+    uint32_t index;
+    struct ca_thread_pool_details_t *details;
+    oc_mutex local_lock;
+    ca_thread_pool_task_queue_t local_queue;
+} ca_thread_pool_worker_t;
+
+/**
+ * Pool state.  list_lock guards the shared queue, pending_tasks (the tasks in it)
+ * and the tracked tasks.  local_tasks counts the tasks in the local queues; it is
+ * updated atomically under the lock of the local queue.  Workers take tasks from the
+ * local queues without list_lock and only use it for the shared queue and to sleep.
+ */
+typedef struct ca_thread_pool_details_t
+{
+    oc_mutex list_lock;
+    oc_cond task_cond;
+    oc_cond done_cond;
+    ca_thread_pool_task_queue_t shared_queue;
+    uint32_t pending_tasks;
+    uint32_t local_tasks;
+    uint32_t next_task_id;
+    u_arraylist_t *tracked_tasks;
+    bool work_stealing;
+    bool is_stop;
+    int32_t num_of_threads;
+    ca_thread_pool_worker_t *workers;
+} ca_thread_pool_details_t;
+
+// worker owning the calling thread, NULL for threads outside of any pool.
+static __thread ca_thread_pool_worker_t *t_current_worker = NULL;
+
+static void ca_thread_pool_queue_push(ca_thread_pool_task_queue_t *queue,
+                                      ca_thread_pool_task_t *task)
+{
+    task->next = NULL;
+    if (queue->tail)
+    {
+        queue->tail->next = task;
+    }
+    else
+    {
+        queue->head = task;
+    }
+    queue->tail = task;
+}
+
+static ca_thread_pool_task_t *ca_thread_pool_queue_pop(ca_thread_pool_task_queue_t *queue)
+{
+    ca_thread_pool_task_t *task = queue->head;
+    if (task)
+    {
+        queue->head = task->next;
+        if (!queue->head)
+        {
+            queue->tail = NULL;
+        }
+        task->next = NULL;
+    }
+    return task;
+}
+
+static ca_thread_pool_task_t *ca_thread_pool_pop_local(ca_thread_pool_worker_t *worker)
+{
+    ca_thread_pool_details_t *details = worker->details;
+    oc_mutex_lock(worker->local_lock);
+    ca_thread_pool_task_t *task = ca_thread_pool_queue_pop(&worker->local_queue);
+    if (task)
+    {
+        __atomic_sub_fetch(&details->local_tasks, 1, __ATOMIC_ACQ_REL);
+    }
+    oc_mutex_unlock(worker->local_lock);
+    return task;
+}
 
-// passthrough function to convert the pthreads call to a u_thread_func call
-void* ca_thread_pool_pthreads_delegate(void* data)
+// Takes a task from the own local queue, or steals one from the local queue of
+// another worker.  Called without list_lock.
+static ca_thread_pool_task_t *ca_thread_pool_take_local_task(ca_thread_pool_worker_t *worker)
 {
-    ca_thread_pool_callback_info_t* info = (ca_thread_pool_callback_info_t*)data;
-    info->func(info->data);
-    EdgeFree(info);
+    ca_thread_pool_details_t *details = worker->details;
+    if (0 == __atomic_load_n(&details->local_tasks, __ATOMIC_ACQUIRE))
+    {
+        return NULL;
+    }
+
+    ca_thread_pool_task_t *task = ca_thread_pool_pop_local(worker);
+    if (task)
+    {
+        return task;
+    }
+
+    for (int32_t i = 1; i < details->num_of_threads; ++i)
+    {
+        ca_thread_pool_worker_t *victim =
+                &details->workers[(worker->index + i) % details->num_of_threads];
+        task = ca_thread_pool_pop_local(victim);
+        if (task)
+        {
+            EDGE_LOG_V(TAG, "worker %u stole task from worker %u", worker->index,
+                    victim->index);
+            return task;
+        }
+    }
+    return NULL;
+}
+
+static void ca_thread_pool_finish_task(ca_thread_pool_details_t *details,
+                                       ca_thread_pool_task_t *task)
+{
+    if (task->tracked)
+    {
+        oc_mutex_lock(details->list_lock);
+        uint32_t index = 0;
+        if (u_arraylist_get_index(details->tracked_tasks,
+                (void *) (uintptr_t) task->taskId, &index))
+        {
+            u_arraylist_remove(details->tracked_tasks, index);
+        }
+        oc_cond_broadcast(details->done_cond);
+        oc_mutex_unlock(details->list_lock);
+    }
+    EdgeFree(task);
+}
+
+static void *ca_thread_pool_worker_routine(void *data)
+{
+    ca_thread_pool_worker_t *worker = (ca_thread_pool_worker_t *) data;
+    ca_thread_pool_details_t *details = worker->details;
+    t_current_worker = worker;
+
+    EDGE_LOG_V(TAG, "worker %u start", worker->index);
+
+    while (true)
+    {
+        ca_thread_pool_task_t *task = NULL;
+        if (details->work_stealing)
+        {
+            task = ca_thread_pool_take_local_task(worker);
+        }
+
+        if (!task)
+        {
+            oc_mutex_lock(details->list_lock);
+            // a local task pushed after the check above is counted before its
+            // producer signals task_cond under list_lock, so the wakeup is not lost.
+            while (0 == details->pending_tasks && !details->is_stop
+                    && 0 == __atomic_load_n(&details->local_tasks, __ATOMIC_ACQUIRE))
+            {
+                oc_cond_wait(details->task_cond, details->list_lock);
+            }
+
+            if (details->pending_tasks)
+            {
+                details->pending_tasks--;
+                task = ca_thread_pool_queue_pop(&details->shared_queue);
+            }
+            else if (0 == __atomic_load_n(&details->local_tasks, __ATOMIC_ACQUIRE))
+            {
+                // on stop, keep running until every scheduled task has been executed.
+                oc_mutex_unlock(details->list_lock);
+                break;
+            }
+            oc_mutex_unlock(details->list_lock);
+
+            if (!task)
+            {
+                // a local task is queued, take or steal it without list_lock.
+                continue;
+            }
+        }
+
+        task->func(task->data);
+        ca_thread_pool_finish_task(details, task);
+    }
+
+    EDGE_LOG_V(TAG, "worker %u end", worker->index);
+    t_current_worker = NULL;
     return NULL;
 }
 
-// this implementation doesn't do a thread pool, so this function is essentially
-// a no-op besides creating a valid ca_thread_pool_t object.  It was determined after
-// reading through the existing implementation that the thread-pooling was unnecessary
-// for the posix platforms.  Behavior shouldn't be changed since previously num_of_threads
-// was greater than the number of requested threads.
+static void ca_thread_pool_free_details(ca_thread_pool_details_t *details)
+{
+    if (details->workers)
+    {
+        for (int32_t i = 0; i < details->num_of_threads; ++i)
+        {
+            if (details->workers[i].local_lock)
+            {
+                oc_mutex_free(details->workers[i].local_lock);
+            }
+        }
+        EdgeFree(details->workers);
+    }
+
+    if (details->tracked_tasks)
+    {
+        u_arraylist_free(&details->tracked_tasks);
+    }
+
+    if (details->task_cond)
+    {
+        oc_cond_free(details->task_cond);
+    }
+
+    if (details->done_cond)
+    {
+        oc_cond_free(details->done_cond);
+    }
+
+    if (details->list_lock)
+    {
+        oc_mutex_free(details->list_lock);
+    }
+
+    EdgeFree(details);
+}
+
+// Stops and joins the first num_started workers.
+static void ca_thread_pool_join_workers(ca_thread_pool_details_t *details, int32_t num_started)
+{
+    oc_mutex_lock(details->list_lock);
+    details->is_stop = true;
+    oc_cond_broadcast(details->task_cond);
+    oc_mutex_unlock(details->list_lock);
+
+    for (int32_t i = 0; i < num_started; ++i)
+    {
+        ca_thread_pool_worker_t *worker = &details->workers[i];
+        if (worker->thread)
+        {
+            EDGE_LOG_V(TAG, "waiting.. worker: %u", worker->index);
+            oc_thread_wait(worker->thread);
+            oc_thread_free(worker->thread);
+            worker->thread = NULL;
+        }
+    }
+}
+
 CAResult_t ca_thread_pool_init(int32_t num_of_threads, ca_thread_pool_t *thread_pool)
+{
+    return ca_thread_pool_init_ex(num_of_threads, false, thread_pool);
+}
+
+CAResult_t ca_thread_pool_init_ex(int32_t num_of_threads, bool work_stealing,
+                                  ca_thread_pool_t *thread_pool)
 {
     EDGE_LOG(TAG, "IN");
 
@@ -102,40 +337,61 @@ CAResult_t ca_thread_pool_init(int32_t num_of_threads, ca_thread_pool_t *thread_
         return CA_MEMORY_ALLOC_FAILED;
     }
 
-    (*thread_pool)->details = EdgeMalloc(sizeof(struct ca_thread_pool_details_t));
-    if(!(*thread_pool)->details)
+    ca_thread_pool_details_t *details = EdgeCalloc(1, sizeof(struct ca_thread_pool_details_t));
+    if(!details)
     {
         EDGE_LOG(TAG, "Failed to allocate for thread-pool details");
         EdgeFree(*thread_pool);
         *thread_pool=NULL;
         return CA_MEMORY_ALLOC_FAILED;
     }
-
-    (*thread_pool)->details->list_lock = oc_mutex_new();
-
-    if(!(*thread_pool)->details->list_lock)
+    (*thread_pool)->details = details;
+
+    details->num_of_threads = num_of_threads;
+    details->work_stealing = work_stealing;
+    details->list_lock = oc_mutex_new();
+    details->task_cond = oc_cond_new();
+    details->done_cond = oc_cond_new();
+    details->tracked_tasks = u_arraylist_create();
+    details->workers = EdgeCalloc(num_of_threads, sizeof(ca_thread_pool_worker_t));
+
+    if(!details->list_lock || !details->task_cond || !details->done_cond
+            || !details->tracked_tasks || !details->workers)
     {
-        EDGE_LOG(TAG, "Failed to create thread-pool mutex");
+        EDGE_LOG(TAG, "Failed to create thread-pool resources");
         goto exit;
     }
 
-    (*thread_pool)->details->threads_list = u_arraylist_create();
+    for (int32_t i = 0; i < num_of_threads; ++i)
+    {
+        details->workers[i].index = (uint32_t) i;
+        details->workers[i].details = details;
+        details->workers[i].local_lock = oc_mutex_new();
+        if (!details->workers[i].local_lock)
+        {
+            EDGE_LOG(TAG, "Failed to create worker lock");
+            goto exit;
+        }
+    }
 
-    if(!(*thread_pool)->details->threads_list)
+    for (int32_t i = 0; i < num_of_threads; ++i)
     {
-        EDGE_LOG(TAG, "Failed to create thread-pool list");
-        if(!oc_mutex_free((*thread_pool)->details->list_lock))
+        ca_thread_pool_worker_t *worker = &details->workers[i];
+        int thrRet = oc_thread_new(&worker->thread, ca_thread_pool_worker_routine, worker);
+        if (thrRet != 0)
         {
-            EDGE_LOG(TAG, "Failed to free thread-pool mutex");
+            EDGE_LOG_V(TAG, "Worker start failed with error %d", thrRet);
+            worker->thread = NULL;
+            ca_thread_pool_join_workers(details, i);
+            goto exit;
         }
-        goto exit;
     }
 
     EDGE_LOG(TAG, "OUT");
     return CA_STATUS_OK;
 
 exit:
-    EdgeFree((*thread_pool)->details);
+    ca_thread_pool_free_details(details);
     EdgeFree(*thread_pool);
     *thread_pool = NULL;
     return CA_STATUS_FAILED;
@@ -152,58 +408,61 @@ CAResult_t ca_thread_pool_add_task(ca_thread_pool_t thread_pool, ca_thread_func
         return CA_STATUS_INVALID_PARAM;
     }
 
-    ca_thread_pool_callback_info_t* info = EdgeMalloc(sizeof(ca_thread_pool_callback_info_t));
-    if(!info)
+    ca_thread_pool_task_t *task = EdgeMalloc(sizeof(ca_thread_pool_task_t));
+    if(!task)
     {
-        EDGE_LOG(TAG, "Failed to allocate for memory wrapper");
+        EDGE_LOG(TAG, "Failed to allocate for task");
         return CA_MEMORY_ALLOC_FAILED;
     }
 
-    info->func = method;
-    info->data = data;
+    task->func = method;
+    task->data = data;
+    task->next = NULL;
+    task->tracked = (NULL != taskId);
+
+    ca_thread_pool_details_t *details = thread_pool->details;
+    ca_thread_pool_worker_t *worker = t_current_worker;
+    bool local = (details->work_stealing && worker && worker->details == details);
 
-    ca_thread_pool_thread_info_t *threadInfo =
-            (ca_thread_pool_thread_info_t *) EdgeCalloc(1, sizeof(ca_thread_pool_thread_info_t));
-    if (!threadInfo)
+    uint32_t queuedTaskId = __atomic_add_fetch(&details->next_task_id, 1, __ATOMIC_RELAXED);
+    task->taskId = queuedTaskId;
+    if (task->tracked)
     {
-        EDGE_LOG(TAG, "Memory allocation failed");
-        EdgeFree(info);
-        return CA_STATUS_FAILED;
+        oc_mutex_lock(details->list_lock);
+        if (!u_arraylist_add(details->tracked_tasks, (void *) (uintptr_t) task->taskId))
+        {
+            // Note that this is considered non-fatal.
+            EDGE_LOG(TAG, "Arraylist add failed");
+            task->tracked = false;
+        }
+        oc_mutex_unlock(details->list_lock);
     }
-    threadInfo->taskId = EdgeGetRandom();
-    if (taskId)
+
+    // Tasks scheduled from inside a worker stay on that worker when work
+    // stealing is enabled; idle siblings pick them up if the owner is busy.
+    if (local)
     {
-        *taskId = threadInfo->taskId;
+        oc_mutex_lock(worker->local_lock);
+        ca_thread_pool_queue_push(&worker->local_queue, task);
+        __atomic_add_fetch(&details->local_tasks, 1, __ATOMIC_ACQ_REL);
+        oc_mutex_unlock(worker->local_lock);
     }
 
-    oc_mutex_lock(thread_pool->details->list_lock);
-    bool addResult = u_arraylist_add(thread_pool->details->threads_list, (void*) threadInfo);
-    if (!addResult)
+    oc_mutex_lock(details->list_lock);
+    if (!local)
     {
-        // Note that this is considered non-fatal.
-        oc_mutex_unlock(thread_pool->details->list_lock);
-        EDGE_LOG(TAG, "Arraylist add failed");
-        EdgeFree(info);
-        EdgeFree(threadInfo);
-        return CA_STATUS_FAILED;
+        ca_thread_pool_queue_push(&details->shared_queue, task);
+        details->pending_tasks++;
     }
+    oc_cond_signal(details->task_cond);
+    oc_mutex_unlock(details->list_lock);
 
-    int thrRet = oc_thread_new(&threadInfo->thread, ca_thread_pool_pthreads_delegate, info);
-    if (thrRet != 0)
+    if (taskId)
     {
-        uint32_t index = 0;
-        if (u_arraylist_get_index(thread_pool->details->threads_list, threadInfo, &index))
-        {
-            u_arraylist_remove(thread_pool->details->threads_list, index);
-        }
-        oc_mutex_unlock(thread_pool->details->list_lock);
-        EDGE_LOG_V(TAG, "Thread start failed with error %d", thrRet);
-        EdgeFree(info);
-        return CA_STATUS_FAILED;
+        *taskId = queuedTaskId;
     }
-    EDGE_LOG_V(TAG, "created taskId: %u", threadInfo->taskId);
-    oc_mutex_unlock(thread_pool->details->list_lock);
 
+    EDGE_LOG_V(TAG, "queued taskId: %u", queuedTaskId);
     EDGE_LOG_V(TAG, "Out %s", __func__);
     return CA_STATUS_OK;
 }
@@ -218,28 +477,17 @@ CAResult_t ca_thread_pool_remove_task(ca_thread_pool_t thread_pool, uint32_t tas
         return CA_STATUS_FAILED;
     }
 
-    oc_mutex_lock(thread_pool->details->list_lock);
-    for (uint32_t i = 0; i < u_arraylist_length(thread_pool->details->threads_list); ++i)
+    // Tasks cannot be cancelled once queued; wait until the task has run.
+    ca_thread_pool_details_t *details = thread_pool->details;
+    oc_mutex_lock(details->list_lock);
+    while (u_arraylist_contains(details->tracked_tasks, (void *) (uintptr_t) taskId))
     {
-        ca_thread_pool_thread_info_t *threadInfo = (ca_thread_pool_thread_info_t *)
-                u_arraylist_get(thread_pool->details->threads_list, i);
-        if (threadInfo)
-        {
-            if (threadInfo->taskId == taskId)
-            {
-                EDGE_LOG_V(TAG, "waiting.. taskId: %u", threadInfo->taskId);
-                oc_thread_wait(threadInfo->thread);
-
-                EDGE_LOG_V(TAG, "removed taskId: %u", threadInfo->taskId);
-                u_arraylist_remove(thread_pool->details->threads_list, i);
-                oc_thread_free(threadInfo->thread);
-                EdgeFree(threadInfo);
-                break;
-            }
-        }
+        EDGE_LOG_V(TAG, "waiting.. taskId: %u", taskId);
+        oc_cond_wait(details->done_cond, details->list_lock);
     }
-    oc_mutex_unlock(thread_pool->details->list_lock);
+    oc_mutex_unlock(details->list_lock);
 
+    EDGE_LOG_V(TAG, "removed taskId: %u", taskId);
     EDGE_LOG_V(TAG, "Out %s", __func__);
     return CA_STATUS_OK;
 }
@@ -254,30 +502,17 @@ void ca_thread_pool_free(ca_thread_pool_t thread_pool)
         return;
     }
 
-    oc_mutex_lock(thread_pool->details->list_lock);
-
-    for (uint32_t i = 0; i < u_arraylist_length(thread_pool->details->threads_list); ++i)
+    ca_thread_pool_details_t *details = thread_pool->details;
+    if (t_current_worker && t_current_worker->details == details)
     {
-        ca_thread_pool_thread_info_t *threadInfo = (ca_thread_pool_thread_info_t *)
-                u_arraylist_get(thread_pool->details->threads_list, i);
-        if (threadInfo)
-        {
-            if (threadInfo->thread)
-            {
-                EDGE_LOG_V(TAG, "waiting.. thread: %p", threadInfo->thread);
-                oc_thread_wait(threadInfo->thread);
-                oc_thread_free(threadInfo->thread);
-            }
-            EdgeFree(threadInfo);
-        }
+        // A worker cannot join itself; leave the pool alive rather than
+        // freeing memory that is still in use.
+        EDGE_LOG(TAG, "thread pool cannot be freed from one of its own tasks");
+        return;
     }
 
-    u_arraylist_free(&(thread_pool->details->threads_list));
-
-    oc_mutex_unlock(thread_pool->details->list_lock);
-    oc_mutex_free(thread_pool->details->list_lock);
-
-    EdgeFree(thread_pool->details);
+    ca_thread_pool_join_workers(details, details->num_of_threads);
+    ca_thread_pool_free_details(details);
     EdgeFree(thread_pool);
 
     EDGE_LOG_V(TAG, "Out %s", __func__);
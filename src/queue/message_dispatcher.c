@@ -20,43 +20,100 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <pthread.h>
 #include <unistd.h>
+#include <time.h>
 
 #include "uqueue.h"
 #include "cacommon.h"
 #include "cathreadpool.h" /* for thread pool */
 #include "caqueueingthread.h"
+#include "calanedispatcher.h"
+#include "cahistogram.h"
 #include "message_dispatcher.h"
 #include "edge_utils.h"
+#include "cmd_util.h"
 #include "edge_malloc.h"
 #include "edge_logger.h"
 
 #define SINGLE_HANDLE
-#define MAX_THREAD_POOL_SIZE    20
+/* Send lanes processed in parallel. */
+#define MAX_SEND_LANE_WORKERS   16
+/* One pool thread for each send lane worker and one for the receive thread. */
+#define MAX_THREAD_POOL_SIZE    (MAX_SEND_LANE_WORKERS + 1)
+/* Lane for the requests which do not carry an endpoint. */
+#define DEFAULT_SEND_LANE       ""
+/* Longest lane key of a spread request; longer session keys keep their first lane. */
+#define SEND_LANE_KEY_SIZE      128
+/* Responses the receive thread takes from its queue at once. */
+#define RECEIVE_DRAIN_SIZE      32
 
 #define TAG "message_handler"
 
 // thread pool handle
 static ca_thread_pool_t g_threadPoolHandle = NULL;
 
+// requests are dispatched on one serial lane per endpoint session
+static CALaneDispatcher_t g_sendLanes;
 // message handler main thread
-static CAQueueingThread_t g_sendThread;
 static CAQueueingThread_t g_receiveThread;
 
+// send queue limit, see configureSendQueue
+static uint32_t g_sendQueueCapacity = 0;
+static CAQueueFullPolicy g_sendQueueFullPolicy = CA_QUEUE_FULL_REJECT;
+static uint32_t g_sendQueueTimeoutMs = 0;
+
+// read coalescing, see configureReadCoalescing
+static uint32_t g_readCoalesceMaxMessages = 0;
+static uint32_t g_readCoalesceWindowMs = 0;
+static send_batch_cb_t g_sendBatchCallback = NULL;
+
+// lanes per endpoint session, see configureSendLanes
+static uint32_t g_lanesPerEndpoint = 1;
+static uint32_t g_nextLane = 0;
+
+// statistics of one queue, updated lock-free
+typedef struct
+{
+    uint64_t depth;
+    uint64_t depthHighWatermark;
+    uint64_t enqueued;
+    uint64_t dropped;
+    CAHistogram_t waitTime;
+    CAHistogram_t serviceTime;
+} QueueStats;
+
+static QueueStats g_sendStats;
+static QueueStats g_receiveStats;
+static uint64_t g_commandCounts[EDGE_COMMAND_COUNT];
+
+// response capture of a synchronous request running on this thread
+static __thread EdgeMessage **t_capturedResponse = NULL;
+
 static response_cb_t g_responseCallback = NULL;
 static send_cb_t g_sendCallback = NULL;
 
 static void handleMessage(EdgeMessage *data);
 static void destroyData(void *data, uint32_t size);
+static void dropData(void *data, uint32_t size);
+static bool isSameCommand(const void *queued, const void *data);
+static uintptr_t getCommandClass(const void *data);
+static bool isCoalescableRead(const void *queued, const void *data);
 
 void delete_queue()
 {
-    // stop thread
-    // delete thread data
-    if (NULL != g_sendThread.threadMutex)
+    if (CALaneDispatcherIsWorkerThread(&g_sendLanes))
     {
-        CAQueueingThreadStop(&g_sendThread);
+        // a send request cannot join the pool it is running on.
+        EDGE_LOG(TAG, "delete_queue called from a send request, queues are kept.");
+        return;
+    }
+
+    // stop lanes
+    if (NULL != g_sendLanes.laneMutex)
+    {
+        CALaneDispatcherStop(&g_sendLanes);
     }
 
     // stop thread
@@ -73,32 +130,258 @@ void delete_queue()
         g_threadPoolHandle = NULL;
     }
 
-    CAQueueingThreadDestroy(&g_sendThread);
+    CALaneDispatcherDestroy(&g_sendLanes);
     CAQueueingThreadDestroy(&g_receiveThread);
+
+    __atomic_store_n(&g_sendStats.depth, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_receiveStats.depth, 0, __ATOMIC_RELAXED);
+}
+
+static uint64_t getTimeUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void statsQueued(QueueStats *stats, EdgeMessage *msg)
+{
+    msg->queuedTime = getTimeUs();
+    __atomic_fetch_add(&stats->enqueued, 1, __ATOMIC_RELAXED);
+
+    uint64_t depth = __atomic_add_fetch(&stats->depth, 1, __ATOMIC_RELAXED);
+    uint64_t highWatermark = __atomic_load_n(&stats->depthHighWatermark, __ATOMIC_RELAXED);
+    while (depth > highWatermark
+            && !__atomic_compare_exchange_n(&stats->depthHighWatermark, &highWatermark, depth,
+                    true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+static void statsRemoved(QueueStats *stats)
+{
+    __atomic_fetch_sub(&stats->depth, 1, __ATOMIC_RELAXED);
+}
+
+/* Counts a queued message which is destroyed without being processed */
+static void statsDropped(QueueStats *stats)
+{
+    statsRemoved(stats);
+    __atomic_fetch_add(&stats->dropped, 1, __ATOMIC_RELAXED);
+}
+
+/* Records the wait time of msg and returns the time its processing starts */
+static uint64_t statsDequeued(QueueStats *stats, const EdgeMessage *msg)
+{
+    uint64_t now = getTimeUs();
+    statsRemoved(stats);
+    CAHistogramRecord(&stats->waitTime, now - msg->queuedTime);
+    return now;
 }
 
 static void sendQ_run(void *ptr)
 {
     EdgeMessage *data = (EdgeMessage *) ptr;
+    uint64_t start = statsDequeued(&g_sendStats, data);
     handleMessage(data);
+    CAHistogramRecord(&g_sendStats.serviceTime, getTimeUs() - start);
+}
+
+static void sendQ_runBatch(void **ptr, uint32_t count)
+{
+    EdgeMessage **data = (EdgeMessage **) ptr;
+    uint64_t start = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        start = statsDequeued(&g_sendStats, data[i]);
+    }
+    g_sendBatchCallback(data, count);
+
+    // the requests of a batch share its service time.
+    uint64_t serviceTime = (getTimeUs() - start) / count;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        CAHistogramRecord(&g_sendStats.serviceTime, serviceTime);
+    }
 }
 
 static void recvQ_run(void *ptr)
 {
     EdgeMessage *data = (EdgeMessage *) ptr;
+    uint64_t start = statsDequeued(&g_receiveStats, data);
     handleMessage(data);
+    CAHistogramRecord(&g_receiveStats.serviceTime, getTimeUs() - start);
+}
+
+static uint32_t getPriority(const EdgeMessage *msg)
+{
+    EdgeMessagePriority priority = msg ? msg->priority : EDGE_PRIORITY_DEFAULT;
+    if (EDGE_PRIORITY_DEFAULT == priority && msg)
+    {
+        if (REPORT == msg->type)
+        {
+            priority = EDGE_PRIORITY_SUBSCRIPTION;
+        }
+        else if (BROWSE_RESPONSE == msg->type)
+        {
+            priority = EDGE_PRIORITY_BROWSE;
+        }
+        else
+        {
+            switch (msg->command)
+            {
+                case CMD_WRITE:
+                case CMD_START_SERVER:
+                case CMD_START_CLIENT:
+                case CMD_STOP_SERVER:
+                case CMD_STOP_CLIENT:
+                    priority = EDGE_PRIORITY_CONTROL;
+                    break;
+                case CMD_SUB:
+                    priority = EDGE_PRIORITY_SUBSCRIPTION;
+                    break;
+                case CMD_BROWSE:
+                case CMD_BROWSENEXT:
+                case CMD_BROWSE_VIEW:
+                case CMD_GET_ENDPOINTS:
+                    priority = EDGE_PRIORITY_BROWSE;
+                    break;
+                default:
+                    priority = EDGE_PRIORITY_READ;
+                    break;
+            }
+        }
+    }
+
+    // EdgeMessagePriority starts at EDGE_PRIORITY_CONTROL for the highest queue priority.
+    uint32_t queuePriority = (uint32_t) priority - EDGE_PRIORITY_CONTROL;
+    return (queuePriority < CA_PRIORITY_COUNT) ? queuePriority : CA_PRIORITY_LOWEST;
+}
+
+static bool addToQueue(CAQueueingThread_t *thread, EdgeMessage *msg)
+{
+    if (msg)
+    {
+        statsQueued(&g_receiveStats, msg);
+    }
+    if (CA_STATUS_OK != CAQueueingThreadAddDataWithPriority(thread, msg, sizeof(EdgeMessage),
+            getPriority(msg)))
+    {
+        EDGE_LOG(TAG, "Failed to add message to queue, message dropped.");
+        if (msg)
+        {
+            statsDropped(&g_receiveStats);
+        }
+        destroyData(msg, sizeof(EdgeMessage));
+        return false;
+    }
+    return true;
+}
+
+/* Reads and method calls may run in parallel on the session pool of an endpoint.
+ * Everything else keeps the base lane, so writes stay in order. */
+static bool isSpreadCommand(const EdgeMessage *msg)
+{
+    if (SEND_REQUEST != msg->type && SEND_REQUESTS != msg->type)
+    {
+        return false;
+    }
+    switch (msg->command)
+    {
+        case CMD_READ:
+        case CMD_READ_SAMPLING_INTERVAL:
+        case CMD_METHOD:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static const char *getLaneKey(const EdgeMessage *msg, const char *sessionKey, char *buffer,
+        size_t size)
+{
+    uint32_t lanes = __atomic_load_n(&g_lanesPerEndpoint, __ATOMIC_RELAXED);
+    if (lanes <= 1 || !isSpreadCommand(msg))
+    {
+        return sessionKey;
+    }
+    // spread lanes are apart from the base lane, which then only holds ordered requests.
+    uint32_t lane = __atomic_fetch_add(&g_nextLane, 1, __ATOMIC_RELAXED) % lanes;
+    int length = snprintf(buffer, size, "%s#%u", sessionKey, lane);
+    return (length > 0 && (size_t) length < size) ? buffer : sessionKey;
 }
 
 bool add_to_sendQ(EdgeMessage *msg)
 {
-    CAQueueingThreadAddData(&g_sendThread, msg, sizeof(EdgeMessage));
+    char spreadKey[SEND_LANE_KEY_SIZE];
+    const char *laneKey = NULL;
+    const char *baseKey = NULL;
+    char *uncachedKey = NULL;
+    if (msg && msg->endpointInfo && msg->endpointInfo->endpointUri)
+    {
+        laneKey = getCachedSessionKey(msg->endpointInfo->endpointUri);
+        if (NULL == laneKey)
+        {
+            laneKey = uncachedKey = getSessionKey(msg->endpointInfo->endpointUri);
+        }
+        if (laneKey)
+        {
+            baseKey = laneKey;
+            laneKey = getLaneKey(msg, baseKey, spreadKey, sizeof(spreadKey));
+        }
+    }
+    if (msg)
+    {
+        statsQueued(&g_sendStats, msg);
+        if ((unsigned) msg->command < EDGE_COMMAND_COUNT)
+        {
+            __atomic_fetch_add(&g_commandCounts[msg->command], 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    // a spread request follows the ordered requests still queued or running on the base lane.
+    CAResult_t res = CALaneDispatcherAddDataFollowing(&g_sendLanes,
+            laneKey ? laneKey : DEFAULT_SEND_LANE, (laneKey == spreadKey) ? baseKey : NULL, msg,
+            sizeof(EdgeMessage), getPriority(msg));
+    EdgeFree(uncachedKey);
+    if (CA_STATUS_OK != res)
+    {
+        EDGE_LOG(TAG, "Failed to add message to send lane.");
+        if (msg)
+        {
+            statsDropped(&g_sendStats);
+        }
+        destroyData(msg, sizeof(EdgeMessage));
+        return false;
+    }
     return true;
 }
 
+void captureResponse(EdgeMessage **response)
+{
+    t_capturedResponse = response;
+}
+
 bool add_to_recvQ(EdgeMessage *msg)
 {
-    CAQueueingThreadAddData(&g_receiveThread, msg, sizeof(EdgeMessage));
-    return true;
+    if (t_capturedResponse && msg)
+    {
+        /* Errors of single items come before the response of the other items and give
+         * way to it. Every other message of the call is discarded. */
+        EdgeMessage *captured = *t_capturedResponse;
+        if (NULL == captured || (ERROR == captured->type && ERROR != msg->type))
+        {
+            *t_capturedResponse = msg;
+            msg = captured;
+        }
+        if (msg)
+        {
+            destroyData(msg, sizeof(EdgeMessage));
+        }
+        return true;
+    }
+
+    return addToQueue(&g_receiveThread, msg);
 }
 
 static void handleMessage(EdgeMessage *data)
@@ -116,8 +399,111 @@ static void handleMessage(EdgeMessage *data)
     }
 }
 
+void configureSendQueue(size_t capacity, EdgeQueueFullPolicy policy, uint32_t timeoutMs)
+{
+    g_sendQueueCapacity = (capacity > UINT32_MAX) ? UINT32_MAX : (uint32_t) capacity;
+    switch (policy)
+    {
+        case EDGE_QUEUE_FULL_BLOCK:
+            g_sendQueueFullPolicy = CA_QUEUE_FULL_BLOCK;
+            break;
+        case EDGE_QUEUE_FULL_DROP_OLDEST:
+            g_sendQueueFullPolicy = CA_QUEUE_FULL_DROP_OLDEST;
+            break;
+        default:
+            g_sendQueueFullPolicy = CA_QUEUE_FULL_REJECT;
+            break;
+    }
+    g_sendQueueTimeoutMs = timeoutMs;
+}
+
+void configureReadCoalescing(size_t maxMessages, uint32_t windowMs, send_batch_cb_t batchCallback)
+{
+    g_readCoalesceMaxMessages = (maxMessages > UINT32_MAX) ? UINT32_MAX : (uint32_t) maxMessages;
+    g_readCoalesceWindowMs = windowMs;
+    g_sendBatchCallback = batchCallback;
+}
+
+void configureSendLanes(size_t lanesPerEndpoint)
+{
+    uint32_t lanes = (lanesPerEndpoint > MAX_SEND_LANE_WORKERS) ? MAX_SEND_LANE_WORKERS :
+            (uint32_t) lanesPerEndpoint;
+    __atomic_store_n(&g_lanesPerEndpoint, lanes ? lanes : 1, __ATOMIC_RELAXED);
+}
+
+bool getSendQueueFullStats(EdgeSendQueueStats *stats)
+{
+    CAQueueFullStats_t fullStats;
+    if (NULL == stats || CA_STATUS_OK != CALaneDispatcherGetFullStats(&g_sendLanes, &fullStats))
+    {
+        return false;
+    }
+
+    stats->rejected = fullStats.rejected;
+    stats->blocked = fullStats.blocked;
+    stats->blockTimeouts = fullStats.blockTimeouts;
+    stats->dropped = fullStats.dropped;
+    return true;
+}
+
+static void getLatencyStats(const CAHistogram_t *histogram, EdgeLatencyStats *stats)
+{
+    stats->count = __atomic_load_n(&histogram->count, __ATOMIC_RELAXED);
+    stats->meanUs = CAHistogramMean(histogram);
+    stats->p50Us = CAHistogramPercentile(histogram, 50.0);
+    stats->p90Us = CAHistogramPercentile(histogram, 90.0);
+    stats->p99Us = CAHistogramPercentile(histogram, 99.0);
+    stats->maxUs = __atomic_load_n(&histogram->max, __ATOMIC_RELAXED);
+}
+
+static void getQueueStats(const QueueStats *queueStats, EdgeQueueStats *stats)
+{
+    stats->depth = __atomic_load_n(&queueStats->depth, __ATOMIC_RELAXED);
+    stats->depthHighWatermark = __atomic_load_n(&queueStats->depthHighWatermark, __ATOMIC_RELAXED);
+    stats->enqueued = __atomic_load_n(&queueStats->enqueued, __ATOMIC_RELAXED);
+    stats->dropped = __atomic_load_n(&queueStats->dropped, __ATOMIC_RELAXED);
+    getLatencyStats(&queueStats->waitTime, &stats->waitTime);
+    getLatencyStats(&queueStats->serviceTime, &stats->serviceTime);
+}
+
+static void resetQueueStats(QueueStats *stats)
+{
+    __atomic_store_n(&stats->depthHighWatermark, __atomic_load_n(&stats->depth, __ATOMIC_RELAXED),
+            __ATOMIC_RELAXED);
+    __atomic_store_n(&stats->enqueued, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&stats->dropped, 0, __ATOMIC_RELAXED);
+    CAHistogramReset(&stats->waitTime);
+    CAHistogramReset(&stats->serviceTime);
+}
+
+void getMQStats(EdgeDispatcherStats *stats)
+{
+    getQueueStats(&g_sendStats, &stats->sendQueue);
+    getQueueStats(&g_receiveStats, &stats->receiveQueue);
+    for (size_t i = 0; i < EDGE_COMMAND_COUNT; i++)
+    {
+        stats->commandCounts[i] = __atomic_load_n(&g_commandCounts[i], __ATOMIC_RELAXED);
+    }
+}
+
+void resetMQStats()
+{
+    resetQueueStats(&g_sendStats);
+    resetQueueStats(&g_receiveStats);
+    for (size_t i = 0; i < EDGE_COMMAND_COUNT; i++)
+    {
+        __atomic_store_n(&g_commandCounts[i], 0, __ATOMIC_RELAXED);
+    }
+}
+
 void registerMQCallback(response_cb_t resCallback, send_cb_t sendCallback)
 {
+    if (NULL != g_threadPoolHandle)
+    {
+        // queues kept by a client stopped with CMD_STOP_CLIENT.
+        delete_queue();
+    }
+
     CAResult_t res = ca_thread_pool_init(MAX_THREAD_POOL_SIZE, &g_threadPoolHandle);
     if (CA_STATUS_OK != res)
     {
@@ -125,21 +511,34 @@ void registerMQCallback(response_cb_t resCallback, send_cb_t sendCallback)
         return;
     }
 
-    // send thread initialize
-    res = CAQueueingThreadInitialize(&g_sendThread, g_threadPoolHandle, sendQ_run, destroyData);
+    // send lanes initialize
+    res = CALaneDispatcherInitialize(&g_sendLanes, g_threadPoolHandle, MAX_SEND_LANE_WORKERS,
+            sendQ_run, destroyData);
     if (CA_STATUS_OK != res)
     {
-        EDGE_LOG(TAG, "Failed to Initialize send queue thread");
+        EDGE_LOG(TAG, "Failed to Initialize send lanes");
         return;
     }
 
-    res = CAQueueingThreadStart(&g_sendThread);
+    res = CALaneDispatcherSetCapacity(&g_sendLanes, g_sendQueueCapacity, g_sendQueueFullPolicy,
+            g_sendQueueTimeoutMs, getCommandClass, dropData);
     if (CA_STATUS_OK != res)
     {
-        EDGE_LOG(TAG, "thread start error(send thread).");
+        EDGE_LOG(TAG, "Failed to set send lanes capacity");
         return;
     }
 
+    if (g_sendBatchCallback && g_readCoalesceMaxMessages > 1)
+    {
+        res = CALaneDispatcherSetBatch(&g_sendLanes, isCoalescableRead, sendQ_runBatch,
+                g_readCoalesceMaxMessages, g_readCoalesceWindowMs);
+        if (CA_STATUS_OK != res)
+        {
+            EDGE_LOG(TAG, "Failed to enable read coalescing");
+            return;
+        }
+    }
+
     // receive thread initialize
     res = CAQueueingThreadInitialize(&g_receiveThread, g_threadPoolHandle, recvQ_run, destroyData);
     if (CA_STATUS_OK != res)
@@ -148,6 +547,13 @@ void registerMQCallback(response_cb_t resCallback, send_cb_t sendCallback)
         return;
     }
 
+    res = CAQueueingThreadSetBatch(&g_receiveThread, RECEIVE_DRAIN_SIZE, NULL);
+    if (CA_STATUS_OK != res)
+    {
+        EDGE_LOG(TAG, "Failed to set receive queue drain size");
+        return;
+    }
+
     res = CAQueueingThreadStart(&g_receiveThread);
     if (CA_STATUS_OK != res)
     {
@@ -178,3 +584,31 @@ static void destroyData(void *data, uint32_t size)
     freeEdgeMessage(msg);
     EDGE_LOG(TAG, "destroyData OUT");
 }
+
+static void dropData(void *data, uint32_t size)
+{
+    EdgeMessage *msg = (EdgeMessage *) data;
+    if (NULL != msg)
+    {
+        statsDropped(&g_sendStats);
+        sendErrorResponse(msg, "Request dropped, send queue is full");
+    }
+    destroyData(data, size);
+}
+
+static bool isSameCommand(const void *queued, const void *data)
+{
+    return ((const EdgeMessage *) queued)->command == ((const EdgeMessage *) data)->command;
+}
+
+static uintptr_t getCommandClass(const void *data)
+{
+    return (uintptr_t) ((const EdgeMessage *) data)->command;
+}
+
+static bool isCoalescableRead(const void *queued, const void *data)
+{
+    const EdgeMessage *msg = (const EdgeMessage *) queued;
+    return (CMD_READ == msg->command || CMD_READ_SAMPLING_INTERVAL == msg->command)
+            && SEND_REQUESTS == msg->type && msg->requests && isSameCommand(queued, data);
+}
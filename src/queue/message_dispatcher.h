@@ -28,33 +28,94 @@
 #define EDGE_MESSAGE_DISPATCHER_H
 
 #include "opcua_common.h"
+#include "opcua_interface.h"
 #include "command_adapter.h"
 
 #include <stdbool.h>
 
 /**
  * @brief Add the EdgeMessage data to receiver Queue to send it to application
+ * @remarks The queue takes ownership of msg. It is freed here if it cannot be queued.
  * @param[in]  msg EdgeMessage data
  * @return @c true on success, false on failure
- * @retval #true Successful (Queue is empty)
- * @retval #false Failure (Queue is not empty)
+ * @retval #true Successful
+ * @retval #false Failure (Queue is full)
  */
 bool add_to_recvQ(EdgeMessage *msg);
 
 /**
  * @brief Add the EdgeMessage data to send Queue to send it to server for processing
+ * @remarks The queue takes ownership of msg. It is freed here if it cannot be queued.
  * @param[in]  msg EdgeMessage data
  * @return @c true on success, false on failure
- * @retval #true Successful (Queue is empty)
- * @retval #false Failure (Queue is not empty)
+ * @retval #true Successful
+ * @retval #false Failure (Queue is full)
  */
 bool add_to_sendQ(EdgeMessage *msg);
 
+/**
+ * @brief Makes add_to_recvQ on the calling thread store the messages in *response
+ *        instead of queueing them for the application
+ * @remarks Used to run a request synchronously. Only one message is kept: the first
+ *          response, or the first error if there is no response. The others are freed.
+ * @param[in]  response Location for the message, NULL to stop capturing
+ */
+void captureResponse(EdgeMessage **response);
+
 /**
  * @brief Deletes and destroys the send and receiver queue
  */
 void delete_queue();
 
+/**
+ * @brief Sets the capacity of the send queue and what add_to_sendQ does when it is full
+ * @remarks Applies to the queue created by the next registerMQCallback.
+ * @param[in]  capacity Maximum number of queued requests. 0 means unbounded
+ * @param[in]  policy Full queue policy
+ * @param[in]  timeoutMs Time to wait for room with EDGE_QUEUE_FULL_BLOCK
+ */
+void configureSendQueue(size_t capacity, EdgeQueueFullPolicy policy, uint32_t timeoutMs);
+
+/**
+ * @brief Enables sending queued read requests of the same endpoint in one call
+ * @remarks Applies to the queue created by the next registerMQCallback. Consecutive
+ *          CMD_READ or CMD_READ_SAMPLING_INTERVAL requests of the same command are given
+ *          to batchCallback together, other requests keep going to the send callback.
+ * @param[in]  maxMessages Maximum number of requests per call. 0 or 1 disables coalescing
+ * @param[in]  windowMs Time to wait for more read requests
+ * @param[in]  batchCallback Callback for handling several read requests
+ */
+void configureReadCoalescing(size_t maxMessages, uint32_t windowMs, send_batch_cb_t batchCallback);
+
+/**
+ * @brief Sets the number of send lanes of an endpoint
+ * @remarks Requests of an endpoint run one at a time on its base lane. With more lanes,
+ *          read and method requests are spread over the lanes in turn and run in parallel.
+ *          A spread request added while other requests of the endpoint are queued or running
+ *          on the base lane joins the base lane, so it runs after a preceding write. A write
+ *          may still complete before reads added earlier.
+ * @param[in]  lanesPerEndpoint Number of lanes. 0 or 1 keeps a single lane
+ */
+void configureSendLanes(size_t lanesPerEndpoint);
+
+/**
+ * @brief Gets how often the send queue full policy was applied
+ * @param[out]  stats Send queue counters
+ * @return @c true on success, false if the queue does not exist
+ */
+bool getSendQueueFullStats(EdgeSendQueueStats *stats);
+
+/**
+ * @brief Gets the depth and latency statistics of the send and receive queues
+ * @param[out]  stats Dispatcher statistics
+ */
+void getMQStats(EdgeDispatcherStats *stats);
+
+/**
+ * @brief Restarts the statistics returned by getMQStats
+ */
+void resetMQStats();
+
 /**
  * @brief Registers the callback for response and message handling
  * @param[in]  resCallback Callback for handling response message
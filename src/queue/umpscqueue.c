@@ -0,0 +1,195 @@
+/******************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+#include "umpscqueue.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include "edge_logger.h"
+#include "edge_malloc.h"
+
+/**
+ * @def TAG
+ * @brief Logging tag for module name
+ */
+#define TAG "UMPSCQUEUE"
+
+/**
+ * @def CACHE_LINE_SIZE
+ * @brief Padding used to keep producer and consumer indexes on separate cache lines
+ */
+#define CACHE_LINE_SIZE 64
+
+/**
+ * Slot of the ring.  sequence tells whose turn it is: it equals the enqueue
+ * position when the slot is free, and position + 1 once the message is published.
+ */
+typedef struct u_mpsc_cell_t
+{
+    size_t sequence;
+    void *msg;
+    uint32_t size;
+} u_mpsc_cell_t;
+
+struct u_mpsc_queue_t
+{
+    u_mpsc_cell_t *cells;
+    size_t mask;
+    char pad0[CACHE_LINE_SIZE];
+    /** Next position to be reserved by a producer. */
+    size_t enqueuePos;
+    char pad1[CACHE_LINE_SIZE - sizeof(size_t)];
+    /** Next position to be read by the consumer. */
+    size_t dequeuePos;
+    char pad2[CACHE_LINE_SIZE - sizeof(size_t)];
+};
+
+u_mpsc_queue_t *u_mpsc_queue_create(uint32_t capacity)
+{
+    if (0 == capacity || capacity > (UINT32_MAX / 2))
+    {
+        EDGE_LOG(TAG, "invalid capacity");
+        return NULL;
+    }
+
+    size_t slots = 1;
+    while (slots < capacity)
+    {
+        slots <<= 1;
+    }
+
+    u_mpsc_queue_t *queue = (u_mpsc_queue_t *) EdgeCalloc(1, sizeof(u_mpsc_queue_t));
+    if (NULL == queue)
+    {
+        EDGE_LOG(TAG, "QueueCreate FAIL");
+        return NULL;
+    }
+
+    queue->cells = (u_mpsc_cell_t *) EdgeCalloc(slots, sizeof(u_mpsc_cell_t));
+    if (NULL == queue->cells)
+    {
+        EDGE_LOG(TAG, "QueueCreate cells FAIL");
+        EdgeFree(queue);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < slots; i++)
+    {
+        queue->cells[i].sequence = i;
+    }
+    queue->mask = slots - 1;
+
+    return queue;
+}
+
+void u_mpsc_queue_delete(u_mpsc_queue_t *queue)
+{
+    if (NULL == queue)
+    {
+        return;
+    }
+
+    EdgeFree(queue->cells);
+    EdgeFree(queue);
+}
+
+bool u_mpsc_queue_push(u_mpsc_queue_t *queue, void *msg, uint32_t size)
+{
+    if (NULL == queue)
+    {
+        return false;
+    }
+
+    u_mpsc_cell_t *cell;
+    size_t pos = __atomic_load_n(&queue->enqueuePos, __ATOMIC_RELAXED);
+    while (true)
+    {
+        cell = &queue->cells[pos & queue->mask];
+        size_t seq = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+        intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+        if (0 == diff)
+        {
+            // slot is free, try to reserve it. pos is reloaded on failure.
+            if (__atomic_compare_exchange_n(&queue->enqueuePos, &pos, pos + 1, true,
+                    __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // consumer has not released this slot yet.
+            return false;
+        }
+        else
+        {
+            // another producer took this slot.
+            pos = __atomic_load_n(&queue->enqueuePos, __ATOMIC_RELAXED);
+        }
+    }
+
+    cell->msg = msg;
+    cell->size = size;
+    __atomic_store_n(&cell->sequence, pos + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool u_mpsc_queue_pop(u_mpsc_queue_t *queue, void **msg, uint32_t *size)
+{
+    if (NULL == queue || NULL == msg)
+    {
+        return false;
+    }
+
+    size_t pos = __atomic_load_n(&queue->dequeuePos, __ATOMIC_RELAXED);
+    u_mpsc_cell_t *cell = &queue->cells[pos & queue->mask];
+    size_t seq = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+    if ((intptr_t) seq - (intptr_t) (pos + 1) < 0)
+    {
+        // empty, or the producer owning this slot has not published yet.
+        return false;
+    }
+
+    *msg = cell->msg;
+    if (size)
+    {
+        *size = cell->size;
+    }
+
+    __atomic_store_n(&queue->dequeuePos, pos + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&cell->sequence, pos + queue->mask + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+uint32_t u_mpsc_queue_get_size(u_mpsc_queue_t *queue)
+{
+    if (NULL == queue)
+    {
+        return 0;
+    }
+
+    size_t head = __atomic_load_n(&queue->dequeuePos, __ATOMIC_RELAXED);
+    size_t tail = __atomic_load_n(&queue->enqueuePos, __ATOMIC_RELAXED);
+    return (tail > head) ? (uint32_t) (tail - head) : 0;
+}
+
+uint32_t u_mpsc_queue_get_capacity(u_mpsc_queue_t *queue)
+{
+    return queue ? (uint32_t) (queue->mask + 1) : 0;
+}
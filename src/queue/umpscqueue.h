@@ -0,0 +1,92 @@
+/* ****************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file
+ *
+ * This file contains the APIs for a bounded multi-producer/single-consumer
+ * ring buffer.  Any number of threads may push concurrently without locking;
+ * only one thread at a time may pop.  Slots are preallocated, so neither push
+ * nor pop allocates memory.
+ */
+
+#ifndef U_MPSC_QUEUE_H_
+#define U_MPSC_QUEUE_H_
+
+#include "cacommon.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/**
+ * Opaque ring buffer type.
+ */
+typedef struct u_mpsc_queue_t u_mpsc_queue_t;
+
+/**
+ * API to create the ring buffer.
+ * @param capacity Number of slots. Rounded up to the next power of two.
+ * @return  u_mpsc_queue_t pointer if Success, NULL otherwise.
+ */
+u_mpsc_queue_t *u_mpsc_queue_create(uint32_t capacity);
+
+/**
+ * Deletes the ring buffer.  Messages still queued are not freed.
+ * @param queue queue pointer.
+ */
+void u_mpsc_queue_delete(u_mpsc_queue_t *queue);
+
+/**
+ * Adds message at the end of the queue.  Safe to call from any thread.
+ * @param queue pointer to queue.
+ * @param msg Pointer to message.
+ * @param size message size.
+ * @return true if the message was queued, false if the queue is full.
+ */
+bool u_mpsc_queue_push(u_mpsc_queue_t *queue, void *msg, uint32_t size);
+
+/**
+ * Removes the first message in the queue.  Must only be called by the consumer.
+ * @param queue pointer to queue.
+ * @param msg Location that receives the message.
+ * @param size Location that receives the message size. May be NULL.
+ * @return true if a message was removed, false if the queue is empty.
+ */
+bool u_mpsc_queue_pop(u_mpsc_queue_t *queue, void **msg, uint32_t *size);
+
+/**
+ * @param queue pointer to queue.
+ * @return approximate number of elements in queue.
+ */
+uint32_t u_mpsc_queue_get_size(u_mpsc_queue_t *queue);
+
+/**
+ * @param queue pointer to queue.
+ * @return number of slots in queue.
+ */
+uint32_t u_mpsc_queue_get_capacity(u_mpsc_queue_t *queue);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* U_MPSC_QUEUE_H_ */
@@ -30,100 +30,275 @@
 #include "edge_open62541.h"
 #include "edge_list.h"
 #include "edge_map.h"
+#include "edge_intern.h"
 #include "edge_malloc.h"
+#include "edge_random.h"
 
 #include <stdio.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
 #include <open62541.h>
 #include <inttypes.h>
 
 #define TAG "session_client"
 
-#define MAX_ADDRESS_SIZE (512)
+/* Endpoints connected at the same time by connect_clients. */
+#define MAX_CONNECT_WORKERS (16)
+
+/* Session supervision, see sessionSupervisor. */
+#define SUPERVISOR_INTERVAL_MS (1000)
+#define KEEPALIVE_INTERVAL_MS (5000)
+#define RECONNECT_MIN_DELAY_MS (500)
+#define RECONNECT_MAX_DELAY_MS (30000)
+
+/* Client of a connected endpoint. */
+typedef struct sessionClient
+{
+    UA_Client *client;
+    /* Serializes the service calls on client; see lockSession. */
+    pthread_mutex_t lock;
+    /* References held by the session map and by lockSession callers. Updated atomically,
+     * new references are only taken while the session is found under sessionMapLock. */
+    size_t refCount;
+    /* Shared endpoint info of the session, referenced by the requests and their responses. */
+    EdgeEndPointInfo *endpointInfo;
+    /* Id of the session, see EdgeEndPointInfo.sessionId. */
+    uint32_t id;
+    /* Interned session key of the endpoint, owned by the session map. */
+    const char *key;
+    /* Further sessions of the endpoint, owned by the first one. Guarded by sessionMapLock. */
+    struct sessionClient *nextInPool;
+    /* Set atomically while a reconnect task runs for the session. */
+    bool reconnecting;
+    /* Connection state, used by the supervisor thread, or by the reconnect task while
+     * reconnecting is set. */
+    bool lost;
+    uint32_t reconnectAttempts;
+    /* Monotonic time of the next keep alive check or reconnect attempt in ms. */
+    uint64_t nextCheckMs;
+} sessionClient;
 
 static edgeMap *sessionClientMap = NULL;
+/* Sessions keyed by id. Ids are not reused, so a stale id finds no session. */
+static edgeMap *sessionIdMap = NULL;
+static uint32_t lastSessionId = 0;
 static size_t clientCount = 0;
+/* Number of sessions opened to each endpoint, see configureSessionPool. */
+static size_t sessionsPerEndpoint = 1;
+/* Guards sessionClientMap, sessionIdMap and clientCount. Requests only read the maps, so they
+ * run in parallel and only wait for connects and disconnects. */
+static pthread_rwlock_t sessionMapLock = PTHREAD_RWLOCK_INITIALIZER;
 static uint8_t supportedApplicationTypes;
 
 static status_cb_t g_statusCallback = NULL;
+
+/* The supervisor thread runs while clients are connected. */
+static pthread_mutex_t supervisorMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t supervisorCond = PTHREAD_COND_INITIALIZER;
+static bool supervisorRunning = false;
+static bool connectionCheckRequested = false;
 static discovery_cb_t g_discoveryCallback = NULL;
 
-static void getAddressPort(char *endpoint, char **out)
+/* Cached result of a GetEndpoints or FindServers request, see lookupDiscovery. */
+typedef struct discoveryEntry
 {
-    UA_String hostName = UA_STRING_NULL, path = UA_STRING_NULL;
-    UA_UInt16 port = 0;
-    UA_String endpointUrlString = UA_STRING((char *) (uintptr_t) endpoint);
+    /* Key of the entry, see getDiscoveryKey. */
+    char *key;
+    /* Endpoint the request was sent to. */
+    char *endpointUri;
+    /* References held by the cache and by the lookups using the entry. Guarded by discoveryMutex. */
+    size_t refCount;
+    /* true while the first lookup sends the request, the others wait for its result. */
+    bool loading;
+    EdgeResult result;
+    /* Monotonic time in ms after which the result is requested again. */
+    uint64_t expiresMs;
+    /* GetEndpoints result, its endpoint infos are shared. NULL if nothing is reported. */
+    EdgeDevice *device;
+    /* FindServers result. */
+    size_t serversSize;
+    EdgeApplicationConfig *servers;
+} discoveryEntry;
+
+/* Discovery results keyed by request, see configureDiscoveryCache. */
+static edgeMap *discoveryCache = NULL;
+static uint32_t discoveryCacheTtlMs = 0;
+static pthread_mutex_t discoveryMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t discoveryCond = PTHREAD_COND_INITIALIZER;
+
+static keyValue sessionIdKey(uint32_t id)
+{
+    return (keyValue) (uintptr_t) id;
+}
 
-    UA_StatusCode parse_retval = UA_parseEndpointUrl(&endpointUrlString, &hostName, &port, &path);
-    if (parse_retval != UA_STATUSCODE_GOOD)
+/* Interned session key of the endpoint, NULL if it is not known. */
+static const char *findSessionKey(const char *endpoint)
+{
+    const char *key = getCachedSessionKey(endpoint);
+    if (key)
     {
-        EDGE_LOG(TAG, "Server URL is invalid. Unable to get endpoints\n");
-        return;
+        return key;
     }
 
-    char address[MAX_ADDRESS_SIZE];
-    strncpy(address, (char*) hostName.data, hostName.length);
-    address[hostName.length] = '\0';
+    /* Endpoint not cached */
+    char *ep = getSessionKey(endpoint);
+    VERIFY_NON_NULL_MSG(ep, "NULL EP received in findSessionKey \n", NULL);
+    key = EdgeInternFind(ep, strlen(ep));
+    EdgeFree(ep);
+    return key;
+}
+
+/* Should be called with sessionMapLock held. */
+static sessionClient *findSession(const char *endpoint, uint32_t sessionId)
+{
+    const char *key = findSessionKey(endpoint);
+    if (sessionId)
+    {
+        sessionClient *session = (sessionClient *) getMapElement(sessionIdMap, sessionIdKey(sessionId));
+        /* An endpoint info reused for another endpoint keeps a stale id */
+        if (session && session->key == key)
+        {
+            return session;
+        }
+    }
 
-    char addr_port[MAX_ADDRESS_SIZE];
-    memset(addr_port, '\0', MAX_ADDRESS_SIZE);
-    int written = snprintf(addr_port, MAX_ADDRESS_SIZE, "%s:%d", address, port);
-    if (written > 0)
+    if (IS_NULL(sessionClientMap) || IS_NULL(key))
     {
-        *out = (char*) EdgeMalloc(sizeof(char) * (written + 1));
-        strncpy(*out, addr_port, written);
-        (*out)[written] = '\0';
+        return NULL;
     }
+    return (sessionClient *) getMapElement(sessionClientMap, (keyValue) key);
 }
 
-static keyValue getSessionClient(char *endpoint)
+static bool isSessionConnected(const char *endpoint)
 {
-    VERIFY_NON_NULL_MSG(sessionClientMap, "sessionClientMap is NULL\n", NULL);
+    pthread_rwlock_rdlock(&sessionMapLock);
+    bool connected = (NULL != findSession(endpoint, 0));
+    pthread_rwlock_unlock(&sessionMapLock);
+    return connected;
+}
 
-    char *ep = NULL;
-    getAddressPort(endpoint, &ep);
-    VERIFY_NON_NULL_MSG(ep, "NULL EP received in getSessionClient \n", NULL);
+static void releaseSession(sessionClient *session)
+{
+    if (0 == __atomic_sub_fetch(&session->refCount, 1, __ATOMIC_ACQ_REL))
+    {
+        pthread_mutex_destroy(&session->lock);
+        freeEdgeEndpointInfo(session->endpointInfo);
+        EdgeFree(session);
+    }
+}
 
-    keyValue value = NULL;
-    for(edgeMapNode *temp = sessionClientMap->head; temp != NULL; temp = temp->next)
+/* Should be called with sessionMapLock held. */
+static sessionClient *findLeastLoadedSession(sessionClient *session)
+{
+    /* Each session holds one reference for the pool, the others are calls using or waiting for it */
+    sessionClient *leastLoaded = session;
+    for (sessionClient *next = session->nextInPool; next; next = next->nextInPool)
     {
-        if (!strcmp(temp->key, ep))
+        if (__atomic_load_n(&next->refCount, __ATOMIC_RELAXED)
+                < __atomic_load_n(&leastLoaded->refCount, __ATOMIC_RELAXED))
         {
-            value = temp->value;
-            break;
+            leastLoaded = next;
         }
     }
-    EdgeFree(ep);
-    return value;
+    return leastLoaded;
 }
 
-static edgeMapNode *removeClientFromSessionMap(char *endpoint)
+/**
+ * Gets the session of the endpoint and locks it for a service call.
+ * With pooled set, the least loaded session of the endpoint is taken, otherwise the first one.
+ * timeoutMs <= 0 waits without limit. On timeout *timedOut is set and NULL is returned.
+ * The session must be given back with unlockSession.
+ */
+static sessionClient *lockSession(EdgeEndPointInfo *endpointInfo, bool pooled, int timeoutMs,
+        bool *timedOut)
 {
-    VERIFY_NON_NULL_MSG(sessionClientMap, "sessionClientMap is NULL\n", NULL);
-    char *ep = NULL;
-    getAddressPort(endpoint, &ep);
-    VERIFY_NON_NULL_MSG(ep, "NULL EP received in removeClientFromSessionMap\n", NULL);
+    char *endpoint = endpointInfo->endpointUri;
+    pthread_rwlock_rdlock(&sessionMapLock);
+    sessionClient *session = findSession(endpoint, endpointInfo->sessionId);
+    if (session)
+    {
+        if (pooled)
+        {
+            session = findLeastLoadedSession(session);
+        }
+        __atomic_add_fetch(&session->refCount, 1, __ATOMIC_RELAXED);
+    }
+    pthread_rwlock_unlock(&sessionMapLock);
+    VERIFY_NON_NULL_MSG(session, "Session not found in lockSession\n", NULL);
 
-    edgeMapNode *prev = NULL;
-    edgeMapNode *temp = sessionClientMap->head;
-    while (temp != NULL)
+    int ret = 0;
+    if (timeoutMs > 0)
     {
-        if (!strcmp(temp->key, ep))
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += timeoutMs / 1000;
+        deadline.tv_nsec += (long) (timeoutMs % 1000) * 1000000;
+        if (deadline.tv_nsec >= 1000000000)
         {
-            if (prev == NULL)
-            {
-                sessionClientMap->head = temp->next;
-            }
-            else
-            {
-                prev->next = temp->next;
-            }
-            break;
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
         }
-        prev = temp;
-        temp = temp->next;
+        ret = pthread_mutex_timedlock(&session->lock, &deadline);
+    }
+    else
+    {
+        ret = pthread_mutex_lock(&session->lock);
+    }
+
+    if (0 != ret)
+    {
+        EDGE_LOG_V(TAG, "Unable to lock session of %s :: %d\n", endpoint, ret);
+        if (timedOut)
+        {
+            *timedOut = (ETIMEDOUT == ret);
+        }
+        releaseSession(session);
+        return NULL;
+    }
+    return session;
+}
+
+static void unlockSession(sessionClient *session)
+{
+    if (session)
+    {
+        pthread_mutex_unlock(&session->lock);
+        releaseSession(session);
     }
-    EdgeFree(ep);
-    return temp;
+}
+
+/* Client of a locked session, NULL if it was disconnected meanwhile. */
+static UA_Client *getLockedClient(sessionClient *session)
+{
+    return session ? session->client : NULL;
+}
+
+/* Replaces the endpoint info of a queued request by the shared one of its session,
+ * so its responses reference the session endpoint info instead of copying it. */
+static void useSessionEndpoint(sessionClient *session, EdgeMessage *msg)
+{
+    if (IS_NULL(session) || msg->endpointInfo == session->endpointInfo)
+    {
+        return;
+    }
+    EdgeEndPointInfo *shared = shareEdgeEndpointInfo(session->endpointInfo);
+    if (shared)
+    {
+        EdgeArena *previous = EdgeArenaEnter(msg->arena);
+        freeEdgeEndpointInfo(msg->endpointInfo);
+        EdgeArenaLeave(previous);
+        msg->endpointInfo = shared;
+    }
+}
+
+/* Should be called with sessionMapLock held. */
+static edgeMapNode *removeClientFromSessionMap(char *endpoint)
+{
+    VERIFY_NON_NULL_MSG(sessionClientMap, "sessionClientMap is NULL\n", NULL);
+    const char *key = findSessionKey(endpoint);
+    VERIFY_NON_NULL_MSG(key, "Session key not found in removeClientFromSessionMap\n", NULL);
+    return removeMapElement(sessionClientMap, (keyValue) key);
 }
 
 void setSupportedApplicationTypes(uint8_t supportedTypes)
@@ -131,49 +306,124 @@ void setSupportedApplicationTypes(uint8_t supportedTypes)
     supportedApplicationTypes = supportedTypes;
 }
 
+void configureSessionPool(size_t sessions)
+{
+    sessionsPerEndpoint = (sessions > 1) ? sessions : 1;
+}
+
 EdgeResult readNodesFromServer(EdgeMessage *msg)
 {
-    return executeRead((UA_Client*) getSessionClient(msg->endpointInfo->endpointUri), msg);
+    sessionClient *session = lockSession(msg->endpointInfo, true, 0, NULL);
+    useSessionEndpoint(session, msg);
+    EdgeResult result = executeRead(getLockedClient(session), msg);
+    unlockSession(session);
+    return result;
+}
+
+EdgeResult readNodesFromServerBatch(EdgeMessage **msgs, size_t count)
+{
+    sessionClient *session = lockSession(msgs[0]->endpointInfo, true, 0, NULL);
+    for (size_t i = 0; i < count; i++)
+    {
+        useSessionEndpoint(session, msgs[i]);
+    }
+    EdgeResult result = executeReadBatch(getLockedClient(session), (const EdgeMessage **) msgs,
+            count);
+    unlockSession(session);
+    return result;
 }
 
 EdgeResult writeNodesInServer(EdgeMessage *msg)
 {
-    return executeWrite((UA_Client*) getSessionClient(msg->endpointInfo->endpointUri), msg);
+    sessionClient *session = lockSession(msg->endpointInfo, true, 0, NULL);
+    useSessionEndpoint(session, msg);
+    EdgeResult result = executeWrite(getLockedClient(session), msg);
+    unlockSession(session);
+    return result;
 }
 
 void browseNodesInServer(EdgeMessage *msg)
 {
-    executeBrowse((UA_Client*) getSessionClient(msg->endpointInfo->endpointUri), msg);
+    sessionClient *session = lockSession(msg->endpointInfo, false, 0, NULL);
+    useSessionEndpoint(session, msg);
+    executeBrowse(getLockedClient(session), msg);
+    unlockSession(session);
 }
 
 EdgeResult callMethodInServer(EdgeMessage *msg)
 {
-    return executeMethod((UA_Client*) getSessionClient(msg->endpointInfo->endpointUri), msg);
+    sessionClient *session = lockSession(msg->endpointInfo, true, 0, NULL);
+    useSessionEndpoint(session, msg);
+    EdgeResult result = executeMethod(getLockedClient(session), msg);
+    unlockSession(session);
+    return result;
 }
 
 EdgeResult executeSubscriptionInServer(EdgeMessage *msg)
 {
-    return executeSub((UA_Client*) getSessionClient(msg->endpointInfo->endpointUri), msg);
+    sessionClient *session = lockSession(msg->endpointInfo, false, 0, NULL);
+    useSessionEndpoint(session, msg);
+    EdgeResult result = executeSub(getLockedClient(session), session ? &session->lock : NULL, msg);
+    unlockSession(session);
+    return result;
 }
 
-bool connect_client(char *endpoint)
+EdgeResult executeRequestSync(EdgeMessage *msg, EdgeMessage **response, int timeoutMs)
 {
-    UA_StatusCode retVal;
-    UA_ClientConfig config = UA_ClientConfig_default;
-    UA_Client *m_client = NULL;
-    char *m_endpoint = NULL;
+    EdgeResult result;
+    result.code = STATUS_PARAM_INVALID;
+    VERIFY_NON_NULL_MSG(response, "NULL response param in executeRequestSync\n", result);
+    *response = NULL;
 
-    EDGE_LOG_V(TAG, "endpoint :: %s\n", endpoint);
-    if (NULL != getSessionClient(endpoint))
+    bool timedOut = false;
+    sessionClient *session = lockSession(msg->endpointInfo, true, timeoutMs, &timedOut);
+    if (NULL == session)
     {
-        EDGE_LOG(TAG, "client already connected.\n");
-        return false;
+        result.code = timedOut ? STATUS_TIMEOUT : STATUS_ERROR;
+        return result;
+    }
+
+    /* The response the command would queue for the application is handed back instead */
+    captureResponse(response);
+    switch (msg->command)
+    {
+        case CMD_READ:
+        case CMD_READ_SAMPLING_INTERVAL:
+            result = executeRead(getLockedClient(session), msg);
+            break;
+        case CMD_WRITE:
+            result = executeWrite(getLockedClient(session), msg);
+            break;
+        case CMD_METHOD:
+            result = executeMethod(getLockedClient(session), msg);
+            break;
+        default:
+            result.code = STATUS_NOT_SUPPORT;
+            break;
     }
+    captureResponse(NULL);
+    unlockSession(session);
 
-    m_client = UA_Client_new(config);
-    VERIFY_NON_NULL_MSG(m_client, "NULL CLIENT received in connect_client\n", false);
+    if (STATUS_OK == result.code && NULL == *response)
+    {
+        result.code = STATUS_ERROR;
+    }
+    return result;
+}
 
-    retVal = UA_Client_connect(m_client, endpoint);
+/* Connects a new client to the endpoint, NULL on failure.
+ * timeoutMs > 0 bounds every step of the connect, otherwise the default client timeout applies. */
+static UA_Client *connectNewClient(const char *endpoint, int timeoutMs)
+{
+    UA_ClientConfig config = UA_ClientConfig_default;
+    if (timeoutMs > 0)
+    {
+        config.timeout = (UA_UInt32) timeoutMs;
+    }
+    UA_Client *m_client = UA_Client_new(config);
+    VERIFY_NON_NULL_MSG(m_client, "NULL CLIENT received in connectNewClient\n", NULL);
+
+    UA_StatusCode retVal = UA_Client_connect(m_client, endpoint);
     /* Connect with User name and Password */
     //retVal = UA_Client_connect_username(m_client, endpoint, "user2", "password1");
     //retVal = UA_Client_connect_username(m_client, endpoint, "user1", "password");
@@ -181,59 +431,571 @@ bool connect_client(char *endpoint)
     {
         EDGE_LOG_V(TAG, "\n [CLIENT] Unable to connect 0x%08x!\n", retVal);
         UA_Client_delete(m_client);
+        return NULL;
+    }
+    if (timeoutMs > 0)
+    {
+        /* The timeout only bounds the connect, service calls use the default one */
+        UA_Client_getConfig(m_client)->timeout = UA_ClientConfig_default.timeout;
+    }
+    return m_client;
+}
+
+/* Session of a connected client, sharing the endpoint info. NULL on failure. */
+static sessionClient *createSession(UA_Client *client, EdgeEndPointInfo *epInfo)
+{
+    sessionClient *session = (sessionClient *) EdgeCalloc(1, sizeof(sessionClient));
+    VERIFY_NON_NULL_MSG(session, "EdgeCalloc FAILED for session in createSession\n", NULL);
+    session->endpointInfo = shareEdgeEndpointInfo(epInfo);
+    if (IS_NULL(session->endpointInfo))
+    {
+        EDGE_LOG(TAG, "Memory allocation failed for endpointInfo in createSession\n");
+        EdgeFree(session);
+        return NULL;
+    }
+    session->client = client;
+    session->refCount = 1;
+    pthread_mutex_init(&session->lock, NULL);
+    return session;
+}
+
+/* Deletes the client of a session removed from the session map and gives back its reference. */
+static void closeSession(sessionClient *session)
+{
+    /* Wait for the running service call, later ones find no client */
+    pthread_mutex_lock(&session->lock);
+    if (session->client)
+    {
+        deleteSubscriptions(session->client);
+    }
+    UA_Client_delete(session->client);
+    session->client = NULL;
+    pthread_mutex_unlock(&session->lock);
+    releaseSession(session);
+}
+
+/* Closes a session which was not added to the session map, with the further sessions of its pool. */
+static void closeSessionPool(sessionClient *session)
+{
+    while (session)
+    {
+        sessionClient *next = session->nextInPool;
+        closeSession(session);
+        session = next;
+    }
+}
+
+static uint64_t getMonotonicMs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000 + (uint64_t) now.tv_nsec / 1000000;
+}
+
+/* Exponential backoff of the reconnect attempts. The jitter spreads the reconnects of
+ * endpoints lost at the same time, e.g. when the network comes back. */
+static uint64_t getReconnectDelayMs(uint32_t attempts)
+{
+    uint64_t delay = RECONNECT_MAX_DELAY_MS;
+    if (attempts < 16)
+    {
+        delay = (uint64_t) RECONNECT_MIN_DELAY_MS << attempts;
+        delay = (delay < RECONNECT_MAX_DELAY_MS) ? delay : RECONNECT_MAX_DELAY_MS;
+    }
+    return delay / 2 + EdgeGetRandom() % (delay / 2 + 1);
+}
+
+/* Reads the server state, a cheap service call which needs a working session. */
+static UA_StatusCode checkConnection(UA_Client *client)
+{
+    UA_Variant value;
+    UA_Variant_init(&value);
+    UA_StatusCode status = UA_Client_readValueAttribute(client,
+            UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_STATE), &value);
+    UA_Variant_deleteMembers(&value);
+    return status;
+}
+
+/* Session held by the supervisor for one round. */
+typedef struct supervisedSession
+{
+    sessionClient *session;
+    /* First session of the endpoint, which reports the connection state */
+    bool primary;
+} supervisedSession;
+
+/* Connects a lost session again. Runs on its own thread, so that a hung server only
+ * delays its own session. Takes over the reference and the copy of the supervised session. */
+static void *reconnectSession(void *ptr)
+{
+    supervisedSession *supervised = (supervisedSession *) ptr;
+    sessionClient *session = supervised->session;
+    UA_StatusCode status = UA_STATUSCODE_GOOD;
+    bool closed = false;
+
+    /* The same client is connected again, so the subscriptions keep their client */
+    pthread_mutex_lock(&session->lock);
+    if (session->client)
+    {
+        UA_Client_disconnect(session->client);
+        status = UA_Client_connect(session->client, session->endpointInfo->endpointUri);
+        if (UA_STATUSCODE_GOOD == status)
+        {
+            status = recreateSubscriptions(session->client);
+        }
+    }
+    else
+    {
+        closed = true;
+    }
+    pthread_mutex_unlock(&session->lock);
+
+    if (closed)
+    {
+        /* Closed after the supervisor took it, nothing to report */
+    }
+    else if (UA_STATUSCODE_GOOD != status)
+    {
+        session->reconnectAttempts++;
+        session->nextCheckMs = getMonotonicMs() + getReconnectDelayMs(session->reconnectAttempts);
+        EDGE_LOG_V(TAG, "Reconnect %u to %s failed :: %s\n", session->reconnectAttempts,
+                session->endpointInfo->endpointUri, UA_StatusCode_name(status));
+    }
+    else
+    {
+        EDGE_LOG_V(TAG, "Session of %s connected again\n", session->endpointInfo->endpointUri);
+        session->lost = false;
+        session->nextCheckMs = getMonotonicMs() + KEEPALIVE_INTERVAL_MS;
+        if (supervised->primary)
+        {
+            g_statusCallback(session->endpointInfo, STATUS_CONNECTED);
+        }
+    }
+
+    __atomic_store_n(&session->reconnecting, false, __ATOMIC_RELEASE);
+    releaseSession(session);
+    EdgeFree(supervised);
+    return NULL;
+}
+
+/* Checks an idle session is still connected, or starts a reconnect task for a lost one
+ * when its backoff delay has passed. */
+static void superviseSession(supervisedSession *supervised, bool checkNow)
+{
+    sessionClient *session = supervised->session;
+    uint64_t now = getMonotonicMs();
+    UA_StatusCode status = UA_STATUSCODE_GOOD;
+
+    if (__atomic_load_n(&session->reconnecting, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+
+    if (!session->lost)
+    {
+        /* A busy session is in use, it is checked later */
+        if ((!checkNow && now < session->nextCheckMs) || 0 != pthread_mutex_trylock(&session->lock))
+        {
+            return;
+        }
+        if (session->client)
+        {
+            status = checkConnection(session->client);
+        }
+        pthread_mutex_unlock(&session->lock);
+
+        session->nextCheckMs = now + KEEPALIVE_INTERVAL_MS;
+        if (isConnectionLost(status))
+        {
+            EDGE_LOG_V(TAG, "Session of %s lost :: %s\n", session->endpointInfo->endpointUri,
+                    UA_StatusCode_name(status));
+            session->lost = true;
+            session->reconnectAttempts = 0;
+            session->nextCheckMs = now + getReconnectDelayMs(0);
+            if (supervised->primary)
+            {
+                g_statusCallback(session->endpointInfo, STATUS_DISCONNECTED);
+            }
+        }
+        return;
+    }
+
+    if (now < session->nextCheckMs)
+    {
+        return;
+    }
+
+    supervisedSession *task = (supervisedSession *) EdgeMalloc(sizeof(supervisedSession));
+    VERIFY_NON_NULL_NR_MSG(task, "EdgeMalloc FAILED for task in superviseSession\n");
+    *task = *supervised;
+    __atomic_add_fetch(&session->refCount, 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&session->reconnecting, true, __ATOMIC_RELAXED);
+
+    pthread_t thread;
+    if (0 == pthread_create(&thread, NULL, reconnectSession, task))
+    {
+        pthread_detach(thread);
+    }
+    else
+    {
+        /* Without a thread the session is connected again on the supervisor */
+        EDGE_LOG(TAG, "Unable to start reconnect task, reconnecting on the supervisor\n");
+        reconnectSession(task);
+    }
+}
+
+/* Takes a reference to every session. Should be called with sessionMapLock held. */
+static supervisedSession *getSupervisedSessions(size_t *count)
+{
+    *count = 0;
+    for (edgeMapNode *node = sessionClientMap ? sessionClientMap->head : NULL; node; node = node->next)
+    {
+        for (sessionClient *session = (sessionClient *) node->value; session; session = session->nextInPool)
+        {
+            (*count)++;
+        }
+    }
+    if (0 == *count)
+    {
+        return NULL;
+    }
+
+    supervisedSession *sessions = (supervisedSession *) EdgeMalloc(sizeof(supervisedSession) * *count);
+    VERIFY_NON_NULL_MSG(sessions, "EdgeMalloc FAILED for sessions in getSupervisedSessions\n", NULL);
+    size_t index = 0;
+    for (edgeMapNode *node = sessionClientMap->head; node; node = node->next)
+    {
+        for (sessionClient *session = (sessionClient *) node->value; session; session = session->nextInPool)
+        {
+            __atomic_add_fetch(&session->refCount, 1, __ATOMIC_RELAXED);
+            sessions[index].session = session;
+            sessions[index].primary = (session == node->value);
+            index++;
+        }
+    }
+    return sessions;
+}
+
+/* Keeps the sessions connected. Idle sessions are checked every KEEPALIVE_INTERVAL_MS, or at
+ * once when a publish request found the connection lost. A lost session is connected again
+ * by a task of its own, with jittered exponential backoff. The thread ends with the last client. */
+static void *sessionSupervisor(void *ptr)
+{
+    (void) ptr;
+    while (true)
+    {
+        pthread_mutex_lock(&supervisorMutex);
+        if (!connectionCheckRequested)
+        {
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_sec += SUPERVISOR_INTERVAL_MS / 1000;
+            deadline.tv_nsec += (long) (SUPERVISOR_INTERVAL_MS % 1000) * 1000000;
+            if (deadline.tv_nsec >= 1000000000)
+            {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000;
+            }
+            pthread_cond_timedwait(&supervisorCond, &supervisorMutex, &deadline);
+        }
+        bool checkNow = connectionCheckRequested;
+        connectionCheckRequested = false;
+
+        size_t count = 0;
+        pthread_rwlock_rdlock(&sessionMapLock);
+        bool lastClientGone = (0 == clientCount);
+        supervisedSession *sessions = lastClientGone ? NULL : getSupervisedSessions(&count);
+        pthread_rwlock_unlock(&sessionMapLock);
+        if (lastClientGone)
+        {
+            /* Decided under supervisorMutex, so a new client starts a new supervisor */
+            supervisorRunning = false;
+            pthread_mutex_unlock(&supervisorMutex);
+            break;
+        }
+        pthread_mutex_unlock(&supervisorMutex);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            superviseSession(&sessions[i], checkNow);
+            releaseSession(sessions[i].session);
+        }
+        EdgeFree(sessions);
+    }
+
+    EDGE_LOG(TAG, "session supervisor ended");
+    return NULL;
+}
+
+static void wakeSupervisor()
+{
+    pthread_mutex_lock(&supervisorMutex);
+    pthread_cond_signal(&supervisorCond);
+    pthread_mutex_unlock(&supervisorMutex);
+}
+
+static void startSupervisor()
+{
+    pthread_mutex_lock(&supervisorMutex);
+    if (!supervisorRunning)
+    {
+        pthread_t thread;
+        if (0 == pthread_create(&thread, NULL, sessionSupervisor, NULL))
+        {
+            pthread_detach(thread);
+            supervisorRunning = true;
+        }
+        else
+        {
+            EDGE_LOG(TAG, "Unable to start the session supervisor, lost sessions stay lost\n");
+        }
+    }
+    pthread_mutex_unlock(&supervisorMutex);
+}
+
+void requestConnectionCheck()
+{
+    pthread_mutex_lock(&supervisorMutex);
+    connectionCheckRequested = true;
+    pthread_cond_signal(&supervisorCond);
+    pthread_mutex_unlock(&supervisorMutex);
+}
+
+static bool connectClient(EdgeEndPointInfo *epInfo, int timeoutMs)
+{
+    char *endpoint = epInfo->endpointUri;
+    UA_Client *m_client = NULL;
+    const char *m_endpoint = NULL;
+
+    EDGE_LOG_V(TAG, "endpoint :: %s\n", endpoint);
+    if (isSessionConnected(endpoint))
+    {
+        EDGE_LOG(TAG, "client already connected.\n");
+        return false;
+    }
+
+    m_client = connectNewClient(endpoint, timeoutMs);
+    if (IS_NULL(m_client))
+    {
         return false;
     }
 
     EDGE_LOG(TAG, "\n [CLIENT] Client connection successful \n");
-    getAddressPort(endpoint, &m_endpoint);
+    char *sessionKey = getSessionKey(endpoint);
+    m_endpoint = sessionKey ? EdgeInternString(sessionKey) : NULL;
+    EdgeFree(sessionKey);
+    sessionClient *session = createSession(m_client, epInfo);
+    if (IS_NULL(m_endpoint) || IS_NULL(session))
+    {
+        EDGE_LOG(TAG, "Memory allocation failed.");
+        if (m_endpoint)
+        {
+            EdgeInternRelease(m_endpoint);
+        }
+        if (session)
+        {
+            releaseSession(session);
+        }
+        UA_Client_delete(m_client);
+        return false;
+    }
+    EdgeEndPointInfo *sharedInfo = session->endpointInfo;
+
+    /* Further sessions of the pool share the endpoint info of the first one */
+    for (size_t i = 1; i < sessionsPerEndpoint; i++)
+    {
+        UA_Client *poolClient = connectNewClient(endpoint, timeoutMs);
+        sessionClient *poolSession = poolClient ? createSession(poolClient, sharedInfo) : NULL;
+        if (IS_NULL(poolSession))
+        {
+            EDGE_LOG_V(TAG, "Unable to open session %zu of the endpoint, continuing with %zu\n",
+                    i + 1, i);
+            if (poolClient)
+            {
+                UA_Client_delete(poolClient);
+            }
+            break;
+        }
+        poolSession->nextInPool = session->nextInPool;
+        session->nextInPool = poolSession;
+    }
 
     // Add the client to session map
+    pthread_rwlock_wrlock(&sessionMapLock);
     if (NULL == sessionClientMap)
     {
         sessionClientMap = createMap();
     }
-    insertMapElement(sessionClientMap, (keyValue) m_endpoint, (keyValue) m_client);
+    if (NULL == sessionIdMap)
+    {
+        sessionIdMap = createMap();
+    }
+    if (getMapElement(sessionClientMap, (keyValue) m_endpoint))
+    {
+        /* Connected in parallel to this call */
+        pthread_rwlock_unlock(&sessionMapLock);
+        EDGE_LOG(TAG, "client already connected.\n");
+        closeSessionPool(session);
+        EdgeInternRelease(m_endpoint);
+        return false;
+    }
+    if (0 == ++lastSessionId)
+    {
+        lastSessionId++;
+    }
+    session->id = lastSessionId;
+    session->key = m_endpoint;
+    sharedInfo->sessionId = session->id;
+    epInfo->sessionId = session->id;
+    insertMapElement(sessionClientMap, (keyValue) m_endpoint, (keyValue) session);
+    insertMapElement(sessionIdMap, sessionIdKey(session->id), (keyValue) session);
     clientCount++;
+    pthread_rwlock_unlock(&sessionMapLock);
 
-    EdgeEndPointInfo *ep = (EdgeEndPointInfo *) EdgeCalloc(1, sizeof(EdgeEndPointInfo));
-    VERIFY_NON_NULL_MSG(ep, "EdgeCalloc FAILED for EdgeEndPointInfo\n", false);
-    ep->endpointUri = endpoint;
-    g_statusCallback(ep, STATUS_CLIENT_STARTED);
-    EdgeFree(ep);
+    startSupervisor();
+    g_statusCallback(sharedInfo, STATUS_CLIENT_STARTED);
 
     return true;
 }
 
-void disconnect_client(EdgeEndPointInfo *epInfo)
+bool connect_client(EdgeEndPointInfo *epInfo)
+{
+    return connectClient(epInfo, 0);
+}
+
+/* Endpoints of connect_clients, taken in turn by the connect workers. */
+typedef struct connectBatch
+{
+    EdgeEndPointInfo **endpoints;
+    /* true for each connected endpoint */
+    bool *connected;
+    size_t count;
+    /* Next endpoint to be taken, updated atomically. */
+    size_t next;
+    int timeoutMs;
+} connectBatch;
+
+static void *connectWorker(void *ptr)
+{
+    connectBatch *batch = (connectBatch *) ptr;
+    size_t index;
+    while ((index = __atomic_fetch_add(&batch->next, 1, __ATOMIC_RELAXED)) < batch->count)
+    {
+        batch->connected[index] = batch->endpoints[index]
+                && connectClient(batch->endpoints[index], batch->timeoutMs);
+    }
+    return NULL;
+}
+
+size_t connect_clients(EdgeEndPointInfo **endpoints, size_t count, int timeoutMs)
+{
+    VERIFY_NON_NULL_MSG(endpoints, "NULL endpoints param in connect_clients\n", 0);
+    if (0 == count)
+    {
+        return 0;
+    }
+
+    connectBatch batch;
+    batch.endpoints = endpoints;
+    batch.connected = (bool *) EdgeCalloc(count, sizeof(bool));
+    VERIFY_NON_NULL_MSG(batch.connected, "EdgeCalloc FAILED for connected in connect_clients\n", 0);
+    batch.count = count;
+    batch.next = 0;
+    batch.timeoutMs = timeoutMs;
+
+    pthread_t workers[MAX_CONNECT_WORKERS];
+    size_t workerCount = 0;
+    while (workerCount < MAX_CONNECT_WORKERS && workerCount < count)
+    {
+        if (0 != pthread_create(&workers[workerCount], NULL, connectWorker, &batch))
+        {
+            EDGE_LOG_V(TAG, "Unable to start connect worker, continuing with %zu\n", workerCount);
+            break;
+        }
+        workerCount++;
+    }
+    /* Without workers the endpoints are connected one after the other on this thread */
+    if (0 == workerCount)
+    {
+        connectWorker(&batch);
+    }
+    for (size_t i = 0; i < workerCount; i++)
+    {
+        pthread_join(workers[i], NULL);
+    }
+
+    size_t connected = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (batch.connected[i])
+        {
+            connected++;
+        }
+    }
+    EdgeFree(batch.connected);
+    return connected;
+}
+
+bool disconnect_client(EdgeEndPointInfo *epInfo)
 {
     edgeMapNode *session = NULL;
+    sessionClient *pool = NULL;
+    bool lastClient = false;
+
+    pthread_rwlock_wrlock(&sessionMapLock);
     session = removeClientFromSessionMap(epInfo->endpointUri);
+    if (session)
+    {
+        if (session->value)
+        {
+            sessionClient *client = (sessionClient *) session->value;
+            EdgeFree(removeMapElement(sessionIdMap, sessionIdKey(client->id)));
+            /* Later calls do not find the further sessions */
+            pool = client->nextInPool;
+            client->nextInPool = NULL;
+        }
+        clientCount--;
+        if (0 == clientCount)
+        {
+            deleteMap(sessionClientMap);
+            EdgeFree(sessionClientMap);
+            sessionClientMap = NULL;
+            deleteMap(sessionIdMap);
+            EdgeFree(sessionIdMap);
+            sessionIdMap = NULL;
+            lastClient = true;
+        }
+    }
+    pthread_rwlock_unlock(&sessionMapLock);
+
     if (session)
     {
         if (session->key)
         {
-            free(session->key);
+            EdgeInternRelease(session->key);
             session->key = NULL;
         }
         if (session->value)
         {
-            UA_Client *m_client = (UA_Client*) session->value;
-            UA_Client_delete(m_client);
-            m_client = NULL;
+            closeSession((sessionClient *) session->value);
+        }
+        while (pool)
+        {
+            sessionClient *next = pool->nextInPool;
+            closeSession(pool);
+            pool = next;
         }
-        free(session);
+        EdgeFree(session);
         session = NULL;
-        clientCount--;
         g_statusCallback(epInfo, STATUS_STOP_CLIENT);
 
-        if (0 == clientCount)
+        if (lastClient)
         {
-            free(sessionClientMap);
-            sessionClientMap = NULL;
-            /* Delete all the messages in send and receiver queue */
-            delete_queue();
+            /* The supervisor ends with the last client */
+            wakeSupervisor();
         }
     }
+    return lastClient;
 }
 
 static void logEndpointDescription(UA_EndpointDescription *ep)
@@ -248,30 +1010,30 @@ static void logEndpointDescription(UA_EndpointDescription *ep)
     EDGE_LOG_V(TAG, "%s", "\n\n");
     EDGE_LOG(TAG, "----------Endpoint Description--------------");
     EDGE_LOG_V(TAG, "Endpoint URL: %s.\n", (str = convertUAStringToString(&ep->endpointUrl)));
-    free(str);
+    EdgeFree(str);
     EDGE_LOG_V(TAG, "Endpoint security mode: %d.\n", ep->securityMode);
     EDGE_LOG_V(TAG, "Endpoint security policy URI: %s.\n", (str = convertUAStringToString(&ep->securityPolicyUri)));
-    free(str);
+    EdgeFree(str);
     EDGE_LOG_V(TAG, "Endpoint user identity token count: %d\n", (int) ep->userIdentityTokensSize);
     EDGE_LOG_V(TAG, "Endpoint transport profile URI: %s.\n", (str = convertUAStringToString(&ep->transportProfileUri)));
-    free(str);
+    EdgeFree(str);
     EDGE_LOG_V(TAG, "Endpoint security level: %u.\n", ep->securityLevel);
     EDGE_LOG_V(TAG, "Endpoint application URI: %s.\n", (str = convertUAStringToString(&ep->server.applicationUri)));
-    free(str);
+    EdgeFree(str);
     EDGE_LOG_V(TAG, "Endpoint product URI: %s.\n", (str = convertUAStringToString(&ep->server.productUri)));
-    free(str);
+    EdgeFree(str);
     EDGE_LOG_V(TAG, "Endpoint application name: %s.\n", (str = convertUAStringToString(&ep->server.applicationName.text)));
-    free(str);
+    EdgeFree(str);
     EDGE_LOG_V(TAG, "Endpoint application type: %u.\n", ep->server.applicationType);
     EDGE_LOG_V(TAG, "Endpoint gateway server URI: %s.\n", (str = convertUAStringToString(&ep->server.gatewayServerUri)));
-    free(str);
+    EdgeFree(str);
     EDGE_LOG_V(TAG, "Endpoint discovery profile URI: %s.\n", (str = convertUAStringToString(&ep->server.discoveryProfileUri)));
-    free(str);
+    EdgeFree(str);
     EDGE_LOG_V(TAG, "Endpoint discovery URL count: %d\n", (int) ep->server.discoveryUrlsSize);
     for(size_t i = 0; i < ep->server.discoveryUrlsSize; ++i)
     {
         EDGE_LOG_V(TAG, "Endpoint discovery URL(%d): %s.\n", (int) i+1, (str = convertUAStringToString(&ep->server.discoveryUrls[i])));
-        free(str);
+        EdgeFree(str);
     }
 #else
     (void) ep;
@@ -342,11 +1104,14 @@ static EdgeApplicationConfig *convertToEdgeApplicationConfig(UA_ApplicationDescr
 
     appConfig->applicationType = convertToEdgeApplicationType(appDesc->applicationType);
     appConfig->discoveryUrlsSize = appDesc->discoveryUrlsSize;
-    appConfig->discoveryUrls = (char **) calloc(appDesc->discoveryUrlsSize, sizeof(char *));
-    if (!appConfig->discoveryUrls)
+    if (appDesc->discoveryUrlsSize > 0)
     {
-        EDGE_LOG(TAG, "Memory allocation failed for appConfig discoveryUrls.");
-        goto ERROR;
+        appConfig->discoveryUrls = (char **) EdgeCalloc(appDesc->discoveryUrlsSize, sizeof(char *));
+        if (!appConfig->discoveryUrls)
+        {
+            EDGE_LOG(TAG, "Memory allocation failed for appConfig discoveryUrls.");
+            goto ERROR;
+        }
     }
 
     for (int i = 0; i < appDesc->discoveryUrlsSize; ++i)
@@ -847,77 +1612,20 @@ static bool isServerAppDescriptionValid(UA_ApplicationDescription *regServer, si
         if(!isReceivedApplicationNameLocaleValid(&regServer->applicationName.locale, localeIdsSize, localeIds))
         {
             EDGE_LOG(TAG, "Locale of Application Name doesn't match with the requested list of locales.");
-            return false;
-        }
-    }
-
-    return true;
-}
-
-EdgeResult findServersInternal(const char *endpointUri, size_t serverUrisSize,
-    unsigned char **serverUris, size_t localeIdsSize, unsigned char **localeIds,
-    size_t *registeredServersSize, EdgeApplicationConfig **registeredServers)
-{
-    EdgeResult res;
-    if(IS_NULL(endpointUri))
-    {
-        EDGE_LOG(TAG, "endpointUri is NULL.");
-        res.code = STATUS_PARAM_INVALID;
-        return res;
-    }
-
-    if(serverUrisSize > 0 && IS_NULL(serverUris))
-    {
-        EDGE_LOG(TAG, "serverUrisSize is > 0 but serverUris is NULL.");
-        res.code = STATUS_PARAM_INVALID;
-        return res;
-    }
-
-    for(size_t i = 0; i < serverUrisSize; ++i)
-    {
-        if(IS_NULL(serverUris[i]))
-        {
-            EDGE_LOG_V(TAG, "serverUris[%zu] is NULL.", i);
-            res.code = STATUS_PARAM_INVALID;
-            return res;
-        }
-    }
-
-    if(localeIdsSize > 0 && IS_NULL(localeIds))
-    {
-        EDGE_LOG(TAG, "localeIdsSize is > 0 but localeIds is NULL.");
-        res.code = STATUS_PARAM_INVALID;
-        return res;
-    }
-
-    for(size_t i = 0; i < localeIdsSize; ++i)
-    {
-        if(IS_NULL(localeIds[i]))
-        {
-            EDGE_LOG_V(TAG, "localeIds[%zu] is NULL.", i);
-            res.code = STATUS_PARAM_INVALID;
-            return res;
-        }
-    }
-
-    if(IS_NULL(registeredServersSize) || IS_NULL(registeredServers))
-    {
-        EDGE_LOG(TAG, "NULL registeredServersSize/registeredServers.");
-        res.code = STATUS_PARAM_INVALID;
-        return res;
-    }
-
-    UA_String hostName = UA_STRING_NULL, path = UA_STRING_NULL;
-    UA_UInt16 port = 0;
-    UA_String endpointUrlString = UA_STRING((char *) (uintptr_t) endpointUri);
-    UA_StatusCode parse_retval = UA_parseEndpointUrl(&endpointUrlString, &hostName, &port, &path);
-    if (parse_retval != UA_STATUSCODE_GOOD)
-    {
-        EDGE_LOG_V(TAG, "Endpoint URL is invalid. Error Code: %s.", UA_StatusCode_name(parse_retval));
-        res.code = STATUS_PARAM_INVALID;
-        return res;
+            return false;
+        }
     }
 
+    return true;
+}
+
+/* Sends a FindServers request. Parameters are validated by findServersInternal. */
+static EdgeResult requestServers(const char *endpointUri, size_t serverUrisSize,
+    unsigned char **serverUris, size_t localeIdsSize, unsigned char **localeIds,
+    size_t *registeredServersSize, EdgeApplicationConfig **registeredServers)
+{
+    EdgeResult res;
+
     // Convert Server URIs.
     UA_String *serverUrisUA = NULL;
     if(serverUrisSize >0 && !convertUnsignedCharStringsToUAStrings(serverUrisSize, serverUris, &serverUrisUA))
@@ -1075,7 +1783,408 @@ EdgeResult findServersInternal(const char *endpointUri, size_t serverUrisSize,
     return res;
 }
 
-EdgeResult getClientEndpoints(char *endpointUri)
+/* Key of a discovery request. The filters of FindServers are part of the key. */
+static char *getDiscoveryKey(const char *service, const char *endpointUri, size_t serverUrisSize,
+        unsigned char **serverUris, size_t localeIdsSize, unsigned char **localeIds)
+{
+    size_t length = strlen(service) + strlen(endpointUri) + 2;
+    for (size_t i = 0; i < serverUrisSize; ++i)
+    {
+        length += strlen((char *) serverUris[i]) + 3;
+    }
+    for (size_t i = 0; i < localeIdsSize; ++i)
+    {
+        length += strlen((char *) localeIds[i]) + 3;
+    }
+
+    char *key = (char *) EdgeMalloc(length);
+    VERIFY_NON_NULL_MSG(key, "EdgeMalloc FAILED for key in getDiscoveryKey\n", NULL);
+    char *pos = key + sprintf(key, "%s %s", service, endpointUri);
+    for (size_t i = 0; i < serverUrisSize; ++i)
+    {
+        pos += sprintf(pos, "\ns:%s", (char *) serverUris[i]);
+    }
+    for (size_t i = 0; i < localeIdsSize; ++i)
+    {
+        pos += sprintf(pos, "\nl:%s", (char *) localeIds[i]);
+    }
+    return key;
+}
+
+static void freeDiscoveryEntry(discoveryEntry *entry)
+{
+    if (entry->device)
+    {
+        freeEdgeDevice(entry->device);
+    }
+    for (size_t i = 0; i < entry->serversSize; ++i)
+    {
+        freeEdgeApplicationConfigMembers(&entry->servers[i]);
+    }
+    EdgeFree(entry->servers);
+    EdgeFree(entry->endpointUri);
+    EdgeFree(entry->key);
+    EdgeFree(entry);
+}
+
+/* Should be called with discoveryMutex held. */
+static void unrefDiscoveryEntry(discoveryEntry *entry)
+{
+    if (0 == --entry->refCount)
+    {
+        freeDiscoveryEntry(entry);
+    }
+}
+
+/* Should be called with discoveryMutex held. */
+static void removeDiscoveryEntry(discoveryEntry *entry)
+{
+    if (IS_NULL(discoveryCache) || entry != getMapElement(discoveryCache, (keyValue) entry->key))
+    {
+        /* Already invalidated */
+        return;
+    }
+    EdgeFree(removeMapElement(discoveryCache, (keyValue) entry->key));
+    unrefDiscoveryEntry(entry);
+    if (0 == discoveryCache->count)
+    {
+        deleteMap(discoveryCache);
+        EdgeFree(discoveryCache);
+        discoveryCache = NULL;
+    }
+}
+
+/**
+ * Takes a reference to the cached result of a discovery request. A missing or expired result
+ * is added as loading and *loading tells the caller to send the request and complete the entry
+ * with completeDiscovery. Other lookups of a loading entry wait for its result, so concurrent
+ * lookups send a single request.
+ * Returns NULL if the cache is disabled.
+ */
+static discoveryEntry *lookupDiscovery(const char *key, const char *endpointUri, bool *loading)
+{
+    discoveryEntry *entry = NULL;
+    *loading = false;
+
+    // cached results outlive the message arena of the caller.
+    EdgeArena *previous = EdgeArenaEnter(NULL);
+    pthread_mutex_lock(&discoveryMutex);
+    if (0 == discoveryCacheTtlMs)
+    {
+        goto EXIT;
+    }
+
+    if (discoveryCache)
+    {
+        entry = (discoveryEntry *) getMapElement(discoveryCache, (keyValue) key);
+    }
+    if (entry && !entry->loading && getMonotonicMs() >= entry->expiresMs)
+    {
+        removeDiscoveryEntry(entry);
+        entry = NULL;
+    }
+    if (entry)
+    {
+        entry->refCount++;
+        while (entry->loading)
+        {
+            pthread_cond_wait(&discoveryCond, &discoveryMutex);
+        }
+        goto EXIT;
+    }
+
+    entry = (discoveryEntry *) EdgeCalloc(1, sizeof(discoveryEntry));
+    if (IS_NULL(entry))
+    {
+        EDGE_LOG(TAG, "EdgeCalloc FAILED for entry in lookupDiscovery\n");
+        goto EXIT;
+    }
+    entry->key = cloneString(key);
+    entry->endpointUri = cloneString(endpointUri);
+    if (IS_NULL(discoveryCache))
+    {
+        discoveryCache = createStringMap();
+    }
+    if (IS_NULL(entry->key) || IS_NULL(entry->endpointUri) || IS_NULL(discoveryCache))
+    {
+        EDGE_LOG(TAG, "Memory allocation failed in lookupDiscovery\n");
+        freeDiscoveryEntry(entry);
+        entry = NULL;
+        goto EXIT;
+    }
+
+    /* One reference for the cache and one for the caller */
+    entry->refCount = 2;
+    entry->loading = true;
+    insertMapElement(discoveryCache, (keyValue) entry->key, (keyValue) entry);
+    if (entry != getMapElement(discoveryCache, (keyValue) entry->key))
+    {
+        /* Not cached, the caller still sends the request */
+        entry->refCount = 1;
+    }
+    *loading = true;
+
+EXIT:
+    pthread_mutex_unlock(&discoveryMutex);
+    EdgeArenaLeave(previous);
+    return entry;
+}
+
+/* Sets the result of a loading entry and wakes the lookups waiting for it. Failed requests
+ * are not cached. */
+static void completeDiscovery(discoveryEntry *entry, EdgeResult result)
+{
+    pthread_mutex_lock(&discoveryMutex);
+    entry->result = result;
+    entry->expiresMs = getMonotonicMs() + discoveryCacheTtlMs;
+    entry->loading = false;
+    if (STATUS_OK != result.code)
+    {
+        removeDiscoveryEntry(entry);
+    }
+    pthread_cond_broadcast(&discoveryCond);
+    pthread_mutex_unlock(&discoveryMutex);
+}
+
+static void releaseDiscoveryEntry(discoveryEntry *entry)
+{
+    pthread_mutex_lock(&discoveryMutex);
+    unrefDiscoveryEntry(entry);
+    pthread_mutex_unlock(&discoveryMutex);
+}
+
+/* Replaces the endpoint infos of a discovered device with shared ones, so that copies of
+ * the device only take references to them. */
+static bool shareDiscoveredDevice(EdgeDevice *device)
+{
+    for (size_t i = 0; i < device->num_endpoints; ++i)
+    {
+        EdgeEndPointInfo *shared = shareEdgeEndpointInfo(device->endpointsInfo[i]);
+        VERIFY_NON_NULL_MSG(shared, "shareEdgeEndpointInfo FAILED in shareDiscoveredDevice\n", false);
+        freeEdgeEndpointInfo(device->endpointsInfo[i]);
+        device->endpointsInfo[i] = shared;
+    }
+    return true;
+}
+
+/* Copy of a cached device for the discovery callback. */
+static EdgeDevice *copyDiscoveredDevice(EdgeDevice *device)
+{
+    EdgeDevice *copy = (EdgeDevice *) EdgeCalloc(1, sizeof(EdgeDevice));
+    VERIFY_NON_NULL_MSG(copy, "EdgeCalloc FAILED for copy in copyDiscoveredDevice\n", NULL);
+    copy->port = device->port;
+    copy->address = cloneString(device->address);
+    if (IS_NULL(copy->address))
+    {
+        goto ERROR;
+    }
+    if (device->serverName)
+    {
+        copy->serverName = cloneString(device->serverName);
+        if (IS_NULL(copy->serverName))
+        {
+            goto ERROR;
+        }
+    }
+    if (device->num_endpoints > 0)
+    {
+        copy->endpointsInfo = (EdgeEndPointInfo **) EdgeCalloc(device->num_endpoints,
+                sizeof(EdgeEndPointInfo *));
+        if (IS_NULL(copy->endpointsInfo))
+        {
+            goto ERROR;
+        }
+    }
+    for (size_t i = 0; i < device->num_endpoints; ++i)
+    {
+        copy->endpointsInfo[i] = shareEdgeEndpointInfo(device->endpointsInfo[i]);
+        if (IS_NULL(copy->endpointsInfo[i]))
+        {
+            goto ERROR;
+        }
+        copy->num_endpoints = i + 1;
+    }
+    return copy;
+
+ERROR:
+    EDGE_LOG(TAG, "Memory allocation failed in copyDiscoveredDevice\n");
+    freeEdgeDevice(copy);
+    return NULL;
+}
+
+/* Copy of cached FindServers results for the caller. */
+static bool copyDiscoveredServers(discoveryEntry *entry, size_t *serversSize,
+        EdgeApplicationConfig **servers)
+{
+    *serversSize = 0;
+    *servers = NULL;
+    if (0 == entry->serversSize)
+    {
+        return true;
+    }
+
+    EdgeApplicationConfig *copy = (EdgeApplicationConfig *) EdgeCalloc(entry->serversSize,
+            sizeof(EdgeApplicationConfig));
+    VERIFY_NON_NULL_MSG(copy, "EdgeCalloc FAILED for copy in copyDiscoveredServers\n", false);
+    for (size_t i = 0; i < entry->serversSize; ++i)
+    {
+        EdgeApplicationConfig *config = cloneEdgeApplicationConfig(&entry->servers[i]);
+        if (IS_NULL(config))
+        {
+            EDGE_LOG(TAG, "cloneEdgeApplicationConfig FAILED in copyDiscoveredServers\n");
+            for (size_t j = 0; j < i; ++j)
+            {
+                freeEdgeApplicationConfigMembers(&copy[j]);
+            }
+            EdgeFree(copy);
+            return false;
+        }
+        copy[i] = *config;
+        EdgeFree(config);
+    }
+    *serversSize = entry->serversSize;
+    *servers = copy;
+    return true;
+}
+
+void configureDiscoveryCache(uint32_t ttlMs)
+{
+    pthread_mutex_lock(&discoveryMutex);
+    discoveryCacheTtlMs = ttlMs;
+    pthread_mutex_unlock(&discoveryMutex);
+    clearDiscoveryCache(NULL);
+}
+
+void clearDiscoveryCache(const char *endpointUri)
+{
+    pthread_mutex_lock(&discoveryMutex);
+    edgeMapNode *node = discoveryCache ? discoveryCache->head : NULL;
+    while (node)
+    {
+        discoveryEntry *entry = (discoveryEntry *) node->value;
+        node = node->next;
+        if (IS_NULL(endpointUri) || !strcmp(entry->endpointUri, endpointUri))
+        {
+            /* Lookups using the entry keep their reference */
+            removeDiscoveryEntry(entry);
+        }
+    }
+    pthread_mutex_unlock(&discoveryMutex);
+}
+
+static EdgeResult findServersCached(const char *endpointUri, size_t serverUrisSize,
+    unsigned char **serverUris, size_t localeIdsSize, unsigned char **localeIds,
+    size_t *registeredServersSize, EdgeApplicationConfig **registeredServers)
+{
+    EdgeResult res;
+    bool loading = false;
+    discoveryEntry *entry = NULL;
+    char *key = getDiscoveryKey("FindServers", endpointUri, serverUrisSize, serverUris,
+            localeIdsSize, localeIds);
+    if (key)
+    {
+        entry = lookupDiscovery(key, endpointUri, &loading);
+        EdgeFree(key);
+    }
+    if (IS_NULL(entry))
+    {
+        return requestServers(endpointUri, serverUrisSize, serverUris, localeIdsSize, localeIds,
+                registeredServersSize, registeredServers);
+    }
+
+    if (loading)
+    {
+        EdgeArena *previous = EdgeArenaEnter(NULL);
+        res = requestServers(endpointUri, serverUrisSize, serverUris, localeIdsSize, localeIds,
+                &entry->serversSize, &entry->servers);
+        EdgeArenaLeave(previous);
+        completeDiscovery(entry, res);
+    }
+    else
+    {
+        EDGE_LOG(TAG, "Found servers in the discovery cache.");
+        res = entry->result;
+    }
+
+    if (STATUS_OK == res.code
+            && !copyDiscoveredServers(entry, registeredServersSize, registeredServers))
+    {
+        res.code = STATUS_INTERNAL_ERROR;
+    }
+    releaseDiscoveryEntry(entry);
+    return res;
+}
+
+EdgeResult findServersInternal(const char *endpointUri, size_t serverUrisSize,
+    unsigned char **serverUris, size_t localeIdsSize, unsigned char **localeIds,
+    size_t *registeredServersSize, EdgeApplicationConfig **registeredServers)
+{
+    EdgeResult res;
+    if(IS_NULL(endpointUri))
+    {
+        EDGE_LOG(TAG, "endpointUri is NULL.");
+        res.code = STATUS_PARAM_INVALID;
+        return res;
+    }
+
+    if(serverUrisSize > 0 && IS_NULL(serverUris))
+    {
+        EDGE_LOG(TAG, "serverUrisSize is > 0 but serverUris is NULL.");
+        res.code = STATUS_PARAM_INVALID;
+        return res;
+    }
+
+    for(size_t i = 0; i < serverUrisSize; ++i)
+    {
+        if(IS_NULL(serverUris[i]))
+        {
+            EDGE_LOG_V(TAG, "serverUris[%zu] is NULL.", i);
+            res.code = STATUS_PARAM_INVALID;
+            return res;
+        }
+    }
+
+    if(localeIdsSize > 0 && IS_NULL(localeIds))
+    {
+        EDGE_LOG(TAG, "localeIdsSize is > 0 but localeIds is NULL.");
+        res.code = STATUS_PARAM_INVALID;
+        return res;
+    }
+
+    for(size_t i = 0; i < localeIdsSize; ++i)
+    {
+        if(IS_NULL(localeIds[i]))
+        {
+            EDGE_LOG_V(TAG, "localeIds[%zu] is NULL.", i);
+            res.code = STATUS_PARAM_INVALID;
+            return res;
+        }
+    }
+
+    if(IS_NULL(registeredServersSize) || IS_NULL(registeredServers))
+    {
+        EDGE_LOG(TAG, "NULL registeredServersSize/registeredServers.");
+        res.code = STATUS_PARAM_INVALID;
+        return res;
+    }
+
+    UA_String hostName = UA_STRING_NULL, path = UA_STRING_NULL;
+    UA_UInt16 port = 0;
+    UA_String endpointUrlString = UA_STRING((char *) (uintptr_t) endpointUri);
+    UA_StatusCode parse_retval = UA_parseEndpointUrl(&endpointUrlString, &hostName, &port, &path);
+    if (parse_retval != UA_STATUSCODE_GOOD)
+    {
+        EDGE_LOG_V(TAG, "Endpoint URL is invalid. Error Code: %s.", UA_StatusCode_name(parse_retval));
+        res.code = STATUS_PARAM_INVALID;
+        return res;
+    }
+
+    return findServersCached(endpointUri, serverUrisSize, serverUris, localeIdsSize, localeIds,
+            registeredServersSize, registeredServers);
+}
+
+/* Sends a GetEndpoints request. *found is the device to report, if any. */
+static EdgeResult requestEndpoints(char *endpointUri, EdgeDevice **found)
 {
     EdgeResult result;
     UA_StatusCode retVal;
@@ -1144,7 +2253,8 @@ EdgeResult getClientEndpoints(char *endpointUri)
     if (0 == endpointArraySize)
     {
         EDGE_LOG(TAG, "No endpoints found.");
-        g_discoveryCallback(device);
+        *found = device;
+        device = NULL;
         result.code = STATUS_OK;
         goto EXIT;
     }
@@ -1164,7 +2274,7 @@ EdgeResult getClientEndpoints(char *endpointUri)
     }
 
     device->num_endpoints = count;
-    device->endpointsInfo = (EdgeEndPointInfo **) calloc(count, sizeof(EdgeEndPointInfo *));
+    device->endpointsInfo = (EdgeEndPointInfo **) EdgeCalloc(count, sizeof(EdgeEndPointInfo *));
     if (!device->endpointsInfo)
     {
         EDGE_LOG(TAG, "Memory allocation failed.");
@@ -1179,7 +2289,8 @@ EdgeResult getClientEndpoints(char *endpointUri)
         ptr = ptr->link;
     }
 
-    g_discoveryCallback(device);
+    *found = device;
+    device = NULL;
     result.code = STATUS_OK;
 
     EXIT:
@@ -1197,6 +2308,64 @@ EdgeResult getClientEndpoints(char *endpointUri)
     return result;
 }
 
+EdgeResult getClientEndpoints(char *endpointUri)
+{
+    EdgeResult result;
+    result.code = STATUS_PARAM_INVALID;
+    VERIFY_NON_NULL_MSG(endpointUri, "NULL endpointUri param in getClientEndpoints\n", result);
+
+    EdgeDevice *device = NULL;
+    bool loading = false;
+    discoveryEntry *entry = NULL;
+    char *key = getDiscoveryKey("GetEndpoints", endpointUri, 0, NULL, 0, NULL);
+    if (key)
+    {
+        entry = lookupDiscovery(key, endpointUri, &loading);
+        EdgeFree(key);
+    }
+
+    if (IS_NULL(entry))
+    {
+        result = requestEndpoints(endpointUri, &device);
+    }
+    else
+    {
+        if (loading)
+        {
+            EdgeArena *previous = EdgeArenaEnter(NULL);
+            result = requestEndpoints(endpointUri, &entry->device);
+            if (entry->device && !shareDiscoveredDevice(entry->device))
+            {
+                result.code = STATUS_INTERNAL_ERROR;
+            }
+            EdgeArenaLeave(previous);
+            completeDiscovery(entry, result);
+        }
+        else
+        {
+            EDGE_LOG(TAG, "Found endpoints in the discovery cache.");
+            result = entry->result;
+        }
+
+        if (STATUS_OK == result.code && entry->device)
+        {
+            device = copyDiscoveredDevice(entry->device);
+            if (IS_NULL(device))
+            {
+                result.code = STATUS_INTERNAL_ERROR;
+            }
+        }
+        releaseDiscoveryEntry(entry);
+    }
+
+    if (device)
+    {
+        g_discoveryCallback(device);
+        freeEdgeDevice(device);
+    }
+    return result;
+}
+
 void registerClientCallback(response_cb_t resCallback, status_cb_t statusCallback, discovery_cb_t discoveryCallback)
 {
     registerBrowseResponseCallback(resCallback);
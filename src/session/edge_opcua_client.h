@@ -43,20 +43,64 @@ extern "C"
  */
 void setSupportedApplicationTypes(uint8_t supportedTypes);
 
+/**
+ * @brief Sets the number of sessions connect_client opens to an endpoint
+ * @remarks Reads, writes and method calls use the least loaded session of the endpoint.
+ *          Browsing and subscriptions stay on the first session.
+ * @param[in]  sessions Number of sessions. 0 or 1 opens a single session
+ */
+void configureSessionPool(size_t sessions);
+
+/**
+ * @brief Sets how long getClientEndpoints and findServersInternal reuse the results of a
+ *        server and clears the cached results
+ * @remarks Concurrent lookups of an uncached result send a single request. Failed requests
+ *          are not cached.
+ * @param[in]  ttlMs Time to live of a result in milliseconds. 0 disables the cache
+ */
+void configureDiscoveryCache(uint32_t ttlMs);
+
+/**
+ * @brief Removes cached discovery results, see configureDiscoveryCache
+ * @param[in]  endpointUri Endpoint whose results are removed, NULL removes all results
+ */
+void clearDiscoveryCache(const char *endpointUri);
+
 /**
  * @brief Establishes client connection
- * @param[in]  endpoint Endpoint Uri
+ * @param[in]  epInfo Endpoint information, shared by the session with its requests
  * @return @c true on success, false in case of error
  * @retval #true Successful
  * @retval #false Error
  */
-bool connect_client(char *endpoint);
+bool connect_client(EdgeEndPointInfo *epInfo);
+
+/**
+ * @brief Establishes client connections to several endpoints at the same time
+ * @remarks STATUS_CLIENT_STARTED is reported for each endpoint as soon as it is connected.
+ * @param[in]  endpoints Endpoint information of each endpoint, see connect_client
+ * @param[in]  count Number of endpoints
+ * @param[in]  timeoutMs Maximum time for each step of a connect in milliseconds. 0 or less
+ *             uses the default client timeout
+ * @return Number of endpoints connected
+ */
+size_t connect_clients(EdgeEndPointInfo **endpoints, size_t count, int timeoutMs);
+
+/**
+ * @brief Asks the session supervisor to check the connections of the sessions at once
+ * @remarks Called when a service call failed because the connection was lost. The supervisor
+ *          reports STATUS_DISCONNECTED, connects the session again with backoff and reports
+ *          STATUS_CONNECTED once its subscriptions are re-created.
+ */
+void requestConnectionCheck();
 
 /**
  * @brief Close the client connection
+ * @remarks Does not delete the message queues, since it may run on one of their threads.
  * @param[in]  epInfo Endpoint information
+ * @return true if the last connected client was closed, otherwise false
  */
-void disconnect_client(EdgeEndPointInfo *epInfo);
+bool disconnect_client(EdgeEndPointInfo *epInfo);
 
 /**
  * @brief Gets a list of all registered servers at the given server. Application has to free the memory \n
@@ -98,6 +142,34 @@ EdgeResult getClientEndpoints(char *endpointUri);
  */
 EdgeResult readNodesFromServer(EdgeMessage *msg);
 
+/**
+ * @brief Send the read request data of several messages to server in one ReadRequest
+ * @remarks All messages have the same endpoint and the same read command.
+ * @param[in]  msgs EdgeMessage request data.
+ * @param[in]  count Number of messages.
+ * @return @c EdgeResult code is 0 on success, otherwise an error value
+ * @retval #STATUS_OK Successful
+ * @retval #STATUS_PARAM_INVALID Invalid parameter
+ * @retval #STATUS_ERROR Operation failed
+ */
+EdgeResult readNodesFromServerBatch(EdgeMessage **msgs, size_t count);
+
+/**
+ * @brief Executes a read, write or method request on the calling thread
+ * @remarks The session of the request endpoint is locked for the call, so it does not
+ *          overlap with the queued requests of that endpoint.
+ * @param[in]  msg EdgeMessage request data.
+ * @param[out]  response Response or error message of the request. Freed by the caller.
+ * @param[in]  timeoutMs Maximum time to wait for the session. 0 or less waits without limit.
+ * @return @c EdgeResult code is 0 on success, otherwise an error value
+ * @retval #STATUS_OK Successful
+ * @retval #STATUS_PARAM_INVALID Invalid parameter
+ * @retval #STATUS_NOT_SUPPORT The command cannot run synchronously
+ * @retval #STATUS_TIMEOUT The session stayed busy for timeoutMs
+ * @retval #STATUS_ERROR Operation failed
+ */
+EdgeResult executeRequestSync(EdgeMessage *msg, EdgeMessage **response, int timeoutMs);
+
 /**
  * @brief Send the write request data to server
  * @param[in]  msg EdgeMessage request data.
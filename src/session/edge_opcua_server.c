@@ -97,19 +97,7 @@ void printNodeListInServer()
 
 static void* getNamespaceIndex(const char *namespaceUri)
 {
-    if (namespaceMap)
-    {
-        edgeMapNode *temp = namespaceMap->head;
-        while (temp != NULL)
-        {
-            char *uri = (char*) temp->key;
-            if (!strcmp(uri, namespaceUri))
-                return temp->value;
-
-            temp = temp->next;
-        }
-    }
-    return NULL;
+    return namespaceUri ? getMapElement(namespaceMap, (keyValue) namespaceUri) : NULL;
 }
 
 EdgeResult createNamespaceInServer(const char *namespaceUri, const char *rootNodeIdentifier,
@@ -165,7 +153,7 @@ EdgeResult createNamespaceInServer(const char *namespaceUri, const char *rootNod
     strncpy(ns->rootNodeDisplayName, rootNodeDisplayName, strlen(rootNodeDisplayName)+1);
 
     if (namespaceMap == NULL)
-        namespaceMap = createMap();
+        namespaceMap = createStringMap();
     insertMapElement(namespaceMap, (keyValue) namespaceUri, (keyValue) ns);
     return result;
 
@@ -305,7 +293,7 @@ EdgeNodeItem* createNodeItemImpl(const char* name, EdgeIdentifier nodeType, Edge
 EdgeResult deleteNodeItemImpl(EdgeNodeItem* item)
 {
     EdgeResult result;
-    free(item);
+    EdgeFree(item);
     result.code = STATUS_OK;
     return result;
 }
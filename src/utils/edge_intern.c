@@ -0,0 +1,210 @@
+/******************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include "edge_intern.h"
+#include "edge_malloc.h"
+#include "edge_utils.h"
+#include "edge_logger.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#define TAG "edge_intern"
+
+#define INTERN_MIN_BUCKETS (64)
+
+/* Interned string; the handle given out is str. */
+typedef struct InternEntry
+{
+    struct InternEntry *next;
+    uint32_t hash;
+    /* Guarded by internMutex. */
+    uint32_t refCount;
+    size_t length;
+    char str[];
+} InternEntry;
+
+static InternEntry **g_buckets = NULL;
+static size_t g_bucketCount = 0;
+static size_t g_count = 0;
+static pthread_mutex_t internMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static uint32_t internHash(const char *str, size_t length)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= (unsigned char) str[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static InternEntry *entryOf(const char *handle)
+{
+    return (InternEntry *) (handle - offsetof(InternEntry, str));
+}
+
+/* Should be called with internMutex held. */
+static InternEntry *findEntry(const char *str, size_t length, uint32_t hash)
+{
+    if (0 == g_bucketCount)
+    {
+        return NULL;
+    }
+    for (InternEntry *entry = g_buckets[hash & (g_bucketCount - 1)]; entry; entry = entry->next)
+    {
+        if (entry->hash == hash && entry->length == length && !memcmp(entry->str, str, length))
+        {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/* Should be called with internMutex held. */
+static bool growBuckets()
+{
+    size_t count = g_bucketCount ? g_bucketCount * 2 : INTERN_MIN_BUCKETS;
+    InternEntry **buckets = (InternEntry **) EdgeCalloc(count, sizeof(InternEntry *));
+    VERIFY_NON_NULL_MSG(buckets, "EdgeCalloc FAILED for buckets in growBuckets\n", false);
+
+    for (size_t i = 0; i < g_bucketCount; i++)
+    {
+        InternEntry *entry = g_buckets[i];
+        while (entry)
+        {
+            InternEntry *next = entry->next;
+            entry->next = buckets[entry->hash & (count - 1)];
+            buckets[entry->hash & (count - 1)] = entry;
+            entry = next;
+        }
+    }
+    EdgeFree(g_buckets);
+    g_buckets = buckets;
+    g_bucketCount = count;
+    return true;
+}
+
+const char *EdgeInternString(const char *str)
+{
+    VERIFY_NON_NULL_MSG(str, "NULL str param in EdgeInternString\n", NULL);
+    return EdgeInternStringN(str, strlen(str));
+}
+
+const char *EdgeInternStringN(const char *str, size_t length)
+{
+    VERIFY_NON_NULL_MSG(str, "NULL str param in EdgeInternStringN\n", NULL);
+    uint32_t hash = internHash(str, length);
+    const char *handle = NULL;
+
+    // interned strings outlive the message arena they are looked up from.
+    EdgeArena *previous = EdgeArenaEnter(NULL);
+    pthread_mutex_lock(&internMutex);
+
+    InternEntry *entry = findEntry(str, length, hash);
+    if (IS_NULL(entry))
+    {
+        if (g_count >= g_bucketCount && !growBuckets())
+        {
+            goto EXIT;
+        }
+        entry = (InternEntry *) EdgeMalloc(sizeof(InternEntry) + length + 1);
+        if (IS_NULL(entry))
+        {
+            EDGE_LOG(TAG, "EdgeMalloc FAILED for entry in EdgeInternStringN\n");
+            goto EXIT;
+        }
+        entry->hash = hash;
+        entry->refCount = 0;
+        entry->length = length;
+        memcpy(entry->str, str, length);
+        entry->str[length] = '\0';
+        entry->next = g_buckets[hash & (g_bucketCount - 1)];
+        g_buckets[hash & (g_bucketCount - 1)] = entry;
+        g_count++;
+    }
+    entry->refCount++;
+    handle = entry->str;
+
+EXIT:
+    pthread_mutex_unlock(&internMutex);
+    EdgeArenaLeave(previous);
+    return handle;
+}
+
+const char *EdgeInternRetain(const char *handle)
+{
+    VERIFY_NON_NULL_MSG(handle, "NULL handle param in EdgeInternRetain\n", NULL);
+    pthread_mutex_lock(&internMutex);
+    entryOf(handle)->refCount++;
+    pthread_mutex_unlock(&internMutex);
+    return handle;
+}
+
+const char *EdgeInternFind(const char *str, size_t length)
+{
+    VERIFY_NON_NULL_MSG(str, "NULL str param in EdgeInternFind\n", NULL);
+    uint32_t hash = internHash(str, length);
+
+    pthread_mutex_lock(&internMutex);
+    InternEntry *entry = findEntry(str, length, hash);
+    pthread_mutex_unlock(&internMutex);
+
+    return entry ? entry->str : NULL;
+}
+
+void EdgeInternRelease(const char *handle)
+{
+    VERIFY_NON_NULL_NR_MSG(handle, "NULL handle param in EdgeInternRelease\n");
+    InternEntry *entry = entryOf(handle);
+
+    EdgeArena *previous = EdgeArenaEnter(NULL);
+    pthread_mutex_lock(&internMutex);
+    if (0 == --entry->refCount)
+    {
+        InternEntry **link = &g_buckets[entry->hash & (g_bucketCount - 1)];
+        while (*link != entry)
+        {
+            link = &(*link)->next;
+        }
+        *link = entry->next;
+        EdgeFree(entry);
+
+        if (0 == --g_count)
+        {
+            EdgeFree(g_buckets);
+            g_buckets = NULL;
+            g_bucketCount = 0;
+        }
+    }
+    pthread_mutex_unlock(&internMutex);
+    EdgeArenaLeave(previous);
+}
+
+size_t EdgeInternCount()
+{
+    pthread_mutex_lock(&internMutex);
+    size_t count = g_count;
+    pthread_mutex_unlock(&internMutex);
+    return count;
+}
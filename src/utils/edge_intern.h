@@ -0,0 +1,86 @@
+/******************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file edge_intern.h
+ * @brief This file contains a global table of interned strings. Equal strings share one
+ *        immutable, reference-counted handle, so interned strings are compared by pointer.
+ */
+
+#ifndef EDGE_INTERN_H
+#define EDGE_INTERN_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Interns a NUL-terminated string and takes a reference to its handle.
+ * @remarks The handle is given back with EdgeInternRelease. It is never allocated from a
+ *          message arena.
+ * @param[in]  str String to be interned.
+ * @return Handle of the string on success, otherwise null.
+ */
+const char *EdgeInternString(const char *str);
+
+/**
+ * @brief Interns the first length bytes of str and takes a reference to its handle.
+ * @param[in]  str String to be interned, need not be NUL-terminated.
+ * @param[in]  length Length of the string.
+ * @return NUL-terminated handle of the string on success, otherwise null.
+ */
+const char *EdgeInternStringN(const char *str, size_t length);
+
+/**
+ * @brief Takes another reference to an interned string.
+ * @param[in]  handle Handle of the string.
+ * @return handle.
+ */
+const char *EdgeInternRetain(const char *handle);
+
+/**
+ * @brief Finds the handle of an interned string without taking a reference.
+ * @remarks The handle may only be used for comparisons while a reference is held elsewhere.
+ * @param[in]  str String to look up, need not be NUL-terminated.
+ * @param[in]  length Length of the string.
+ * @return Handle of the string, or null if the string is not interned.
+ */
+const char *EdgeInternFind(const char *str, size_t length);
+
+/**
+ * @brief Gives back a reference taken with EdgeInternString. The string is freed with its
+ *        last reference.
+ * @param[in]  handle Handle of the string.
+ */
+void EdgeInternRelease(const char *handle);
+
+/**
+ * @brief Number of distinct strings currently interned.
+ * @return Number of strings.
+ */
+size_t EdgeInternCount();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EDGE_INTERN_H */
@@ -20,13 +20,537 @@
 
 #include "edge_malloc.h"
 #include "edge_utils.h"
+#include "open62541.h"
 
 #include <stdio.h>
+#include <stdint.h>
 #include <string.h>
+#include <pthread.h>
 
 #define TAG "edge_malloc"
 
-void *EdgeMalloc(size_t size)
+/* Arena blocks are accounted to this tag, whichever subsystem fills them. */
+#define ARENA_TAG "edge_arena"
+
+// This file defines the untagged functions the accounting macros stand for.
+#undef EdgeMalloc
+#undef EdgeCalloc
+#undef EdgeRealloc
+
+/* Functions all memory of the library comes from, see EdgeSetAllocator. */
+typedef struct
+{
+    EdgeMallocFunction mallocFn;
+    EdgeCallocFunction callocFn;
+    EdgeReallocFunction reallocFn;
+    EdgeFreeFunction freeFn;
+} EdgeAllocator;
+
+static EdgeAllocator g_allocator = { malloc, calloc, realloc, free };
+
+#ifdef EDGE_MEMORY_STATS
+
+#include "opcua_interface.h"
+
+/*
+ * Live heap allocations are kept in an open addressing table from pointer to size and
+ * tag, so pointers that did not come from EdgeMalloc (e.g. from open62541) can still
+ * be given to EdgeFree: they are simply not found.
+ */
+#define MEMORY_TABLE_INITIAL_CAPACITY 4096
+
+typedef struct
+{
+    void *ptr;
+    size_t size;
+    size_t tag;
+} MemoryRecord;
+
+static pthread_mutex_t g_memoryMutex = PTHREAD_MUTEX_INITIALIZER;
+static MemoryRecord *g_memoryTable = NULL;
+static size_t g_memoryTableCapacity = 0;
+static size_t g_memoryTableCount = 0;
+static EdgeMemoryTagStats g_memoryTags[EDGE_MEMORY_MAX_TAGS];
+static size_t g_memoryTagCount = 0;
+static size_t g_memoryLiveBytes = 0;
+static size_t g_memoryPeakBytes = 0;
+
+static size_t memoryHash(const void *ptr, size_t capacity)
+{
+    uint64_t key = (uint64_t) (uintptr_t) ptr;
+    return (size_t) ((key * 0x9E3779B97F4A7C15ULL) >> 17) & (capacity - 1);
+}
+
+/* Tags are string literals; the same TAG may have a different address in each file. */
+static size_t memoryTagIndex(const char *tag)
+{
+    if (NULL == tag)
+    {
+        tag = "unknown";
+    }
+    for (size_t i = 0; i < g_memoryTagCount; i++)
+    {
+        if (g_memoryTags[i].tag == tag || 0 == strcmp(g_memoryTags[i].tag, tag))
+        {
+            return i;
+        }
+    }
+    if (g_memoryTagCount == EDGE_MEMORY_MAX_TAGS)
+    {
+        // the last slot collects the tags which did not fit.
+        g_memoryTags[EDGE_MEMORY_MAX_TAGS - 1].tag = "other";
+        return EDGE_MEMORY_MAX_TAGS - 1;
+    }
+    g_memoryTags[g_memoryTagCount].tag = tag;
+    return g_memoryTagCount++;
+}
+
+static void memoryTableInsert(MemoryRecord *table, size_t capacity, MemoryRecord record)
+{
+    size_t index = memoryHash(record.ptr, capacity);
+    while (table[index].ptr)
+    {
+        index = (index + 1) & (capacity - 1);
+    }
+    table[index] = record;
+}
+
+static bool memoryTableGrow(void)
+{
+    size_t capacity = g_memoryTableCapacity ? g_memoryTableCapacity * 2 :
+            MEMORY_TABLE_INITIAL_CAPACITY;
+    MemoryRecord *table = (MemoryRecord *) calloc(capacity, sizeof(MemoryRecord));
+    if (NULL == table)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < g_memoryTableCapacity; i++)
+    {
+        if (g_memoryTable[i].ptr)
+        {
+            memoryTableInsert(table, capacity, g_memoryTable[i]);
+        }
+    }
+    free(g_memoryTable);
+    g_memoryTable = table;
+    g_memoryTableCapacity = capacity;
+    return true;
+}
+
+static void memoryTrack(void *ptr, size_t size, const char *tag)
+{
+    if (NULL == ptr)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&g_memoryMutex);
+    // keep the load factor at most 1/2.
+    if (2 * (g_memoryTableCount + 1) > g_memoryTableCapacity && !memoryTableGrow())
+    {
+        pthread_mutex_unlock(&g_memoryMutex);
+        return;
+    }
+
+    MemoryRecord record = { ptr, size, memoryTagIndex(tag) };
+    memoryTableInsert(g_memoryTable, g_memoryTableCapacity, record);
+    g_memoryTableCount++;
+
+    EdgeMemoryTagStats *stats = &g_memoryTags[record.tag];
+    stats->allocations++;
+    stats->liveCount++;
+    stats->liveBytes += size;
+    if (stats->liveBytes > stats->peakBytes)
+    {
+        stats->peakBytes = stats->liveBytes;
+    }
+    g_memoryLiveBytes += size;
+    if (g_memoryLiveBytes > g_memoryPeakBytes)
+    {
+        g_memoryPeakBytes = g_memoryLiveBytes;
+    }
+    pthread_mutex_unlock(&g_memoryMutex);
+}
+
+/* Returns the size of the allocation, 0 if ptr is not tracked. */
+static size_t memoryUntrack(void *ptr)
+{
+    pthread_mutex_lock(&g_memoryMutex);
+    if (0 == g_memoryTableCount)
+    {
+        pthread_mutex_unlock(&g_memoryMutex);
+        return 0;
+    }
+
+    size_t mask = g_memoryTableCapacity - 1;
+    size_t index = memoryHash(ptr, g_memoryTableCapacity);
+    while (g_memoryTable[index].ptr && g_memoryTable[index].ptr != ptr)
+    {
+        index = (index + 1) & mask;
+    }
+    if (NULL == g_memoryTable[index].ptr)
+    {
+        pthread_mutex_unlock(&g_memoryMutex);
+        return 0;
+    }
+
+    size_t size = g_memoryTable[index].size;
+    EdgeMemoryTagStats *stats = &g_memoryTags[g_memoryTable[index].tag];
+    stats->liveCount--;
+    stats->liveBytes -= size;
+    g_memoryLiveBytes -= size;
+    g_memoryTableCount--;
+
+    // backward shift deletion keeps every record reachable from its home slot.
+    size_t hole = index;
+    size_t next = (hole + 1) & mask;
+    while (g_memoryTable[next].ptr)
+    {
+        size_t home = memoryHash(g_memoryTable[next].ptr, g_memoryTableCapacity);
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            g_memoryTable[hole] = g_memoryTable[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    g_memoryTable[hole].ptr = NULL;
+    pthread_mutex_unlock(&g_memoryMutex);
+    return size;
+}
+
+#define MEMORY_TRACK(ptr, size, tag) memoryTrack((ptr), (size), (tag))
+#define MEMORY_UNTRACK(ptr) memoryUntrack(ptr)
+
+bool EdgeMemoryGetStats(EdgeMemoryStats *stats)
+{
+    pthread_mutex_lock(&g_memoryMutex);
+    memcpy(stats->tags, g_memoryTags, sizeof(g_memoryTags));
+    stats->tagCount = g_memoryTagCount;
+    stats->liveBytes = g_memoryLiveBytes;
+    stats->peakBytes = g_memoryPeakBytes;
+    pthread_mutex_unlock(&g_memoryMutex);
+    return true;
+}
+
+void EdgeMemoryReportLeaks(void)
+{
+    EdgeMemoryStats stats;
+    EdgeMemoryGetStats(&stats);
+
+    // written regardless of DEBUG, as accounting builds are made to get this report.
+    fprintf(stderr, "[%s] %zu bytes live, peak %zu bytes\n", TAG, stats.liveBytes,
+            stats.peakBytes);
+    for (size_t i = 0; i < stats.tagCount; i++)
+    {
+        if (stats.tags[i].liveCount > 0)
+        {
+            fprintf(stderr, "[%s] %s holds %zu bytes in %zu allocations (peak %zu bytes)\n",
+                    TAG, stats.tags[i].tag, stats.tags[i].liveBytes, stats.tags[i].liveCount,
+                    stats.tags[i].peakBytes);
+        }
+    }
+}
+
+/* The leak report of the process is written when the library is unloaded. */
+__attribute__((destructor)) static void memoryReportAtExit(void)
+{
+    EdgeMemoryReportLeaks();
+}
+
+#else
+
+#define MEMORY_TRACK(ptr, size, tag)
+#define MEMORY_UNTRACK(ptr)
+
+bool EdgeMemoryGetStats(struct EdgeMemoryStats *stats)
+{
+    (void) stats;
+    return false;
+}
+
+void EdgeMemoryReportLeaks(void)
+{
+}
+
+#endif
+
+/* Every arena allocation is preceded by its size, kept at the maximum alignment. */
+typedef union
+{
+    long long l;
+    long double d;
+    void *p;
+} ArenaAlign;
+
+#define ARENA_ALIGNMENT         (sizeof(ArenaAlign))
+#define ARENA_HEADER_SIZE       ARENA_ALIGNMENT
+#define ARENA_ALIGN(size)       (((size) + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1))
+
+typedef struct EdgeArenaBlock
+{
+    struct EdgeArenaBlock *next;
+    size_t size;
+    size_t used;
+    ArenaAlign data[];
+} EdgeArenaBlock;
+
+struct EdgeArena
+{
+    /* Block allocations are taken from; older blocks follow it. */
+    EdgeArenaBlock *blocks;
+    /* Size of the next block. */
+    size_t nextSize;
+    /* Next arena in the shared free list of message arenas. */
+    struct EdgeArena *nextFree;
+    /* Set for arenas of EdgeMessageArenaCreate, which EdgeArenaDestroy recycles. */
+    bool pooled;
+    /* The first block is allocated together with the arena. */
+    EdgeArenaBlock first;
+};
+
+static __thread EdgeArena *t_currentArena = NULL;
+
+/*
+ * Message arenas are recycled through a cache of the calling thread.  A thread that
+ * only destroys arenas (the receive queue) hands half of its cache to a shared free
+ * list when it is full, and a thread that only creates them (a subscription thread)
+ * takes back half a cache when it is empty, so the lock is taken once per
+ * ARENA_CACHE_SIZE / 2 arenas.
+ */
+#define ARENA_CACHE_SIZE        32
+#define ARENA_POOL_MAX_FREE     1024
+
+typedef struct
+{
+    EdgeArena *arenas[ARENA_CACHE_SIZE];
+    size_t count;
+} ArenaCache;
+
+static __thread ArenaCache t_arenaCache;
+static __thread bool t_arenaCacheRegistered = false;
+
+static pthread_mutex_t g_arenaPoolMutex = PTHREAD_MUTEX_INITIALIZER;
+static EdgeArena *g_arenaFreeList = NULL;
+static size_t g_arenaFreeCount = 0;
+static pthread_once_t g_arenaCacheKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t g_arenaCacheKey;
+static bool g_arenaCacheKeyValid = false;
+static uint64_t g_arenaPoolHits = 0;
+static uint64_t g_arenaPoolMisses = 0;
+
+static void arenaFreeBlocks(EdgeArena *arena)
+{
+    EdgeArenaBlock *block = arena->blocks;
+    while (block != &arena->first)
+    {
+        EdgeArenaBlock *next = block->next;
+        MEMORY_UNTRACK(block);
+        g_allocator.freeFn(block);
+        block = next;
+    }
+    arena->blocks = &arena->first;
+    arena->first.used = 0;
+    arena->nextSize = arena->first.size * 2;
+}
+
+static void arenaCacheFlush(ArenaCache *cache, size_t keep)
+{
+    EdgeArena *excess = NULL;
+
+    pthread_mutex_lock(&g_arenaPoolMutex);
+    while (cache->count > keep)
+    {
+        EdgeArena *arena = cache->arenas[--cache->count];
+        if (g_arenaFreeCount < ARENA_POOL_MAX_FREE)
+        {
+            arena->nextFree = g_arenaFreeList;
+            g_arenaFreeList = arena;
+            g_arenaFreeCount++;
+        }
+        else
+        {
+            arena->nextFree = excess;
+            excess = arena;
+        }
+    }
+    pthread_mutex_unlock(&g_arenaPoolMutex);
+
+    while (excess)
+    {
+        EdgeArena *next = excess->nextFree;
+        MEMORY_UNTRACK(excess);
+        g_allocator.freeFn(excess);
+        excess = next;
+    }
+}
+
+static void arenaCacheRefill(ArenaCache *cache)
+{
+    pthread_mutex_lock(&g_arenaPoolMutex);
+    while (cache->count < ARENA_CACHE_SIZE / 2 && g_arenaFreeList)
+    {
+        EdgeArena *arena = g_arenaFreeList;
+        g_arenaFreeList = arena->nextFree;
+        g_arenaFreeCount--;
+        cache->arenas[cache->count++] = arena;
+    }
+    pthread_mutex_unlock(&g_arenaPoolMutex);
+}
+
+/* Thread exit: the cached arenas go back to the shared free list. */
+static void arenaCacheRelease(void *cache)
+{
+    arenaCacheFlush((ArenaCache *) cache, 0);
+}
+
+static void arenaCacheCreateKey(void)
+{
+    g_arenaCacheKeyValid = (0 == pthread_key_create(&g_arenaCacheKey, arenaCacheRelease));
+}
+
+static ArenaCache *arenaCache(void)
+{
+    if (!t_arenaCacheRegistered)
+    {
+        pthread_once(&g_arenaCacheKeyOnce, arenaCacheCreateKey);
+        if (g_arenaCacheKeyValid)
+        {
+            pthread_setspecific(g_arenaCacheKey, &t_arenaCache);
+        }
+        t_arenaCacheRegistered = true;
+    }
+    return &t_arenaCache;
+}
+
+EdgeArena *EdgeArenaCreate(size_t initialSize)
+{
+    initialSize = ARENA_ALIGN(initialSize);
+    EdgeArena *arena = (EdgeArena *) g_allocator.mallocFn(sizeof(EdgeArena) + initialSize);
+    VERIFY_NON_NULL_MSG(arena, "malloc FAILED IN EdgeArenaCreate\n", NULL);
+    MEMORY_TRACK(arena, sizeof(EdgeArena) + initialSize, ARENA_TAG);
+
+    arena->first.next = NULL;
+    arena->first.size = initialSize;
+    arena->first.used = 0;
+    arena->blocks = &arena->first;
+    arena->nextSize = initialSize * 2;
+    arena->nextFree = NULL;
+    arena->pooled = false;
+    return arena;
+}
+
+EdgeArena *EdgeMessageArenaCreate(void)
+{
+    ArenaCache *cache = arenaCache();
+    if (0 == cache->count)
+    {
+        arenaCacheRefill(cache);
+    }
+
+    if (cache->count > 0)
+    {
+        __atomic_fetch_add(&g_arenaPoolHits, 1, __ATOMIC_RELAXED);
+        return cache->arenas[--cache->count];
+    }
+
+    __atomic_fetch_add(&g_arenaPoolMisses, 1, __ATOMIC_RELAXED);
+    EdgeArena *arena = EdgeArenaCreate(EDGE_MESSAGE_ARENA_SIZE);
+    if (arena)
+    {
+        arena->pooled = true;
+    }
+    return arena;
+}
+
+void EdgeArenaDestroy(EdgeArena *arena)
+{
+    if (NULL == arena)
+    {
+        return;
+    }
+
+    arenaFreeBlocks(arena);
+    if (arena->pooled)
+    {
+        ArenaCache *cache = arenaCache();
+        if (ARENA_CACHE_SIZE == cache->count)
+        {
+            arenaCacheFlush(cache, ARENA_CACHE_SIZE / 2);
+        }
+        cache->arenas[cache->count++] = arena;
+        return;
+    }
+    MEMORY_UNTRACK(arena);
+    g_allocator.freeFn(arena);
+}
+
+void EdgeMessageArenaPoolStats(uint64_t *hits, uint64_t *misses, size_t *freeArenas)
+{
+    *hits = __atomic_load_n(&g_arenaPoolHits, __ATOMIC_RELAXED);
+    *misses = __atomic_load_n(&g_arenaPoolMisses, __ATOMIC_RELAXED);
+    pthread_mutex_lock(&g_arenaPoolMutex);
+    *freeArenas = g_arenaFreeCount;
+    pthread_mutex_unlock(&g_arenaPoolMutex);
+}
+
+EdgeArena *EdgeArenaEnter(EdgeArena *arena)
+{
+    EdgeArena *previous = t_currentArena;
+    t_currentArena = arena;
+    return previous;
+}
+
+void EdgeArenaLeave(EdgeArena *previous)
+{
+    t_currentArena = previous;
+}
+
+static bool arenaContains(const EdgeArena *arena, const void *ptr)
+{
+    for (const EdgeArenaBlock *block = arena->blocks; block; block = block->next)
+    {
+        const char *data = (const char *) block->data;
+        if ((const char *) ptr >= data && (const char *) ptr < data + block->used)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void *arenaAlloc(EdgeArena *arena, size_t size)
+{
+    if (size > SIZE_MAX - 2 * ARENA_ALIGNMENT)
+    {
+        return NULL;
+    }
+    size_t needed = ARENA_HEADER_SIZE + ARENA_ALIGN(size);
+
+    EdgeArenaBlock *block = arena->blocks;
+    if (block->size - block->used < needed)
+    {
+        size_t blockSize = (needed > arena->nextSize) ? needed : arena->nextSize;
+        block = (EdgeArenaBlock *) g_allocator.mallocFn(sizeof(EdgeArenaBlock) + blockSize);
+        VERIFY_NON_NULL_MSG(block, "malloc FAILED IN arenaAlloc\n", NULL);
+        MEMORY_TRACK(block, sizeof(EdgeArenaBlock) + blockSize, ARENA_TAG);
+        block->size = blockSize;
+        block->used = 0;
+        block->next = arena->blocks;
+        arena->blocks = block;
+        if (arena->nextSize <= SIZE_MAX / 2)
+        {
+            arena->nextSize *= 2;
+        }
+    }
+
+    char *header = (char *) block->data + block->used;
+    block->used += needed;
+    *(size_t *) header = size;
+    return header + ARENA_HEADER_SIZE;
+}
+
+static inline void *edgeMalloc(size_t size, const char *tag)
 {
     if (0 == size)
     {
@@ -34,10 +558,16 @@ void *EdgeMalloc(size_t size)
         return NULL;
     }
 
-    return malloc(size);
+    if (t_currentArena)
+    {
+        return arenaAlloc(t_currentArena, size);
+    }
+    void *ptr = g_allocator.mallocFn(size);
+    MEMORY_TRACK(ptr, size, tag);
+    return ptr;
 }
 
-void *EdgeCalloc(size_t num, size_t size)
+static inline void *edgeCalloc(size_t num, size_t size, const char *tag)
 {
     if (0 == size || 0 == num)
     {
@@ -45,31 +575,150 @@ void *EdgeCalloc(size_t num, size_t size)
         return NULL;
     }
 
-    return calloc(num, size);
+    if (t_currentArena)
+    {
+        if (num > SIZE_MAX / size)
+        {
+            return NULL;
+        }
+        void *ptr = arenaAlloc(t_currentArena, num * size);
+        if (ptr)
+        {
+            memset(ptr, 0, num * size);
+        }
+        return ptr;
+    }
+    void *ptr = g_allocator.callocFn(num, size);
+    MEMORY_TRACK(ptr, num * size, tag);
+    return ptr;
 }
 
-void *EdgeRealloc(void* ptr, size_t size)
+static inline void *edgeRealloc(void* ptr, size_t size, const char *tag)
 {
     // Override realloc() behavior for NULL pointer which normally would
     // work as per malloc(), however we suppress the behavior of possibly
     // returning a non-null unique pointer.
     if (NULL == ptr)
     {
-        return EdgeMalloc(size);
+        return edgeMalloc(size, tag);
+    }
+
+    // Arena memory cannot grow in place; it moves to a new allocation of the arena.
+    if (t_currentArena && arenaContains(t_currentArena, ptr))
+    {
+        size_t oldSize = *(size_t *) ((char *) ptr - ARENA_HEADER_SIZE);
+        void *moved = edgeMalloc(size, tag);
+        if (moved)
+        {
+            memcpy(moved, ptr, (oldSize < size) ? oldSize : size);
+        }
+        return moved;
     }
 
     // Otherwise leave the behavior up to realloc() itself:
-    return realloc(ptr, size);
+#ifdef EDGE_MEMORY_STATS
+    // ptr is untracked first, as another thread may be given its address once it is freed.
+    size_t oldSize = memoryUntrack(ptr);
+    void *resized = g_allocator.reallocFn(ptr, size);
+    if (resized)
+    {
+        memoryTrack(resized, size, tag);
+    }
+    else if (oldSize > 0)
+    {
+        memoryTrack(ptr, oldSize, tag);
+    }
+    return resized;
+#else
+    return g_allocator.reallocFn(ptr, size);
+#endif
+}
+
+void *EdgeMalloc(size_t size)
+{
+    return edgeMalloc(size, TAG);
 }
 
+void *EdgeCalloc(size_t num, size_t size)
+{
+    return edgeCalloc(num, size, TAG);
+}
+
+void *EdgeRealloc(void* ptr, size_t size)
+{
+    return edgeRealloc(ptr, size, TAG);
+}
+
+#ifdef EDGE_MEMORY_STATS
+void *EdgeMallocTag(size_t size, const char *tag)
+{
+    return edgeMalloc(size, tag);
+}
+
+void *EdgeCallocTag(size_t num, size_t size, const char *tag)
+{
+    return edgeCalloc(num, size, tag);
+}
+
+void *EdgeReallocTag(void *ptr, size_t size, const char *tag)
+{
+    return edgeRealloc(ptr, size, tag);
+}
+#endif
+
 void EdgeFree(void *ptr)
 {
     if (NULL != ptr)
     {
-        free(ptr);
+        // arena memory is released with the arena.
+        if (t_currentArena && arenaContains(t_currentArena, ptr))
+        {
+            return;
+        }
+        MEMORY_UNTRACK(ptr);
+        g_allocator.freeFn(ptr);
     }
 }
 
+bool EdgeSetAllocator(EdgeMallocFunction mallocFn, EdgeCallocFunction callocFn,
+        EdgeReallocFunction reallocFn, EdgeFreeFunction freeFn)
+{
+    EdgeAllocator allocator = { malloc, calloc, realloc, free };
+    if (mallocFn || callocFn || reallocFn || freeFn)
+    {
+        if (!mallocFn || !callocFn || !reallocFn || !freeFn)
+        {
+            EDGE_LOG(TAG, "Error : allocator functions must all be set or all be NULL");
+            return false;
+        }
+        allocator.mallocFn = mallocFn;
+        allocator.callocFn = callocFn;
+        allocator.reallocFn = reallocFn;
+        allocator.freeFn = freeFn;
+    }
+
+#ifndef UA_ENABLE_MALLOC_SINGLETON
+    if (mallocFn)
+    {
+        // open62541 keeps the C library allocator, its memory freed with EdgeFree would
+        // go to the wrong functions.
+        EDGE_LOG(TAG, "Error : open62541 is built without UA_ENABLE_MALLOC_SINGLETON");
+        return false;
+    }
+#endif
+
+    g_allocator = allocator;
+
+#ifdef UA_ENABLE_MALLOC_SINGLETON
+    // open62541 gets the functions themselves, so its memory never comes from an arena.
+    UA_globalMalloc = allocator.mallocFn;
+    UA_globalCalloc = allocator.callocFn;
+    UA_globalRealloc = allocator.reallocFn;
+    UA_globalFree = allocator.freeFn;
+#endif
+    return true;
+}
+
 Edge_String EdgeStringAlloc(char const src[])
 {
     const Edge_String EDGE_STRING_NULL = {0, NULL};
@@ -78,7 +727,7 @@ Edge_String EdgeStringAlloc(char const src[])
     Edge_String str;
     str.length = strlen(src);
     if(str.length > 0) {
-        str.data = (Edge_Byte*)malloc(str.length);
+        str.data = (Edge_Byte*)g_allocator.mallocFn(str.length);
         // Returns an empty Edge_String if memory allocated fails.
         VERIFY_NON_NULL_MSG(str.data, "EdgeMalloc FAILED IN EdgeStringAlloc\n", EDGE_STRING_NULL);
         memcpy(str.data, src, str.length);
@@ -22,6 +22,9 @@
 #include "edge_malloc.h"
 #include "edge_utils.h"
 
+#include <stdint.h>
+#include <string.h>
+
 #define TAG "edge_map"
 
 // USAGE
@@ -38,53 +41,179 @@
  deleteMap(X);
  */
 
-edgeMap *createMap()
+#define MAP_MIN_CAPACITY (16)
+
+static size_t hashKey(const edgeMap *map, keyValue key)
 {
-    edgeMap *map = (edgeMap *) EdgeMalloc(sizeof(edgeMap));
-    VERIFY_NON_NULL_MSG(map, "EdgeMalloc FAILED for create edge map\n", NULL);
-    map->head = NULL;
+    uint64_t hash;
+    if (map->stringKeys)
+    {
+        // FNV-1a
+        hash = 14695981039346656037ULL;
+        for (const unsigned char *c = (const unsigned char *) key; *c; c++)
+        {
+            hash ^= *c;
+            hash *= 1099511628211ULL;
+        }
+    }
+    else
+    {
+        // pointers are aligned, mix the low bits with the rest.
+        hash = (uint64_t) (uintptr_t) key;
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+    }
+    return (size_t) hash;
+}
+
+static bool keyEquals(const edgeMap *map, keyValue a, keyValue b)
+{
+    return a == b || (map->stringKeys && !strcmp((const char *) a, (const char *) b));
+}
+
+/* Slot of the node with the key, or the empty slot where it would be inserted. */
+static size_t findSlot(const edgeMap *map, keyValue key)
+{
+    size_t mask = map->capacity - 1;
+    size_t slot = hashKey(map, key) & mask;
+    while (map->slots[slot] && !keyEquals(map, map->slots[slot]->key, key))
+    {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+static bool growMap(edgeMap *map)
+{
+    size_t capacity = map->capacity ? map->capacity * 2 : MAP_MIN_CAPACITY;
+    edgeMapNode **slots = (edgeMapNode **) EdgeCalloc(capacity, sizeof(edgeMapNode *));
+    VERIFY_NON_NULL_MSG(slots, "EdgeCalloc FAILED for map slots\n", false);
+
+    EdgeFree(map->slots);
+    map->slots = slots;
+    map->capacity = capacity;
+    for (edgeMapNode *node = map->head; node != NULL; node = node->next)
+    {
+        map->slots[findSlot(map, node->key)] = node;
+    }
+    return true;
+}
+
+static edgeMap *newMap(bool stringKeys)
+{
+    edgeMap *map = (edgeMap *) EdgeCalloc(1, sizeof(edgeMap));
+    VERIFY_NON_NULL_MSG(map, "EdgeCalloc FAILED for create edge map\n", NULL);
+    map->stringKeys = stringKeys;
     return map;
 }
 
+edgeMap *createMap()
+{
+    return newMap(false);
+}
+
+edgeMap *createStringMap()
+{
+    return newMap(true);
+}
+
 void insertMapElement(edgeMap *map, keyValue key, keyValue value)
 {
+    VERIFY_NON_NULL_NR_MSG(map, "NULL map param in insertMapElement\n");
+
+    // keep the load factor below 3/4.
+    if ((map->count + 1) * 4 > map->capacity * 3 && !growMap(map))
+    {
+        return;
+    }
+
+    size_t slot = findSlot(map, key);
+    if (map->slots[slot])
+    {
+        map->slots[slot]->value = value;
+        return;
+    }
+
     edgeMapNode *node = (edgeMapNode *) EdgeMalloc(sizeof(edgeMapNode));
     VERIFY_NON_NULL_NR_MSG(node, "EdgeMalloc failed for insert map element\n");
     node->key = key;
     node->value = value;
     node->next = NULL;
+    node->prev = map->tail;
 
-    edgeMapNode *temp = map->head;
-
-    if (temp == NULL)
+    if (map->tail == NULL)
     {
         // Adding first node in the map.
         map->head = node;
     }
     else
     {
-        // Iterate till the end of the map and append.
-        while (temp->next != NULL)
-            temp = temp->next;
-
-        temp->next = node;
+        map->tail->next = node;
     }
+    map->tail = node;
+    map->slots[slot] = node;
+    map->count++;
 }
 
 keyValue getMapElement(edgeMap *map, keyValue key)
 {
-    edgeMapNode *temp = map->head;
+    if (IS_NULL(map) || 0 == map->count)
+    {
+        return NULL;
+    }
+    edgeMapNode *node = map->slots[findSlot(map, key)];
+    return node ? node->value : NULL;
+}
 
-    while (temp != NULL)
+edgeMapNode *removeMapElement(edgeMap *map, keyValue key)
+{
+    if (IS_NULL(map) || 0 == map->count)
     {
-        if (temp->key == key)
+        return NULL;
+    }
+
+    size_t mask = map->capacity - 1;
+    size_t slot = findSlot(map, key);
+    edgeMapNode *node = map->slots[slot];
+    if (IS_NULL(node))
+    {
+        return NULL;
+    }
+
+    // backward shift deletion: move the following nodes of the probe sequence into the hole.
+    map->slots[slot] = NULL;
+    for (size_t next = (slot + 1) & mask; map->slots[next]; next = (next + 1) & mask)
+    {
+        size_t home = hashKey(map, map->slots[next]->key) & mask;
+        if (((next - home) & mask) >= ((next - slot) & mask))
         {
-            return temp->value;
+            map->slots[slot] = map->slots[next];
+            map->slots[next] = NULL;
+            slot = next;
         }
-        temp = temp->next;
     }
 
-    return NULL;
+    if (node->prev)
+    {
+        node->prev->next = node->next;
+    }
+    else
+    {
+        map->head = node->next;
+    }
+    if (node->next)
+    {
+        node->next->prev = node->prev;
+    }
+    else
+    {
+        map->tail = node->prev;
+    }
+    node->next = NULL;
+    node->prev = NULL;
+    map->count--;
+    return node;
 }
 
 void deleteMap(edgeMap *map)
@@ -99,5 +228,10 @@ void deleteMap(edgeMap *map)
         temp = xtemp;
     }
 
+    EdgeFree(map->slots);
+    map->slots = NULL;
+    map->capacity = 0;
+    map->count = 0;
     map->head = NULL;
+    map->tail = NULL;
 }
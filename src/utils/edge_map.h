@@ -20,12 +20,16 @@
 
 /**
  * @file edge_map.h
- * @brief This file contains APIs for generic key-value pairs.
+ * @brief This file contains APIs for generic key-value pairs. Elements are kept in
+ *        insertion order in a list and found through an open-addressing hash index.
  */
 
 #ifndef EDGE_MAP_H_
 #define EDGE_MAP_H_
 
+#include <stddef.h>
+#include <stdbool.h>
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -47,6 +51,9 @@ typedef struct edgeMapNode
 
     /** Next node in list.*/
     struct edgeMapNode *next;
+
+    /** Previous node in list.*/
+    struct edgeMapNode *prev;
 } edgeMapNode;
 
 /**
@@ -57,17 +64,39 @@ typedef struct edgeMap
 {
     /** Map Head.*/
     edgeMapNode *head;
+
+    /** Map Tail.*/
+    edgeMapNode *tail;
+
+    /** Hash index of the nodes, open addressing with linear probing.*/
+    edgeMapNode **slots;
+
+    /** Number of slots, a power of two.*/
+    size_t capacity;
+
+    /** Number of elements.*/
+    size_t count;
+
+    /** true if keys are strings compared by content, false if compared by pointer.*/
+    bool stringKeys;
 } edgeMap;
 
 /**
- * @brief API for creating a map for storing edge nodes.
+ * @brief API for creating a map for storing edge nodes. Keys are compared by pointer.
  * @remarks This API will allocate memory required.
  * @return a pointer to the created map, otherwise a null pointer if the memory is insufficient.
  */
 edgeMap *createMap();
 
 /**
- * @brief Insert a key-value pair into the map.
+ * @brief API for creating a map whose keys are NUL-terminated strings compared by content.
+ * @remarks The map does not copy the keys; they must not change while in the map.
+ * @return a pointer to the created map, otherwise a null pointer if the memory is insufficient.
+ */
+edgeMap *createStringMap();
+
+/**
+ * @brief Insert a key-value pair into the map. The value of an existing key is replaced.
  * @param[in]  map Pointer to an edgeMap created using createMap().
  * @param[in]  key Generic key.
  * @param[in]  value Generic value.
@@ -82,6 +111,14 @@ void insertMapElement(edgeMap *map, keyValue key, keyValue value);
  */
 keyValue getMapElement(edgeMap *map, keyValue key);
 
+/**
+ * @brief Remove the element of the given key from the map.
+ * @param[in]  map Pointer to an edgeMap created using createMap().
+ * @param[in]  key Generic key.
+ * @return Removed node, to be freed with EdgeFree by the caller, otherwise null.
+ */
+edgeMapNode *removeMapElement(edgeMap *map, keyValue key);
+
 /**
  * @brief Delete and free memory used by the edge util map.
  * @param[in]  map Pointer to an edgeMap created using createMap().
@@ -348,7 +348,7 @@ void freeEdgeVersatilityByType(EdgeVersatility *versatileValue, int type)
         {
             freeEdgeNodeIdType((Edge_NodeId *)versatileValue->value);
         }
-        else
+        else if (EDGE_VERSATILITY_IS_EXTERNAL(versatileValue))
         {
             EdgeFree(versatileValue->value);
         }
@@ -380,6 +380,25 @@ bool isNodeClassValid(UA_NodeClass nodeClass)
     return valid;
 }
 
+bool isConnectionLost(UA_StatusCode status)
+{
+    switch (status)
+    {
+        case UA_STATUSCODE_BADCOMMUNICATIONERROR:
+        case UA_STATUSCODE_BADCONNECTIONCLOSED:
+        case UA_STATUSCODE_BADSECURECHANNELCLOSED:
+        case UA_STATUSCODE_BADSECURECHANNELIDINVALID:
+        case UA_STATUSCODE_BADSESSIONCLOSED:
+        case UA_STATUSCODE_BADSESSIONIDINVALID:
+        case UA_STATUSCODE_BADSERVERNOTCONNECTED:
+        case UA_STATUSCODE_BADNOTCONNECTED:
+        case UA_STATUSCODE_BADDISCONNECT:
+            return true;
+        default:
+            return false;
+    }
+}
+
 size_t get_size(int type, bool isArray)
 {
     size_t size = -1;
@@ -469,7 +488,9 @@ EdgeMessage* cloneEdgeMessage(EdgeMessage *msg)
     clone->command = msg->command;
     if(IS_NOT_NULL(msg->endpointInfo))
     {
-        clone->endpointInfo = cloneEdgeEndpointInfo(msg->endpointInfo);
+        // a shared endpoint info is referenced, one with a single owner is copied.
+        clone->endpointInfo = (msg->endpointInfo->refCount > 0) ?
+                shareEdgeEndpointInfo(msg->endpointInfo) : cloneEdgeEndpointInfo(msg->endpointInfo);
         if(IS_NULL(clone->endpointInfo))
         {
             goto ERROR;
@@ -478,6 +499,7 @@ EdgeMessage* cloneEdgeMessage(EdgeMessage *msg)
 
     clone->requestLength = msg->requestLength;
     clone->message_id = msg->message_id;
+    clone->priority = msg->priority;
 
     if (msg->browseParam)
     {
@@ -622,12 +644,10 @@ EdgeMessage* cloneEdgeMessage(EdgeMessage *msg)
                         }
                         else
                         {
-                            cloneVersatility->value = (void *) EdgeCalloc(1, size);
-                            if(IS_NULL(cloneVersatility->value))
+                            if(IS_NULL(setEdgeVersatilityScalar(cloneVersatility, val, size)))
                             {
                                 goto ERROR;
                             }
-                            memcpy(cloneVersatility->value, val, size);
                         }
                     }
                     else
@@ -97,6 +97,13 @@ void freeEdgeVersatilityByType(EdgeVersatility *versatileValue, int type);
  */
 bool isNodeClassValid(UA_NodeClass nodeClass);
 
+/**
+ * @brief Checks whether a service status means that the session to the server is gone.
+ * @param[in]  status Status of a service call.
+ * @return @c true if the connection, secure channel or session was lost, othewise @c false.
+ */
+bool isConnectionLost(UA_StatusCode status);
+
 /**
  * @brief Clones EdgeMessage object.
  * @remarks Allocated memory should be freed by the caller.
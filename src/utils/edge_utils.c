@@ -20,17 +20,28 @@
 
 #include "edge_utils.h"
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/time.h>
 #include <time.h>
+#include <pthread.h>
 
 #include "edge_open62541.h"
 #include "edge_logger.h"
 #include "edge_malloc.h"
+#include "edge_map.h"
+#include "edge_intern.h"
 
 #define TAG "edge_utils"
 
+#define MAX_ADDRESS_SIZE (512)
+#define SESSION_KEY_CACHE_SIZE (256)
+
+/* Session keys of the endpoint uris seen so far, both interned. Entries are never removed. */
+static edgeMap *g_sessionKeyCache = NULL;
+static pthread_rwlock_t sessionKeyCacheLock = PTHREAD_RWLOCK_INITIALIZER;
+
 void logCurrentTimeStamp()
 {
 #if DEBUG
@@ -248,11 +259,14 @@ EdgeApplicationConfig *cloneEdgeApplicationConfig(EdgeApplicationConfig *config)
         }
     }
 
-    clone->discoveryUrlsSize = config->discoveryUrlsSize;
-    clone->discoveryUrls = (char **) EdgeCalloc(config->discoveryUrlsSize, sizeof(char *));
-    if (!clone->discoveryUrls)
+    if (config->discoveryUrlsSize > 0)
     {
-        goto ERROR;
+        clone->discoveryUrls = (char **) EdgeCalloc(config->discoveryUrlsSize, sizeof(char *));
+        if (!clone->discoveryUrls)
+        {
+            goto ERROR;
+        }
+        clone->discoveryUrlsSize = config->discoveryUrlsSize;
     }
 
     for (size_t i = 0; i < clone->discoveryUrlsSize; ++i)
@@ -273,9 +287,29 @@ EdgeApplicationConfig *cloneEdgeApplicationConfig(EdgeApplicationConfig *config)
     return NULL;
 }
 
+/* Drops a reference to the endpoint info, returns true if the members have to be freed. */
+static bool releaseEdgeEndpointInfo(EdgeEndPointInfo *endpointInfo)
+{
+    uint32_t count = __atomic_load_n(&endpointInfo->refCount, __ATOMIC_ACQUIRE);
+    while (count > 1)
+    {
+        if (__atomic_compare_exchange_n(&endpointInfo->refCount, &count, count - 1, false,
+                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            return false;
+        }
+    }
+    // single owner, or the last reference of a shared endpoint info.
+    return true;
+}
+
 void freeEdgeEndpointInfo(EdgeEndPointInfo *endpointInfo)
 {
-    VERIFY_NON_NULL_NR_MSG(endpointInfo, "NULL param endpointinfo in cloneEdgeEndpointInfo\n");
+    VERIFY_NON_NULL_NR_MSG(endpointInfo, "NULL param endpointinfo in freeEdgeEndpointInfo\n");
+    if (!releaseEdgeEndpointInfo(endpointInfo))
+    {
+        return;
+    }
     EdgeFree(endpointInfo->endpointUri);
     freeEdgeEndpointConfig(endpointInfo->endpointConfig);
     freeEdgeApplicationConfig(endpointInfo->appConfig);
@@ -291,6 +325,7 @@ EdgeEndPointInfo *cloneEdgeEndpointInfo(EdgeEndPointInfo *endpointInfo)
     VERIFY_NON_NULL_MSG(clone, "EdgeCalloc failed for clone in cloneEdgeEndpointInfo\n", NULL);
     clone->securityMode = endpointInfo->securityMode;
     clone->securityLevel = endpointInfo->securityLevel;
+    clone->sessionId = endpointInfo->sessionId;
 
     if (endpointInfo->endpointUri)
     {
@@ -343,6 +378,24 @@ EdgeEndPointInfo *cloneEdgeEndpointInfo(EdgeEndPointInfo *endpointInfo)
     return NULL;
 }
 
+EdgeEndPointInfo *shareEdgeEndpointInfo(EdgeEndPointInfo *endpointInfo)
+{
+    VERIFY_NON_NULL_MSG(endpointInfo, "NULL param endpointinfo in shareEdgeEndpointInfo\n", NULL);
+    if (__atomic_load_n(&endpointInfo->refCount, __ATOMIC_ACQUIRE) > 0)
+    {
+        __atomic_add_fetch(&endpointInfo->refCount, 1, __ATOMIC_RELAXED);
+        return endpointInfo;
+    }
+
+    // a shared endpoint info outlives the message arena it is referenced from.
+    EdgeArena *previous = EdgeArenaEnter(NULL);
+    EdgeEndPointInfo *shared = cloneEdgeEndpointInfo(endpointInfo);
+    EdgeArenaLeave(previous);
+    VERIFY_NON_NULL_MSG(shared, "cloneEdgeEndpointInfo failed in shareEdgeEndpointInfo\n", NULL);
+    shared->refCount = 1;
+    return shared;
+}
+
 void freeEdgeBrowseResult(EdgeBrowseResult *browseResult, int browseResultLength)
 {
     VERIFY_NON_NULL_NR_MSG(browseResult, "NULL param browse result in freeEdgeBrowseResult\n");
@@ -417,10 +470,31 @@ void freeEdgeRequests(EdgeRequest **requests, int requestLength)
 void freeEdgeVersatility(EdgeVersatility *versatileValue)
 {
     VERIFY_NON_NULL_NR_MSG(versatileValue, "NULL param versatileValue in freeEdgeVersatility\n");
-    EdgeFree(versatileValue->value);
+    if (EDGE_VERSATILITY_IS_EXTERNAL(versatileValue))
+    {
+        EdgeFree(versatileValue->value);
+    }
     EdgeFree(versatileValue);
 }
 
+void *setEdgeVersatilityScalar(EdgeVersatility *versatileValue, const void *data, size_t size)
+{
+    VERIFY_NON_NULL_MSG(versatileValue, "NULL param versatileValue in setEdgeVersatilityScalar\n",
+            NULL);
+    if (size <= EDGE_VERSATILITY_INLINE_SIZE)
+    {
+        versatileValue->value = &versatileValue->inlineValue;
+    }
+    else
+    {
+        versatileValue->value = EdgeMalloc(size);
+        VERIFY_NON_NULL_MSG(versatileValue->value,
+                "EdgeMalloc FAILED for value in setEdgeVersatilityScalar\n", NULL);
+    }
+    memcpy(versatileValue->value, data, size);
+    return versatileValue->value;
+}
+
 void freeEdgeQualifiedName(Edge_QualifiedName *qn)
 {
     VERIFY_NON_NULL_NR_MSG(qn, "Input argument is NULL");
@@ -476,6 +550,12 @@ void freeEdgeResponses(EdgeResponse **responses, int responseLength)
 void freeEdgeMessage(EdgeMessage *msg)
 {
     VERIFY_NON_NULL_NR_MSG(msg, "NULL param EdgeMessage in freeEdgeMessage\n");
+
+    // Members taken from the arena are skipped by EdgeFree and released with it;
+    // members attached from the heap are still freed one by one.
+    EdgeArena *arena = msg->arena;
+    EdgeArena *previous = EdgeArenaEnter(arena);
+
     if(IS_NOT_NULL(msg->endpointInfo))
         freeEdgeEndpointInfo(msg->endpointInfo);
 
@@ -501,6 +581,9 @@ void freeEdgeMessage(EdgeMessage *msg)
         freeEdgeContinuationPointList(msg->cpList);
 
     EdgeFree(msg);
+
+    EdgeArenaLeave(previous);
+    EdgeArenaDestroy(arena);
 }
 
 EdgeResult *createEdgeResult(EdgeStatusCode code)
@@ -610,3 +693,97 @@ EdgeNodeIdType getEdgeNodeIdType(char type)
     }
     return edgeNodeType;
 }
+
+char *getSessionKey(const char *endpointUri)
+{
+    VERIFY_NON_NULL_MSG(endpointUri, "NULL endpointUri param in getSessionKey\n", NULL);
+
+    UA_String hostName = UA_STRING_NULL, path = UA_STRING_NULL;
+    UA_UInt16 port = 0;
+    UA_String endpointUrlString = UA_STRING((char *) (uintptr_t) endpointUri);
+
+    UA_StatusCode parse_retval = UA_parseEndpointUrl(&endpointUrlString, &hostName, &port, &path);
+    if (parse_retval != UA_STATUSCODE_GOOD || hostName.length >= MAX_ADDRESS_SIZE)
+    {
+        EDGE_LOG(TAG, "Server URL is invalid. Unable to get session key\n");
+        return NULL;
+    }
+
+    char addr_port[MAX_ADDRESS_SIZE];
+    int written = snprintf(addr_port, MAX_ADDRESS_SIZE, "%.*s:%d", (int) hostName.length,
+            (char *) hostName.data, port);
+    if (written <= 0 || written >= MAX_ADDRESS_SIZE)
+    {
+        return NULL;
+    }
+    return cloneString(addr_port);
+}
+
+/* Should be called with sessionKeyCacheLock held for writing. */
+static const char *addCachedSessionKey(const char *endpointUri)
+{
+    if (IS_NULL(g_sessionKeyCache))
+    {
+        g_sessionKeyCache = createStringMap();
+        VERIFY_NON_NULL_MSG(g_sessionKeyCache, "createStringMap FAILED in addCachedSessionKey\n", NULL);
+    }
+    if (g_sessionKeyCache->count >= SESSION_KEY_CACHE_SIZE)
+    {
+        EDGE_LOG(TAG, "Session key cache is full\n");
+        return NULL;
+    }
+
+    char *sessionKey = getSessionKey(endpointUri);
+    VERIFY_NON_NULL_MSG(sessionKey, "NULL session key in addCachedSessionKey\n", NULL);
+    const char *uri = EdgeInternString(endpointUri);
+    const char *key = EdgeInternString(sessionKey);
+    EdgeFree(sessionKey);
+    if (IS_NULL(uri) || IS_NULL(key))
+    {
+        EDGE_LOG(TAG, "EdgeInternString FAILED in addCachedSessionKey\n");
+        goto ERROR;
+    }
+
+    insertMapElement(g_sessionKeyCache, (keyValue) uri, (keyValue) key);
+    if (key != getMapElement(g_sessionKeyCache, (keyValue) uri))
+    {
+        goto ERROR;
+    }
+    return key;
+
+ERROR:
+    if (uri)
+    {
+        EdgeInternRelease(uri);
+    }
+    if (key)
+    {
+        EdgeInternRelease(key);
+    }
+    return NULL;
+}
+
+const char *getCachedSessionKey(const char *endpointUri)
+{
+    VERIFY_NON_NULL_MSG(endpointUri, "NULL endpointUri param in getCachedSessionKey\n", NULL);
+
+    pthread_rwlock_rdlock(&sessionKeyCacheLock);
+    const char *key = (const char *) getMapElement(g_sessionKeyCache, (keyValue) endpointUri);
+    pthread_rwlock_unlock(&sessionKeyCacheLock);
+    if (key)
+    {
+        return key;
+    }
+
+    // the cache outlives the message arena of the caller.
+    EdgeArena *previous = EdgeArenaEnter(NULL);
+    pthread_rwlock_wrlock(&sessionKeyCacheLock);
+    key = (const char *) getMapElement(g_sessionKeyCache, (keyValue) endpointUri);
+    if (IS_NULL(key))
+    {
+        key = addCachedSessionKey(endpointUri);
+    }
+    pthread_rwlock_unlock(&sessionKeyCacheLock);
+    EdgeArenaLeave(previous);
+    return key;
+}
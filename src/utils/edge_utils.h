@@ -34,7 +34,7 @@ extern "C"
 {
 #endif
 
-#define FREE(arg) if(arg) {free(arg); arg=NULL; }
+#define FREE(arg) if(arg) {EdgeFree(arg); arg=NULL; }
 
 #define IS_NULL(arg) ((arg == NULL) ? true : false)
 #define IS_NOT_NULL(arg) ((arg != NULL) ? true : false)
@@ -111,6 +111,7 @@ void freeEdgeApplicationConfig(EdgeApplicationConfig *config);
 
 /**
  * @brief De-allocates the memory consumed by EdgeEndPointInfo and its members.
+ *        For a shared EdgeEndPointInfo, only the last reference frees it.
  * @remarks Both EdgeEndPointInfo and its members should have been allocated dynamically.
  * @param[in]  endpointInfo Pointer to EdgeEndPointInfo which needs to be freed.
  */
@@ -174,6 +175,16 @@ void freeEdgeRequests(EdgeRequest **requests, int requestLength);
  */
 void freeEdgeVersatility(EdgeVersatility *versatileValue);
 
+/**
+ * @brief Copies a scalar value into EdgeVersatility. Values up to EDGE_VERSATILITY_INLINE_SIZE
+ *        bytes are stored inline, larger ones are allocated.
+ * @param[in]  versatileValue EdgeVersatility to hold the value.
+ * @param[in]  data Value to be copied.
+ * @param[in]  size Size of the value.
+ * @return versatileValue->value on success. Otherwise null.
+ */
+void *setEdgeVersatilityScalar(EdgeVersatility *versatileValue, const void *data, size_t size);
+
 /**
  * @brief De-allocates the memory consumed by EdgeResponse and its members.
  * @remarks Both EdgeResponse and its members should have been allocated dynamically.
@@ -249,6 +260,16 @@ EdgeApplicationConfig *cloneEdgeApplicationConfig(EdgeApplicationConfig *config)
  */
 EdgeEndPointInfo *cloneEdgeEndpointInfo(EdgeEndPointInfo *endpointInfo);
 
+/**
+ * @brief Takes a reference to a shared EdgeEndPointInfo object. An endpoint info with a single
+ *        owner is first cloned into a new shared object on the heap.
+ * @remarks Each reference is given back with freeEdgeEndpointInfo. The object is immutable
+ *          while it is shared.
+ * @param[in]  endpointInfo EdgeEndPointInfo object to be shared.
+ * @return Shared EdgeEndPointInfo object on success. Otherwise null.
+ */
+EdgeEndPointInfo *shareEdgeEndpointInfo(EdgeEndPointInfo *endpointInfo);
+
 /**
  * @brief Creates an EdgeResult object with the given status code.
  * @remarks Allocated memory should be freed by the caller.
@@ -280,6 +301,23 @@ EdgeNodeInfo *cloneEdgeNodeInfo(EdgeNodeInfo *nodeInfo);
  */
 EdgeNodeIdType getEdgeNodeIdType(char type);
 
+/**
+ * @brief Gets the "host:port" key which identifies the session of an endpoint.
+ * @remarks Allocated memory should be freed by the caller.
+ * @param[in]  endpointUri Endpoint URI, e.g. opc.tcp://localhost:12686/edge-opc-server.
+ * @return Session key on success. Otherwise null.
+ */
+char *getSessionKey(const char *endpointUri);
+
+/**
+ * @brief Gets the session key of an endpoint, parsing each endpoint URI only once.
+ * @remarks The key is interned and kept for the lifetime of the process. It must not be freed
+ *          or released. A bounded number of endpoint URIs is cached.
+ * @param[in]  endpointUri Endpoint URI, e.g. opc.tcp://localhost:12686/edge-opc-server.
+ * @return Session key on success. Null if the URI is invalid or the cache is full.
+ */
+const char *getCachedSessionKey(const char *endpointUri);
+
 #ifdef __cplusplus
 }
 #endif
@@ -104,6 +104,7 @@ extern void testRead_P2(char *endpointUri);
 extern void testRead_P3(char *endpointUri);
 extern void testRead_P4(char *endpointUri);
 extern void testRead_P5(char *endpointUri);
+extern void testReadSync_P(char *endpointUri);
 extern void testReadWithoutEndpoint();
 extern void testReadWithoutValueAlias(char *endpointUri);
 extern void testReadWithoutMessage();
@@ -763,7 +764,7 @@ static void configureCallbacks()
     PRINT("-----INITIALIZING CALLBACKS-----");
 
     EXPECT_EQ(NULL == config, true);
-    config = (EdgeConfigure *) EdgeMalloc(sizeof(EdgeConfigure));
+    config = (EdgeConfigure *) EdgeCalloc(1, sizeof(EdgeConfigure));
     EXPECT_EQ(NULL == config, false);
 
     config->recvCallback = (ReceivedMessageCallback *) EdgeMalloc(sizeof(ReceivedMessageCallback));
@@ -3115,6 +3116,46 @@ TEST_F(OPC_clientTests , FindServers_P3)
     EdgeFree(registeredServers);
 }
 
+TEST_F(OPC_clientTests , FindServers_Cached_P)
+{
+    config->discoveryCacheTtlMs = 60000;
+    configure(config);
+
+    size_t registeredServersSize[3] = {0};
+    EdgeApplicationConfig *registeredServers[3] = {NULL};
+    for (int i = 0; i < 3; ++i)
+    {
+        if (2 == i)
+        {
+            // The next lookup asks the server again.
+            invalidateDiscoveryCache(endpointUri);
+        }
+        EdgeResult res = findServers(endpointUri, 0, NULL, 0, NULL, &registeredServersSize[i], &registeredServers[i]);
+        EXPECT_EQ(res.code, STATUS_OK);
+    }
+
+    // Each call gets its own copy of the result.
+    EXPECT_EQ(registeredServersSize[0], registeredServersSize[1]);
+    EXPECT_EQ(registeredServersSize[0], registeredServersSize[2]);
+    for (size_t idx = 0; idx < registeredServersSize[0] ; ++idx)
+    {
+        EXPECT_EQ(strcmp(registeredServers[0][idx].applicationUri, registeredServers[1][idx].applicationUri), 0);
+        EXPECT_NE(registeredServers[0][idx].applicationUri, registeredServers[1][idx].applicationUri);
+    }
+
+    for (int i = 0; i < 3; ++i)
+    {
+        for(size_t idx = 0; idx < registeredServersSize[i] ; ++idx)
+        {
+            destroyEdgeApplicationConfigMembers(&registeredServers[i][idx]);
+        }
+        EdgeFree(registeredServers[i]);
+    }
+
+    config->discoveryCacheTtlMs = 0;
+    configure(config);
+}
+
 TEST_F(OPC_clientTests , FindServers_N1)
 {
     // Invalid Endpoint
@@ -3364,6 +3405,26 @@ TEST_F(OPC_clientTests , ClientRead_P5)
     EXPECT_EQ(startClientFlag, false);
 }
 
+TEST_F(OPC_clientTests , ClientReadSync_P)
+{
+    EXPECT_EQ(startClientFlag, false);
+
+    EdgeMessage *msg = createEdgeMessage(endpointUri, 1, CMD_GET_ENDPOINTS);
+    EXPECT_EQ(NULL != msg, true);
+
+    EdgeResult res = getEndpointInfo(msg);
+    EXPECT_EQ(res.code, STATUS_OK);
+
+    EXPECT_EQ(startClientFlag, true);
+
+    destroyEdgeMessage(msg);
+
+    testReadSync_P(endpointUri);
+
+    stop_client();
+    EXPECT_EQ(startClientFlag, false);
+}
+
 TEST_F(OPC_clientTests , ClientRead_N1)
 {
     EXPECT_EQ(startClientFlag, false);
@@ -0,0 +1,1094 @@
+/* ****************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 = the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include <gtest/gtest.h>
+#include <iostream>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+extern "C"
+{
+#include "cathreadpool.h"
+#include "caqueueingthread.h"
+#include "umpscqueue.h"
+#include "calanedispatcher.h"
+#include "cahistogram.h"
+}
+
+#define PRINT(str) std::cout<<str<<std::endl
+
+#define POOL_SIZE               20
+#define BENCHMARK_TASK_COUNT    20000
+#define PRODUCER_COUNT          4
+#define PRODUCER_MESSAGE_COUNT  10000
+#define LANE_COUNT              8
+#define LANE_MESSAGE_COUNT      1000
+
+static volatile int taskCounter = 0;
+
+static void countingTask(void *data)
+{
+    (void) data;
+    __sync_fetch_and_add(&taskCounter, 1);
+}
+
+static int getTaskCounter()
+{
+    return __sync_fetch_and_add(&taskCounter, 0);
+}
+
+static void *countingThread(void *data)
+{
+    countingTask(data);
+    return NULL;
+}
+
+static ca_thread_pool_t stealingPool = NULL;
+
+static void spawningTask(void *data)
+{
+    (void) data;
+    for (int i = 0; i < 10; i++)
+    {
+        ca_thread_pool_add_task(stealingPool, countingTask, NULL, NULL);
+    }
+}
+
+static volatile bool spawnedTasksStolen = false;
+
+// Keeps its worker busy until the tasks it queued locally were run by the others.
+static void blockingSpawningTask(void *data)
+{
+    spawningTask(data);
+    for (int i = 0; i < 500 && getTaskCounter() < 10; i++)
+    {
+        usleep(10000);
+    }
+    spawnedTasksStolen = (getTaskCounter() == 10);
+}
+
+static double elapsedSeconds(const struct timespec *start)
+{
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+class OPC_threadPool: public ::testing::Test
+{
+protected:
+
+    virtual void SetUp()
+    {
+        PRINT("THREAD POOL TESTS");
+        taskCounter = 0;
+    }
+
+    virtual void TearDown()
+    {
+
+    }
+
+};
+
+TEST_F(OPC_threadPool , init_N)
+{
+    ca_thread_pool_t pool = NULL;
+    EXPECT_EQ(ca_thread_pool_init(0, &pool), CA_STATUS_INVALID_PARAM);
+    EXPECT_EQ(ca_thread_pool_init(POOL_SIZE, NULL), CA_STATUS_INVALID_PARAM);
+    EXPECT_EQ(pool == NULL, true);
+}
+
+TEST_F(OPC_threadPool , addTask_N)
+{
+    ca_thread_pool_t pool = NULL;
+    ASSERT_EQ(ca_thread_pool_init(1, &pool), CA_STATUS_OK);
+    EXPECT_EQ(ca_thread_pool_add_task(NULL, countingTask, NULL, NULL), CA_STATUS_INVALID_PARAM);
+    EXPECT_EQ(ca_thread_pool_add_task(pool, NULL, NULL, NULL), CA_STATUS_INVALID_PARAM);
+    ca_thread_pool_free(pool);
+}
+
+TEST_F(OPC_threadPool , removeTask_P)
+{
+    ca_thread_pool_t pool = NULL;
+    ASSERT_EQ(ca_thread_pool_init(2, &pool), CA_STATUS_OK);
+
+    uint32_t taskId = 0;
+    ASSERT_EQ(ca_thread_pool_add_task(pool, countingTask, NULL, &taskId), CA_STATUS_OK);
+    EXPECT_EQ(ca_thread_pool_remove_task(pool, taskId), CA_STATUS_OK);
+    EXPECT_EQ(taskCounter, 1);
+
+    ca_thread_pool_free(pool);
+}
+
+TEST_F(OPC_threadPool , freeRunsPendingTasks_P)
+{
+    ca_thread_pool_t pool = NULL;
+    ASSERT_EQ(ca_thread_pool_init(1, &pool), CA_STATUS_OK);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        ASSERT_EQ(ca_thread_pool_add_task(pool, countingTask, NULL, NULL), CA_STATUS_OK);
+    }
+    ca_thread_pool_free(pool);
+
+    EXPECT_EQ(taskCounter, 1000);
+}
+
+TEST_F(OPC_threadPool , workStealing_P)
+{
+    ASSERT_EQ(ca_thread_pool_init_ex(4, true, &stealingPool), CA_STATUS_OK);
+
+    for (int i = 0; i < 100; i++)
+    {
+        ASSERT_EQ(ca_thread_pool_add_task(stealingPool, spawningTask, NULL, NULL), CA_STATUS_OK);
+    }
+    ca_thread_pool_free(stealingPool);
+    stealingPool = NULL;
+
+    EXPECT_EQ(taskCounter, 1000);
+}
+
+TEST_F(OPC_threadPool , workStealingBusyOwner_P)
+{
+    spawnedTasksStolen = false;
+    ASSERT_EQ(ca_thread_pool_init_ex(4, true, &stealingPool), CA_STATUS_OK);
+
+    ASSERT_EQ(ca_thread_pool_add_task(stealingPool, blockingSpawningTask, NULL, NULL), CA_STATUS_OK);
+    ca_thread_pool_free(stealingPool);
+    stealingPool = NULL;
+
+    EXPECT_EQ(spawnedTasksStolen, true);
+    EXPECT_EQ(taskCounter, 10);
+}
+
+TEST_F(OPC_threadPool , throughputBenchmark_P)
+{
+    struct timespec start;
+
+    // Thread per task, which is what ca_thread_pool_add_task used to do.
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < BENCHMARK_TASK_COUNT; i += POOL_SIZE)
+    {
+        pthread_t threads[POOL_SIZE];
+        for (int j = 0; j < POOL_SIZE; j++)
+        {
+            ASSERT_EQ(pthread_create(&threads[j], NULL, countingThread, NULL), 0);
+        }
+        for (int j = 0; j < POOL_SIZE; j++)
+        {
+            pthread_join(threads[j], NULL);
+        }
+    }
+    double threadPerTask = elapsedSeconds(&start);
+    ASSERT_EQ(taskCounter, BENCHMARK_TASK_COUNT);
+
+    taskCounter = 0;
+    ca_thread_pool_t pool = NULL;
+    ASSERT_EQ(ca_thread_pool_init(POOL_SIZE, &pool), CA_STATUS_OK);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < BENCHMARK_TASK_COUNT; i++)
+    {
+        ASSERT_EQ(ca_thread_pool_add_task(pool, countingTask, NULL, NULL), CA_STATUS_OK);
+    }
+    ca_thread_pool_free(pool);
+    double pooled = elapsedSeconds(&start);
+    ASSERT_EQ(taskCounter, BENCHMARK_TASK_COUNT);
+
+    PRINT("thread per task : " << (int) (BENCHMARK_TASK_COUNT / threadPerTask) << " tasks/s");
+    PRINT("thread pool     : " << (int) (BENCHMARK_TASK_COUNT / pooled) << " tasks/s");
+}
+
+static int producerValue = 1;
+
+static void *producerThread(void *data)
+{
+    CAQueueingThread_t *thread = (CAQueueingThread_t *) data;
+    for (int i = 0; i < PRODUCER_MESSAGE_COUNT; i++)
+    {
+        while (CA_STATUS_OK != CAQueueingThreadAddData(thread, &producerValue, sizeof(int)))
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void noDestroy(void *data, uint32_t size)
+{
+    (void) data;
+    (void) size;
+}
+
+class OPC_mpscQueue: public ::testing::Test
+{
+protected:
+
+    virtual void SetUp()
+    {
+        PRINT("MPSC QUEUE TESTS");
+        taskCounter = 0;
+    }
+
+    virtual void TearDown()
+    {
+
+    }
+
+};
+
+TEST_F(OPC_mpscQueue , create_N)
+{
+    EXPECT_EQ(u_mpsc_queue_create(0) == NULL, true);
+}
+
+TEST_F(OPC_mpscQueue , capacityRoundsUp_P)
+{
+    u_mpsc_queue_t *queue = u_mpsc_queue_create(5);
+    ASSERT_EQ(queue != NULL, true);
+    EXPECT_EQ(u_mpsc_queue_get_capacity(queue), 8);
+    u_mpsc_queue_delete(queue);
+}
+
+TEST_F(OPC_mpscQueue , pushPopFull_P)
+{
+    u_mpsc_queue_t *queue = u_mpsc_queue_create(4);
+    ASSERT_EQ(queue != NULL, true);
+
+    int values[5] = { 0, 1, 2, 3, 4 };
+    void *msg = NULL;
+    uint32_t size = 0;
+    EXPECT_EQ(u_mpsc_queue_pop(queue, &msg, &size), false);
+
+    for (int round = 0; round < 3; round++)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            EXPECT_EQ(u_mpsc_queue_push(queue, &values[i], i + 1), true);
+        }
+        EXPECT_EQ(u_mpsc_queue_push(queue, &values[4], 5), false);
+        EXPECT_EQ(u_mpsc_queue_get_size(queue), 4);
+
+        for (int i = 0; i < 4; i++)
+        {
+            EXPECT_EQ(u_mpsc_queue_pop(queue, &msg, &size), true);
+            EXPECT_EQ(msg, (void *) &values[i]);
+            EXPECT_EQ(size, (uint32_t) (i + 1));
+        }
+        EXPECT_EQ(u_mpsc_queue_pop(queue, &msg, &size), false);
+    }
+
+    u_mpsc_queue_delete(queue);
+}
+
+TEST_F(OPC_mpscQueue , queueingThreadMultiProducer_P)
+{
+    ca_thread_pool_t pool = NULL;
+    ASSERT_EQ(ca_thread_pool_init(1, &pool), CA_STATUS_OK);
+
+    CAQueueingThread_t thread;
+    ASSERT_EQ(CAQueueingThreadInitializeWithCapacity(&thread, pool, countingTask, noDestroy, 64),
+            CA_STATUS_OK);
+    ASSERT_EQ(CAQueueingThreadStart(&thread), CA_STATUS_OK);
+
+    pthread_t producers[PRODUCER_COUNT];
+    for (int i = 0; i < PRODUCER_COUNT; i++)
+    {
+        ASSERT_EQ(pthread_create(&producers[i], NULL, producerThread, &thread), 0);
+    }
+    for (int i = 0; i < PRODUCER_COUNT; i++)
+    {
+        pthread_join(producers[i], NULL);
+    }
+
+    while (getTaskCounter() < PRODUCER_COUNT * PRODUCER_MESSAGE_COUNT)
+    {
+        sched_yield();
+    }
+
+    CAQueueingThreadStop(&thread);
+    ca_thread_pool_free(pool);
+    CAQueueingThreadDestroy(&thread);
+
+    EXPECT_EQ(taskCounter, PRODUCER_COUNT * PRODUCER_MESSAGE_COUNT);
+}
+
+typedef struct
+{
+    int lane;
+    int sequence;
+} laneData;
+
+static int laneSequence[LANE_COUNT];
+static volatile int laneOrderErrors = 0;
+static volatile int slowLaneReleased = 0;
+
+static void laneTask(void *data)
+{
+    laneData *item = (laneData *) data;
+    if (laneSequence[item->lane] != item->sequence - 1)
+    {
+        __sync_fetch_and_add(&laneOrderErrors, 1);
+    }
+    laneSequence[item->lane] = item->sequence;
+    countingTask(data);
+}
+
+static int slowLaneMarker = 0;
+
+static void mixedLaneTask(void *data)
+{
+    if (data == &slowLaneMarker)
+    {
+        // the slow lane only finishes once the fast lane has processed everything.
+        while (!__sync_fetch_and_add(&slowLaneReleased, 0))
+        {
+            sched_yield();
+        }
+        countingTask(data);
+        return;
+    }
+
+    countingTask(data);
+    if (getTaskCounter() == LANE_MESSAGE_COUNT - 1)
+    {
+        __sync_fetch_and_add(&slowLaneReleased, 1);
+    }
+}
+
+static void laneDestroy(void *data, uint32_t size)
+{
+    (void) size;
+    delete (laneData *) data;
+}
+
+class OPC_laneDispatcher: public ::testing::Test
+{
+protected:
+
+    virtual void SetUp()
+    {
+        PRINT("LANE DISPATCHER TESTS");
+        taskCounter = 0;
+        laneOrderErrors = 0;
+        slowLaneReleased = 0;
+        memset(laneSequence, 0, sizeof(laneSequence));
+    }
+
+    virtual void TearDown()
+    {
+
+    }
+
+};
+
+TEST_F(OPC_laneDispatcher , init_N)
+{
+    ca_thread_pool_t pool = NULL;
+    ASSERT_EQ(ca_thread_pool_init(1, &pool), CA_STATUS_OK);
+
+    CALaneDispatcher_t dispatcher;
+    EXPECT_EQ(CALaneDispatcherInitialize(NULL, pool, 1, countingTask, noDestroy),
+            CA_STATUS_INVALID_PARAM);
+    EXPECT_EQ(CALaneDispatcherInitialize(&dispatcher, NULL, 1, countingTask, noDestroy),
+            CA_STATUS_INVALID_PARAM);
+    EXPECT_EQ(CALaneDispatcherInitialize(&dispatcher, pool, 0, countingTask, noDestroy),
+            CA_STATUS_INVALID_PARAM);
+
+    ASSERT_EQ(CALaneDispatcherInitialize(&dispatcher, pool, 1, countingTask, noDestroy),
+            CA_STATUS_OK);
+    EXPECT_EQ(CALaneDispatcherAddData(&dispatcher, NULL, &producerValue, sizeof(int)),
+            CA_STATUS_INVALID_PARAM);
+    EXPECT_EQ(CALaneDispatcherAddData(&dispatcher, "lane", NULL, sizeof(int)),
+            CA_STATUS_INVALID_PARAM);
+
+    CALaneDispatcherStop(&dispatcher);
+    EXPECT_EQ(CALaneDispatcherAddData(&dispatcher, "lane", &producerValue, sizeof(int)),
+            CA_STATUS_FAILED);
+    ca_thread_pool_free(pool);
+    CALaneDispatcherDestroy(&dispatcher);
+}
+
+TEST_F(OPC_laneDispatcher , orderPerLane_P)
+{
+    ca_thread_pool_t pool = NULL;
+    ASSERT_EQ(ca_thread_pool_init(4, &pool), CA_STATUS_OK);
+
+    CALaneDispatcher_t dispatcher;
+    ASSERT_EQ(CALaneDispatcherInitialize(&dispatcher, pool, 4, laneTask, laneDestroy),
+            CA_STATUS_OK);
+
+    for (int i = 1; i <= LANE_MESSAGE_COUNT; i++)
+    {
+        for (int lane = 0; lane < LANE_COUNT; lane++)
+        {
+            char key[16];
+            snprintf(key, sizeof(key), "lane%d", lane);
+            laneData *item = new laneData;
+            item->lane = lane;
+            item->sequence = i;
+            ASSERT_EQ(CALaneDispatcherAddData(&dispatcher, key, item, sizeof(laneData)),
+                    CA_STATUS_OK);
+        }
+    }
+
+    while (getTaskCounter() < LANE_COUNT * LANE_MESSAGE_COUNT)
+    {
+        sched_yield();
+    }
+
+    CALaneDispatcherStop(&dispatcher);
+    // the lanes are freed once they are empty.
+    EXPECT_EQ(dispatcher.lanes->count, 0u);
+    ca_thread_pool_free(pool);
+    CALaneDispatcherDestroy(&dispatcher);
+
+    EXPECT_EQ(laneOrderErrors, 0);
+    for (int lane = 0; lane < LANE_COUNT; lane++)
+    {
+        EXPECT_EQ(laneSequence[lane], LANE_MESSAGE_COUNT);
+    }
+}
+
+TEST_F(OPC_laneDispatcher , slowLaneDoesNotBlockOthers_P)
+{
+    ca_thread_pool_t pool = NULL;
+    ASSERT_EQ(ca_thread_pool_init(2, &pool), CA_STATUS_OK);
+
+    CALaneDispatcher_t dispatcher;
+    ASSERT_EQ(CALaneDispatcherInitialize(&dispatcher, pool, 2, mixedLaneTask, noDestroy),
+            CA_STATUS_OK);
+
+    ASSERT_EQ(CALaneDispatcherAddData(&dispatcher, "slow", &slowLaneMarker, sizeof(int)),
+            CA_STATUS_OK);
+    for (int i = 0; i < LANE_MESSAGE_COUNT - 1; i++)
+    {
+        ASSERT_EQ(CALaneDispatcherAddData(&dispatcher, "fast", &producerValue, sizeof(int)),
+                CA_STATUS_OK);
+    }
+
+    while (getTaskCounter() < LANE_MESSAGE_COUNT)
+    {
+        sched_yield();
+    }
+
+    CALaneDispatcherStop(&dispatcher);
+    ca_thread_pool_free(pool);
+    CALaneDispatcherDestroy(&dispatcher);
+
+    EXPECT_EQ(taskCounter, LANE_MESSAGE_COUNT);
+}
+
+static volatile int gateEntered = 0;
+static volatile int gateOpen = 0;
+static int processedValues[64];
+static int droppedCount = 0;
+
+static void gatedTask(void *data)
+{
+    int value = *(int *) data;
+    if (0 == value)
+    {
+        __sync_fetch_and_add(&gateEntered, 1);
+        while (!__sync_fetch_and_add(&gateOpen, 0))
+        {
+            sched_yield();
+        }
+    }
+    processedValues[getTaskCounter()] = value;
+    countingTask(data);
+}
+
+static uintptr_t valueClass(const void *data)
+{
+    return (uintptr_t) *(const int *) data;
+}
+
+static void countDropped(void *data, uint32_t size)
+{
+    (void) data;
+    (void) size;
+    droppedCount++;
+}
+
+static void *openGateLater(void *data)
+{
+    (void) data;
+    usleep(50 * 1000);
+    __sync_fetch_and_add(&gateOpen, 1);
+    return NULL;
+}
+
+class OPC_laneCapacity: public ::testing::Test
+{
+protected:
+
+    virtual void SetUp()
+    {
+        PRINT("LANE CAPACITY TESTS");
+        taskCounter = 0;
+        gateEntered = 0;
+        gateOpen = 0;
+        droppedCount = 0;
+        memset(processedValues, 0, sizeof(processedValues));
+
+        ASSERT_EQ(ca_thread_pool_init(1, &pool), CA_STATUS_OK);
+        ASSERT_EQ(CALaneDispatcherInitialize(&dispatcher, pool, 1, gatedTask, noDestroy),
+                CA_STATUS_OK);
+    }
+
+    virtual void TearDown()
+    {
+        __sync_fetch_and_add(&gateOpen, 1);
+        CALaneDispatcherStop(&dispatcher);
+        ca_thread_pool_free(pool);
+        CALaneDispatcherDestroy(&dispatcher);
+    }
+
+    // keeps the only worker busy so that added data stays queued.
+    void occupyWorker()
+    {
+        ASSERT_EQ(CALaneDispatcherAddData(&dispatcher, "lane", &values[0], sizeof(int)),
+                CA_STATUS_OK);
+        while (!__sync_fetch_and_add(&gateEntered, 0))
+        {
+            sched_yield();
+        }
+    }
+
+    void waitForTasks(int count)
+    {
+        while (getTaskCounter() < count)
+        {
+            sched_yield();
+        }
+    }
+
+    ca_thread_pool_t pool = NULL;
+    CALaneDispatcher_t dispatcher;
+    int values[4] = { 0, 1, 2, 3 };
+};
+
+TEST_F(OPC_laneCapacity , reject_N)
+{
+    ASSERT_EQ(CALaneDispatcherSetCapacity(&dispatcher, 2, CA_QUEUE_FULL_REJECT, 0, NULL, NULL),
+            CA_STATUS_OK);
+    occupyWorker();
+
+    EXPECT_EQ(CALaneDispatcherAddData(&dispatcher, "lane", &values[1], sizeof(int)), CA_STATUS_OK);
+    EXPECT_EQ(CALaneDispatcherAddData(&dispatcher, "other", &values[2], sizeof(int)), CA_STATUS_OK);
+    EXPECT_EQ(CALaneDispatcherAddData(&dispatcher, "lane", &values[3], sizeof(int)),
+            CA_STATUS_FAILED);
+
+    CAQueueFullStats_t stats;
+    ASSERT_EQ(CALaneDispatcherGetFullStats(&dispatcher, &stats), CA_STATUS_OK);
+    EXPECT_EQ(stats.rejected, 1u);
+    EXPECT_EQ(stats.dropped, 0u);
+
+    __sync_fetch_and_add(&gateOpen, 1);
+    waitForTasks(3);
+}
+
+TEST_F(OPC_laneCapacity , dropOldest_P)
+{
+    ASSERT_EQ(CALaneDispatcherSetCapacity(&dispatcher, 2, CA_QUEUE_FULL_DROP_OLDEST, 0, valueClass,
+            countDropped), CA_STATUS_OK);
+    occupyWorker();
+
+    EXPECT_EQ(CALaneDispatcherAddData(&dispatcher, "lane", &values[1], sizeof(int)), CA_STATUS_OK);
+    EXPECT_EQ(CALaneDispatcherAddData(&dispatcher, "lane", &values[2], sizeof(int)), CA_STATUS_OK);
+    // nothing queued matches 3.
+    EXPECT_EQ(CALaneDispatcherAddData(&dispatcher, "lane", &values[3], sizeof(int)),
+            CA_STATUS_FAILED);
+    // replaces the queued 1, which was older than 2.
+    EXPECT_EQ(CALaneDispatcherAddData(&dispatcher, "lane", &values[1], sizeof(int)), CA_STATUS_OK);
+
+    CAQueueFullStats_t stats;
+    ASSERT_EQ(CALaneDispatcherGetFullStats(&dispatcher, &stats), CA_STATUS_OK);
+    EXPECT_EQ(stats.dropped, 1u);
+    EXPECT_EQ(stats.rejected, 1u);
+    EXPECT_EQ(droppedCount, 1);
+
+    __sync_fetch_and_add(&gateOpen, 1);
+    waitForTasks(3);
+    EXPECT_EQ(processedValues[0], 0);
+    EXPECT_EQ(processedValues[1], 2);
+    EXPECT_EQ(processedValues[2], 1);
+}
+
+TEST_F(OPC_laneCapacity , block_P)
+{
+    ASSERT_EQ(CALaneDispatcherSetCapacity(&dispatcher, 1, CA_QUEUE_FULL_BLOCK, 20, NULL, NULL),
+            CA_STATUS_OK);
+    occupyWorker();
+
+    EXPECT_EQ(CALaneDispatcherAddData(&dispatcher, "lane", &values[1], sizeof(int)), CA_STATUS_OK);
+    EXPECT_EQ(CALaneDispatcherAddData(&dispatcher, "lane", &values[2], sizeof(int)),
+            CA_STATUS_FAILED);
+
+    // waits until the worker is released and takes the queued data.
+    ASSERT_EQ(CALaneDispatcherSetCapacity(&dispatcher, 1, CA_QUEUE_FULL_BLOCK, 5000, NULL, NULL),
+            CA_STATUS_OK);
+    pthread_t opener;
+    ASSERT_EQ(pthread_create(&opener, NULL, openGateLater, NULL), 0);
+    EXPECT_EQ(CALaneDispatcherAddData(&dispatcher, "lane", &values[3], sizeof(int)), CA_STATUS_OK);
+    pthread_join(opener, NULL);
+
+    CAQueueFullStats_t stats;
+    ASSERT_EQ(CALaneDispatcherGetFullStats(&dispatcher, &stats), CA_STATUS_OK);
+    EXPECT_EQ(stats.blocked, 2u);
+    EXPECT_EQ(stats.blockTimeouts, 1u);
+
+    waitForTasks(3);
+    EXPECT_EQ(processedValues[2], 3);
+}
+
+TEST_F(OPC_laneCapacity , addDataFollowing_P)
+{
+    occupyWorker();
+
+    // joins the busy lane instead of creating its own.
+    EXPECT_EQ(CALaneDispatcherAddDataFollowing(&dispatcher, "spread", "lane", &values[1],
+            sizeof(int), 0), CA_STATUS_OK);
+    EXPECT_EQ(dispatcher.lanes->count, 1u);
+
+    // an idle lane is not followed.
+    EXPECT_EQ(CALaneDispatcherAddDataFollowing(&dispatcher, "spread", "idle", &values[2],
+            sizeof(int), 0), CA_STATUS_OK);
+    EXPECT_EQ(dispatcher.lanes->count, 2u);
+
+    __sync_fetch_and_add(&gateOpen, 1);
+    waitForTasks(3);
+    EXPECT_EQ(processedValues[1], 1);
+    EXPECT_EQ(processedValues[2], 2);
+}
+
+#define PRIORITY_MESSAGE_COUNT 20
+
+class OPC_priority: public ::testing::Test
+{
+protected:
+
+    virtual void SetUp()
+    {
+        PRINT("PRIORITY TESTS");
+        taskCounter = 0;
+        gateEntered = 0;
+        gateOpen = 0;
+        memset(processedValues, 0, sizeof(processedValues));
+        for (int i = 0; i < PRIORITY_MESSAGE_COUNT; i++)
+        {
+            // 1..20 is low priority, 101..120 is high priority.
+            lowValues[i] = i + 1;
+            highValues[i] = i + 101;
+        }
+        ASSERT_EQ(ca_thread_pool_init(1, &pool), CA_STATUS_OK);
+    }
+
+    virtual void TearDown()
+    {
+        __sync_fetch_and_add(&gateOpen, 1);
+        ca_thread_pool_free(pool);
+    }
+
+    void waitForGate()
+    {
+        while (!__sync_fetch_and_add(&gateEntered, 0))
+        {
+            sched_yield();
+        }
+    }
+
+    void checkOrder()
+    {
+        __sync_fetch_and_add(&gateOpen, 1);
+        while (getTaskCounter() < 2 * PRIORITY_MESSAGE_COUNT + 1)
+        {
+            sched_yield();
+        }
+
+        int lastHigh = 0, firstLow = 0, lastLow = 0, low = 0, high = 0;
+        for (int i = 1; i <= 2 * PRIORITY_MESSAGE_COUNT; i++)
+        {
+            int value = processedValues[i];
+            if (value > 100)
+            {
+                // each priority keeps its own order.
+                EXPECT_EQ(value, 101 + high++);
+                lastHigh = i;
+            }
+            else
+            {
+                EXPECT_EQ(value, 1 + low++);
+                firstLow = firstLow ? firstLow : i;
+                lastLow = i;
+            }
+        }
+        // high priority goes first, but low priority is not starved.
+        EXPECT_LT(lastHigh, lastLow);
+        EXPECT_LT(firstLow, lastHigh);
+    }
+
+    ca_thread_pool_t pool = NULL;
+    int gateValue = 0;
+    int lowValues[PRIORITY_MESSAGE_COUNT];
+    int highValues[PRIORITY_MESSAGE_COUNT];
+};
+
+TEST_F(OPC_priority , lane_P)
+{
+    CALaneDispatcher_t dispatcher;
+    ASSERT_EQ(CALaneDispatcherInitialize(&dispatcher, pool, 1, gatedTask, noDestroy), CA_STATUS_OK);
+    EXPECT_EQ(CALaneDispatcherAddDataWithPriority(&dispatcher, "lane", &gateValue, sizeof(int),
+            CA_PRIORITY_COUNT), CA_STATUS_INVALID_PARAM);
+
+    ASSERT_EQ(CALaneDispatcherAddData(&dispatcher, "lane", &gateValue, sizeof(int)), CA_STATUS_OK);
+    waitForGate();
+    for (int i = 0; i < PRIORITY_MESSAGE_COUNT; i++)
+    {
+        ASSERT_EQ(CALaneDispatcherAddDataWithPriority(&dispatcher, "lane", &lowValues[i],
+                sizeof(int), CA_PRIORITY_LOWEST), CA_STATUS_OK);
+    }
+    for (int i = 0; i < PRIORITY_MESSAGE_COUNT; i++)
+    {
+        ASSERT_EQ(CALaneDispatcherAddDataWithPriority(&dispatcher, "lane", &highValues[i],
+                sizeof(int), 0), CA_STATUS_OK);
+    }
+    checkOrder();
+
+    CALaneDispatcherStop(&dispatcher);
+    CALaneDispatcherDestroy(&dispatcher);
+}
+
+TEST_F(OPC_priority , queueingThread_P)
+{
+    CAQueueingThread_t thread;
+    ASSERT_EQ(CAQueueingThreadInitialize(&thread, pool, gatedTask, noDestroy), CA_STATUS_OK);
+    ASSERT_EQ(CAQueueingThreadStart(&thread), CA_STATUS_OK);
+    EXPECT_EQ(CAQueueingThreadAddDataWithPriority(&thread, &gateValue, sizeof(int),
+            CA_PRIORITY_COUNT), CA_STATUS_INVALID_PARAM);
+
+    ASSERT_EQ(CAQueueingThreadAddData(&thread, &gateValue, sizeof(int)), CA_STATUS_OK);
+    waitForGate();
+    for (int i = 0; i < PRIORITY_MESSAGE_COUNT; i++)
+    {
+        ASSERT_EQ(CAQueueingThreadAddDataWithPriority(&thread, &lowValues[i], sizeof(int),
+                CA_PRIORITY_LOWEST), CA_STATUS_OK);
+    }
+    for (int i = 0; i < PRIORITY_MESSAGE_COUNT; i++)
+    {
+        ASSERT_EQ(CAQueueingThreadAddDataWithPriority(&thread, &highValues[i], sizeof(int), 0),
+                CA_STATUS_OK);
+    }
+    checkOrder();
+
+    CAQueueingThreadStop(&thread);
+    CAQueueingThreadDestroy(&thread);
+}
+
+#define BATCH_VALUE_LIMIT 100
+
+static int batchSizes[16];
+static int batchCount = 0;
+
+static bool isBatchValue(const void *queued, const void *data)
+{
+    int value = *(const int *) queued;
+    return value > 0 && value < BATCH_VALUE_LIMIT && *(const int *) data < BATCH_VALUE_LIMIT;
+}
+
+static void batchTask(void **data, uint32_t count)
+{
+    batchSizes[batchCount++] = count;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        gatedTask(data[i]);
+    }
+}
+
+class OPC_laneBatch: public ::testing::Test
+{
+protected:
+
+    virtual void SetUp()
+    {
+        PRINT("LANE BATCH TESTS");
+        taskCounter = 0;
+        gateEntered = 0;
+        gateOpen = 0;
+        batchCount = 0;
+        memset(processedValues, 0, sizeof(processedValues));
+        memset(batchSizes, 0, sizeof(batchSizes));
+        for (int i = 0; i < 8; i++)
+        {
+            values[i] = i + 1;
+        }
+        ASSERT_EQ(ca_thread_pool_init(1, &pool), CA_STATUS_OK);
+        ASSERT_EQ(CALaneDispatcherInitialize(&dispatcher, pool, 1, gatedTask, noDestroy),
+                CA_STATUS_OK);
+    }
+
+    virtual void TearDown()
+    {
+        __sync_fetch_and_add(&gateOpen, 1);
+        CALaneDispatcherStop(&dispatcher);
+        CALaneDispatcherDestroy(&dispatcher);
+        ca_thread_pool_free(pool);
+    }
+
+    void waitForTasks(int count)
+    {
+        while (getTaskCounter() < count)
+        {
+            sched_yield();
+        }
+    }
+
+    ca_thread_pool_t pool = NULL;
+    CALaneDispatcher_t dispatcher;
+    int gateValue = 0;
+    int otherValue = BATCH_VALUE_LIMIT;
+    int values[8];
+};
+
+TEST_F(OPC_laneBatch , setBatch_N)
+{
+    EXPECT_EQ(CALaneDispatcherSetBatch(NULL, isBatchValue, batchTask, 4, 0),
+            CA_STATUS_INVALID_PARAM);
+    EXPECT_EQ(CALaneDispatcherSetBatch(&dispatcher, isBatchValue, NULL, 4, 0),
+            CA_STATUS_INVALID_PARAM);
+    EXPECT_EQ(CALaneDispatcherSetBatch(&dispatcher, NULL, NULL, 0, 0), CA_STATUS_OK);
+}
+
+TEST_F(OPC_laneBatch , queuedData_P)
+{
+    ASSERT_EQ(CALaneDispatcherSetBatch(&dispatcher, isBatchValue, batchTask, 4, 0), CA_STATUS_OK);
+    ASSERT_EQ(CALaneDispatcherAddData(&dispatcher, "lane", &gateValue, sizeof(int)), CA_STATUS_OK);
+    while (!__sync_fetch_and_add(&gateEntered, 0))
+    {
+        sched_yield();
+    }
+
+    // 1..5 stop at the batch limit, the other value ends the batch of 6..7.
+    for (int i = 0; i < 5; i++)
+    {
+        ASSERT_EQ(CALaneDispatcherAddData(&dispatcher, "lane", &values[i], sizeof(int)),
+                CA_STATUS_OK);
+    }
+    ASSERT_EQ(CALaneDispatcherAddData(&dispatcher, "lane", &otherValue, sizeof(int)),
+            CA_STATUS_OK);
+    ASSERT_EQ(CALaneDispatcherAddData(&dispatcher, "lane", &values[5], sizeof(int)), CA_STATUS_OK);
+    ASSERT_EQ(CALaneDispatcherAddData(&dispatcher, "lane", &values[6], sizeof(int)), CA_STATUS_OK);
+
+    __sync_fetch_and_add(&gateOpen, 1);
+    waitForTasks(9);
+
+    ASSERT_EQ(batchCount, 2);
+    EXPECT_EQ(batchSizes[0], 4);
+    EXPECT_EQ(batchSizes[1], 2);
+    int expected[] = { 0, 1, 2, 3, 4, 5, BATCH_VALUE_LIMIT, 6, 7 };
+    for (int i = 0; i < 9; i++)
+    {
+        EXPECT_EQ(processedValues[i], expected[i]);
+    }
+}
+
+TEST_F(OPC_laneBatch , window_P)
+{
+    ASSERT_EQ(CALaneDispatcherSetBatch(&dispatcher, isBatchValue, batchTask, 4, 2000),
+            CA_STATUS_OK);
+    ASSERT_EQ(CALaneDispatcherAddData(&dispatcher, "lane", &values[0], sizeof(int)), CA_STATUS_OK);
+    usleep(20 * 1000);
+    EXPECT_EQ(getTaskCounter(), 0);
+
+    // the waiting worker completes the batch without waiting for the window to end.
+    for (int i = 1; i < 4; i++)
+    {
+        ASSERT_EQ(CALaneDispatcherAddData(&dispatcher, "lane", &values[i], sizeof(int)),
+                CA_STATUS_OK);
+    }
+    waitForTasks(4);
+
+    ASSERT_EQ(batchCount, 1);
+    EXPECT_EQ(batchSizes[0], 4);
+}
+
+class OPC_queueingThreadBatch: public ::testing::Test
+{
+protected:
+
+    virtual void SetUp()
+    {
+        PRINT("QUEUEING THREAD BATCH TESTS");
+        taskCounter = 0;
+        gateEntered = 0;
+        gateOpen = 0;
+        batchCount = 0;
+        memset(processedValues, 0, sizeof(processedValues));
+        memset(batchSizes, 0, sizeof(batchSizes));
+        for (int i = 0; i < 10; i++)
+        {
+            values[i] = i + 1;
+        }
+        ASSERT_EQ(ca_thread_pool_init(1, &pool), CA_STATUS_OK);
+        ASSERT_EQ(CAQueueingThreadInitialize(&thread, pool, gatedTask, noDestroy), CA_STATUS_OK);
+    }
+
+    virtual void TearDown()
+    {
+        __sync_fetch_and_add(&gateOpen, 1);
+        CAQueueingThreadStop(&thread);
+        CAQueueingThreadDestroy(&thread);
+        ca_thread_pool_free(pool);
+    }
+
+    void drain()
+    {
+        ASSERT_EQ(CAQueueingThreadStart(&thread), CA_STATUS_OK);
+        ASSERT_EQ(CAQueueingThreadAddData(&thread, &gateValue, sizeof(int)), CA_STATUS_OK);
+        while (!__sync_fetch_and_add(&gateEntered, 0))
+        {
+            sched_yield();
+        }
+        for (int i = 0; i < 10; i++)
+        {
+            ASSERT_EQ(CAQueueingThreadAddData(&thread, &values[i], sizeof(int)), CA_STATUS_OK);
+        }
+        __sync_fetch_and_add(&gateOpen, 1);
+        while (getTaskCounter() < 11)
+        {
+            sched_yield();
+        }
+        for (int i = 0; i < 11; i++)
+        {
+            EXPECT_EQ(processedValues[i], i);
+        }
+    }
+
+    ca_thread_pool_t pool = NULL;
+    CAQueueingThread_t thread;
+    int gateValue = 0;
+    int values[10];
+};
+
+TEST_F(OPC_queueingThreadBatch , setBatch_N)
+{
+    EXPECT_EQ(CAQueueingThreadSetBatch(NULL, 8, batchTask), CA_STATUS_INVALID_PARAM);
+    EXPECT_EQ(CAQueueingThreadSetBatch(&thread, 0, batchTask), CA_STATUS_INVALID_PARAM);
+    EXPECT_EQ(CAQueueingThreadSetBatch(&thread, CA_QUEUEING_THREAD_MAX_BATCH + 1, batchTask),
+            CA_STATUS_INVALID_PARAM);
+    ASSERT_EQ(CAQueueingThreadStart(&thread), CA_STATUS_OK);
+    EXPECT_EQ(CAQueueingThreadSetBatch(&thread, 8, batchTask), CA_STATUS_FAILED);
+}
+
+TEST_F(OPC_queueingThreadBatch , batchTask_P)
+{
+    ASSERT_EQ(CAQueueingThreadSetBatch(&thread, 8, batchTask), CA_STATUS_OK);
+    drain();
+
+    // the pending data is taken in batches of at most 8.
+    ASSERT_EQ(batchCount, 2);
+    EXPECT_EQ(batchSizes[0], 8);
+    EXPECT_EQ(batchSizes[1], 2);
+}
+
+TEST_F(OPC_queueingThreadBatch , threadTask_P)
+{
+    ASSERT_EQ(CAQueueingThreadSetBatch(&thread, 8, NULL), CA_STATUS_OK);
+    drain();
+    EXPECT_EQ(batchCount, 0);
+}
+
+#define HISTOGRAM_THREAD_COUNT 4
+#define HISTOGRAM_THREAD_VALUES 10000
+
+static void *histogramRecordThread(void *data)
+{
+    CAHistogram_t *histogram = (CAHistogram_t *) data;
+    for (uint64_t value = 1; value <= HISTOGRAM_THREAD_VALUES; value++)
+    {
+        CAHistogramRecord(histogram, value);
+    }
+    return NULL;
+}
+
+class OPC_histogram: public ::testing::Test
+{
+protected:
+
+    virtual void SetUp()
+    {
+        PRINT("HISTOGRAM TESTS");
+        memset(&histogram, 0, sizeof(histogram));
+    }
+
+    CAHistogram_t histogram;
+};
+
+TEST_F(OPC_histogram , empty_N)
+{
+    EXPECT_EQ(CAHistogramPercentile(&histogram, 50.0), 0u);
+    EXPECT_EQ(CAHistogramMean(&histogram), 0u);
+}
+
+TEST_F(OPC_histogram , percentile_P)
+{
+    for (uint64_t value = 1; value <= 1000; value++)
+    {
+        CAHistogramRecord(&histogram, value);
+    }
+    CAHistogramRecord(&histogram, UINT64_MAX / 2);
+
+    // values are kept with a relative precision of 1/CA_HISTOGRAM_SUB_BUCKETS.
+    uint64_t p50 = CAHistogramPercentile(&histogram, 50.0);
+    EXPECT_GE(p50, 500u);
+    EXPECT_LE(p50, 500u + 500u / CA_HISTOGRAM_SUB_BUCKETS);
+    uint64_t p99 = CAHistogramPercentile(&histogram, 99.0);
+    EXPECT_GE(p99, 990u);
+    EXPECT_LE(p99, 990u + 990u / CA_HISTOGRAM_SUB_BUCKETS);
+    EXPECT_EQ(CAHistogramPercentile(&histogram, 0.0), 1u);
+    EXPECT_EQ(CAHistogramPercentile(&histogram, 100.0), UINT64_MAX / 2);
+    EXPECT_EQ(histogram.count, 1001u);
+
+    CAHistogramReset(&histogram);
+    EXPECT_EQ(histogram.count, 0u);
+    EXPECT_EQ(CAHistogramPercentile(&histogram, 100.0), 0u);
+}
+
+TEST_F(OPC_histogram , concurrentRecord_P)
+{
+    pthread_t threads[HISTOGRAM_THREAD_COUNT];
+    for (int i = 0; i < HISTOGRAM_THREAD_COUNT; i++)
+    {
+        ASSERT_EQ(pthread_create(&threads[i], NULL, histogramRecordThread, &histogram), 0);
+    }
+    for (int i = 0; i < HISTOGRAM_THREAD_COUNT; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    EXPECT_EQ(histogram.count, (uint64_t) HISTOGRAM_THREAD_COUNT * HISTOGRAM_THREAD_VALUES);
+    EXPECT_EQ(histogram.max, (uint64_t) HISTOGRAM_THREAD_VALUES);
+    EXPECT_EQ(CAHistogramMean(&histogram), (uint64_t) (HISTOGRAM_THREAD_VALUES + 1) / 2);
+}
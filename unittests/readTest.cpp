@@ -140,6 +140,24 @@ void testRead_P5(char *endpointUri)
     sleep(1);
 }
 
+// Valid and invalid node, synchronous
+void testReadSync_P(char *endpointUri)
+{
+    int num_requests  = 2;
+    EdgeMessage *msg = createEdgeAttributeMessage(endpointUri, num_requests, CMD_READ);
+    EXPECT_EQ(NULL != msg, true);
+    insertReadAccessNode(&msg, node_arr[3]);
+    insertReadAccessNode(&msg, node_arr[8]);
+    EdgeMessage *resp = NULL;
+    EdgeResult result = sendRequestSync(msg, &resp, 0);
+    destroyEdgeMessage(msg);
+    ASSERT_EQ(result.code, STATUS_OK);
+    ASSERT_EQ(NULL != resp, true);
+    EXPECT_EQ(resp->type, GENERAL_RESPONSE);
+    EXPECT_EQ(resp->responseLength, 1);
+    destroyEdgeMessage(resp);
+}
+
 void testReadWithoutEndpoint()
 {
     int num_requests  = 1;
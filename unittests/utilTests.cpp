@@ -20,6 +20,7 @@
 
 #include <gtest/gtest.h>
 #include <iostream>
+#include <time.h>
 
 extern "C"
 {
@@ -31,6 +32,7 @@ extern "C"
 #include "edge_open62541.h"
 #include "edge_list.h"
 #include "edge_map.h"
+#include "edge_intern.h"
 #include "uqueue.h"
 #include "test_common.h"
 }
@@ -144,6 +146,116 @@ TEST_F(OPC_utilMap , deleteMap_P)
     EXPECT_EQ(sampleMap->head == NULL, true);
 }
 
+TEST_F(OPC_utilMap , removeMapElement_P)
+{
+    sampleMap = createMap();
+    ASSERT_EQ(sampleMap != NULL, true);
+
+    int keys[100];
+    for (int i = 0; i < 100; i++)
+    {
+        insertMapElement(sampleMap, (keyValue) &keys[i], (keyValue) (intptr_t) (i + 1));
+    }
+    EXPECT_EQ(100, sampleMap->count);
+
+    for (int i = 0; i < 100; i += 2)
+    {
+        edgeMapNode *removed = removeMapElement(sampleMap, (keyValue) &keys[i]);
+        ASSERT_EQ(removed != NULL, true);
+        EXPECT_EQ((keyValue) &keys[i], removed->key);
+        EdgeFree(removed);
+    }
+    EXPECT_EQ(NULL, removeMapElement(sampleMap, (keyValue) &keys[0]));
+    EXPECT_EQ(50, sampleMap->count);
+
+    int count = 0;
+    for (edgeMapNode *node = sampleMap->head; node != NULL; node = node->next)
+    {
+        // insertion order is kept
+        EXPECT_EQ((intptr_t) (2 * count + 2), (intptr_t) node->value);
+        count++;
+    }
+    EXPECT_EQ(50, count);
+
+    for (int i = 0; i < 100; i++)
+    {
+        keyValue value = getMapElement(sampleMap, (keyValue) &keys[i]);
+        EXPECT_EQ((i % 2) ? (intptr_t) (i + 1) : 0, (intptr_t) value);
+    }
+
+    insertMapElement(sampleMap, (keyValue) &keys[1], (keyValue) "replaced");
+    EXPECT_EQ(50, sampleMap->count);
+    EXPECT_EQ(0, strcmp((char *) getMapElement(sampleMap, (keyValue) &keys[1]), "replaced"));
+
+    deleteMap(sampleMap);
+    EXPECT_EQ(sampleMap->head == NULL, true);
+    EdgeFree(sampleMap);
+}
+
+TEST_F(OPC_utilMap , createStringMap_P)
+{
+    sampleMap = createStringMap();
+    ASSERT_EQ(sampleMap != NULL, true);
+
+    char key[] = "namespace";
+    char lookup[] = "namespace";
+    insertMapElement(sampleMap, (keyValue) key, (keyValue) "value1");
+    EXPECT_EQ(0, strcmp((char *) getMapElement(sampleMap, (keyValue) lookup), "value1"));
+    EXPECT_EQ(NULL, getMapElement(sampleMap, (keyValue) "other"));
+
+    edgeMapNode *removed = removeMapElement(sampleMap, (keyValue) lookup);
+    ASSERT_EQ(removed != NULL, true);
+    EXPECT_EQ((keyValue) key, removed->key);
+    EdgeFree(removed);
+    EXPECT_EQ(sampleMap->head == NULL, true);
+
+    deleteMap(sampleMap);
+    EdgeFree(sampleMap);
+}
+
+static double mapLookupNanos(edgeMap *map, int **keys, int keyCount, int lookups)
+{
+    struct timespec start, end;
+    volatile keyValue found = NULL;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < lookups; i++)
+    {
+        found = getMapElement(map, (keyValue) keys[(i * 7919) % keyCount]);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    (void) found;
+    return ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / lookups;
+}
+
+TEST_F(OPC_utilMap , lookupBenchmark_P)
+{
+    const int sizes[] = { 100, 1000, 20000 };
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        int count = sizes[s];
+        int **keys = (int **) EdgeMalloc(sizeof(int *) * count);
+        ASSERT_EQ(keys != NULL, true);
+        sampleMap = createMap();
+        for (int i = 0; i < count; i++)
+        {
+            keys[i] = (int *) EdgeMalloc(sizeof(int));
+            insertMapElement(sampleMap, (keyValue) keys[i], (keyValue) keys[i]);
+        }
+        ASSERT_EQ(count, sampleMap->count);
+
+        double nanos = mapLookupNanos(sampleMap, keys, count, 200000);
+        PRINT("map of " << count << " elements : " << nanos << " ns/lookup");
+
+        deleteMap(sampleMap);
+        EdgeFree(sampleMap);
+        for (int i = 0; i < count; i++)
+        {
+            EdgeFree(keys[i]);
+        }
+        EdgeFree(keys);
+    }
+}
+
 TEST_F(OPC_util , cloneString_P)
 {
     char *retStr = NULL;
@@ -222,12 +334,49 @@ TEST_F(OPC_util , freeEdgeVersatility_P)
     ASSERT_EQ(dummy==1, true);
 }
 
+TEST_F(OPC_util , setEdgeVersatilityScalar_P)
+{
+    EdgeVersatility *versatileValue = (EdgeVersatility *) EdgeCalloc(1, sizeof(EdgeVersatility));
+    ASSERT_EQ(versatileValue  != NULL, true);
+
+    double scalar = 12.5;
+    ASSERT_EQ(versatileValue->value, setEdgeVersatilityScalar(versatileValue, &scalar, sizeof(scalar)));
+    EXPECT_EQ(versatileValue->value, (void *) &versatileValue->inlineValue);
+    EXPECT_EQ(false, EDGE_VERSATILITY_IS_EXTERNAL(versatileValue));
+    EXPECT_EQ(scalar, *((double *) versatileValue->value));
+    freeEdgeVersatility(versatileValue);
+
+    versatileValue = (EdgeVersatility *) EdgeCalloc(1, sizeof(EdgeVersatility));
+    ASSERT_EQ(versatileValue  != NULL, true);
+    char large[EDGE_VERSATILITY_INLINE_SIZE + 8] = "larger than inline";
+    ASSERT_EQ(setEdgeVersatilityScalar(versatileValue, large, sizeof(large)) != NULL, true);
+    EXPECT_EQ(true, EDGE_VERSATILITY_IS_EXTERNAL(versatileValue));
+    EXPECT_EQ(0, memcmp(large, versatileValue->value, sizeof(large)));
+    freeEdgeVersatility(versatileValue);
+
+    EXPECT_EQ(EDGE_VERSATILITY_ABI_VERSION, getEdgeVersatilityAbiVersion());
+}
+
 TEST_F(OPC_util , isNodeClassValid_N)
 {
     UA_NodeClass invalidNodeClass = (UA_NodeClass) -1;
     ASSERT_EQ(isNodeClassValid(invalidNodeClass), false);
 }
 
+TEST_F(OPC_util , isConnectionLost_P)
+{
+    EXPECT_EQ(true, isConnectionLost(UA_STATUSCODE_BADCONNECTIONCLOSED));
+    EXPECT_EQ(true, isConnectionLost(UA_STATUSCODE_BADSESSIONIDINVALID));
+    EXPECT_EQ(true, isConnectionLost(UA_STATUSCODE_BADSECURECHANNELCLOSED));
+}
+
+TEST_F(OPC_util , isConnectionLost_N)
+{
+    EXPECT_EQ(false, isConnectionLost(UA_STATUSCODE_GOOD));
+    EXPECT_EQ(false, isConnectionLost(UA_STATUSCODE_BADNODEIDUNKNOWN));
+    EXPECT_EQ(false, isConnectionLost(UA_STATUSCODE_BADTIMEOUT));
+}
+
 TEST_F(OPC_util , getEdgeNodeIdType_P)
 {
     ASSERT_EQ(getEdgeNodeIdType('N'), INTEGER);
@@ -327,6 +476,88 @@ TEST_F(OPC_util , cloneEdgeEndpoint_P)
 
 }
 
+TEST_F(OPC_util , shareEdgeEndpoint_P)
+{
+    EdgeEndPointInfo *ep = (EdgeEndPointInfo *) EdgeCalloc(1, sizeof(EdgeEndPointInfo));
+    ASSERT_EQ(ep != NULL, true);
+    ep->endpointUri = copyString("opc.tcp://107.108.81.116:12686/edge-opc-server");
+
+    EdgeEndPointInfo *shared = shareEdgeEndpointInfo(ep);
+    ASSERT_EQ(shared != NULL, true);
+    EXPECT_EQ(shared != ep, true);
+    EXPECT_EQ(strcmp(shared->endpointUri, ep->endpointUri), 0);
+    EXPECT_EQ(1, shared->refCount);
+    freeEdgeEndpointInfo(ep);
+
+    EdgeEndPointInfo *ref = shareEdgeEndpointInfo(shared);
+    EXPECT_EQ(shared, ref);
+    EXPECT_EQ(2, shared->refCount);
+
+    freeEdgeEndpointInfo(ref);
+    EXPECT_EQ(1, shared->refCount);
+    EXPECT_EQ(strcmp(shared->endpointUri, "opc.tcp://107.108.81.116:12686/edge-opc-server"), 0);
+    freeEdgeEndpointInfo(shared);
+}
+
+TEST_F(OPC_util , edgeInternString_P)
+{
+    size_t count = EdgeInternCount();
+    char alias[] = "{2;S;v=12}robot_position";
+
+    const char *handle = EdgeInternString(alias);
+    ASSERT_EQ(handle != NULL, true);
+    EXPECT_EQ(handle != alias, true);
+    EXPECT_EQ(strcmp(handle, alias), 0);
+    EXPECT_EQ(count + 1, EdgeInternCount());
+
+    EXPECT_EQ(handle, EdgeInternString("{2;S;v=12}robot_position"));
+    EXPECT_EQ(handle, EdgeInternStringN("{2;S;v=12}robot_position_x", strlen(alias)));
+    EXPECT_EQ(handle, EdgeInternFind(alias, strlen(alias)));
+    EXPECT_EQ(handle, EdgeInternRetain(handle));
+    EXPECT_EQ(count + 1, EdgeInternCount());
+
+    EdgeInternRelease(handle);
+    EdgeInternRelease(handle);
+    EdgeInternRelease(handle);
+    EXPECT_EQ(handle, EdgeInternFind(alias, strlen(alias)));
+
+    EdgeInternRelease(handle);
+    EXPECT_EQ(count, EdgeInternCount());
+    EXPECT_EQ(NULL, EdgeInternFind(alias, strlen(alias)));
+}
+
+TEST_F(OPC_util , edgeInternString_N)
+{
+    EXPECT_EQ(NULL, EdgeInternString(NULL));
+    EXPECT_EQ(NULL, EdgeInternFind("robot_position", strlen("robot_position")));
+}
+
+TEST_F(OPC_util , getCachedSessionKey_P)
+{
+    const char *key = getCachedSessionKey("opc.tcp://107.108.81.116:12686/edge-opc-server");
+    ASSERT_EQ(key != NULL, true);
+    EXPECT_EQ(strcmp(key, "107.108.81.116:12686"), 0);
+    EXPECT_EQ(key, getCachedSessionKey("opc.tcp://107.108.81.116:12686/edge-opc-server"));
+    EXPECT_EQ(key, getCachedSessionKey("opc.tcp://107.108.81.116:12686/other-server"));
+    EXPECT_EQ(key, EdgeInternFind("107.108.81.116:12686", strlen("107.108.81.116:12686")));
+
+    EdgeEndPointInfo *ep = (EdgeEndPointInfo *) EdgeCalloc(1, sizeof(EdgeEndPointInfo));
+    ASSERT_EQ(ep != NULL, true);
+    ep->endpointUri = copyString("opc.tcp://107.108.81.116:12686/edge-opc-server");
+    ep->sessionId = 7;
+    EdgeEndPointInfo *clone = cloneEdgeEndpointInfo(ep);
+    ASSERT_EQ(clone != NULL, true);
+    EXPECT_EQ(7, clone->sessionId);
+    freeEdgeEndpointInfo(clone);
+    freeEdgeEndpointInfo(ep);
+}
+
+TEST_F(OPC_util , getCachedSessionKey_N)
+{
+    EXPECT_EQ(NULL, getCachedSessionKey(NULL));
+    EXPECT_EQ(NULL, getCachedSessionKey("107.108.81.116"));
+}
+
 TEST_F(OPC_util , cloneNode_P)
 {
     EdgeNodeInfo *nodeInfo = (EdgeNodeInfo *) EdgeCalloc(1, sizeof(EdgeNodeInfo));
@@ -367,6 +598,25 @@ TEST_F(OPC_util , cloneNode_P)
     EXPECT_EQ(retNodeInfo == NULL, true);
 }
 
+TEST_F(OPC_util , cloneApplicationConfig_P)
+{
+    EdgeApplicationConfig *config = (EdgeApplicationConfig *) EdgeCalloc(1, sizeof(EdgeApplicationConfig));
+    ASSERT_EQ(config != NULL, true);
+    config->applicationUri = copyString("urn:edge:opcua:server");
+    config->applicationType = EDGE_APPLICATIONTYPE_SERVER;
+
+    // An application without discovery URLs.
+    EdgeApplicationConfig *clone = cloneEdgeApplicationConfig(config);
+    ASSERT_EQ(clone != NULL, true);
+    EXPECT_EQ(strcmp(clone->applicationUri, config->applicationUri), 0);
+    EXPECT_EQ(clone->applicationType, config->applicationType);
+    EXPECT_EQ(0, clone->discoveryUrlsSize);
+    EXPECT_EQ(clone->discoveryUrls == NULL, true);
+
+    freeEdgeApplicationConfig(clone);
+    freeEdgeApplicationConfig(config);
+}
+
 TEST_F(OPC_util , convertUAStringToString_N)
 {
     char *retStr = NULL;
@@ -439,6 +689,140 @@ TEST_F(OPC_util , edgeStringAlloc_P2)
     ASSERT_EQ(str.data == EDGE_EMPTY_ARRAY_SENTINEL, true);
 }
 
+TEST_F(OPC_util , edgeArena_P)
+{
+    EdgeArena *arena = EdgeArenaCreate(64);
+    ASSERT_EQ(NULL != arena, true);
+
+    EdgeArena *previous = EdgeArenaEnter(arena);
+    int *ptr = (int*) EdgeCalloc(5, sizeof(int));
+    ASSERT_EQ(NULL != ptr, true);
+    ptr[4] = 7;
+
+    // larger than the first block
+    ptr = (int*) EdgeRealloc((void *) ptr, sizeof(int) * 100);
+    ASSERT_EQ(NULL != ptr, true);
+    EXPECT_EQ(7, ptr[4]);
+
+    EdgeFree(ptr);
+    EdgeArenaLeave(previous);
+    EdgeArenaDestroy(arena);
+}
+
+TEST_F(OPC_util , edgeArena_HeapPointer)
+{
+    int *heapPtr = (int*) EdgeMalloc(sizeof(int));
+    ASSERT_EQ(NULL != heapPtr, true);
+
+    EdgeArena *arena = EdgeArenaCreate(EDGE_MESSAGE_ARENA_SIZE);
+    ASSERT_EQ(NULL != arena, true);
+
+    EdgeArena *previous = EdgeArenaEnter(arena);
+    EdgeFree(heapPtr);
+    EdgeArenaLeave(previous);
+
+    EdgeArenaDestroy(arena);
+}
+
+TEST_F(OPC_util , edgeMessageArenaPool_P)
+{
+    EdgeArena *arena = EdgeMessageArenaCreate();
+    ASSERT_EQ(NULL != arena, true);
+
+    EdgeArena *previous = EdgeArenaEnter(arena);
+    ASSERT_EQ(NULL != EdgeMalloc(EDGE_MESSAGE_ARENA_SIZE * 2), true);
+    EdgeArenaLeave(previous);
+    EdgeArenaDestroy(arena);
+
+    uint64_t hits = 0, misses = 0;
+    size_t freeArenas = 0;
+    EdgeMessageArenaPoolStats(&hits, &misses, &freeArenas);
+
+    // the arena comes back from the cache of this thread
+    EdgeArena *recycled = EdgeMessageArenaCreate();
+    EXPECT_EQ(arena, recycled);
+
+    uint64_t hitsAfter = 0;
+    EdgeMessageArenaPoolStats(&hitsAfter, &misses, &freeArenas);
+    EXPECT_EQ(hits + 1, hitsAfter);
+
+    EdgeArenaDestroy(recycled);
+}
+
+TEST_F(OPC_util , createEdgeArenaMessage_P)
+{
+    EdgeMessage *msg = createEdgeArenaMessage("opc.tcp://localhost:12686/edge-opc-server", 2,
+            CMD_READ);
+    ASSERT_EQ(NULL != msg, true);
+    ASSERT_EQ(NULL != msg->arena, true);
+
+    EXPECT_EQ(STATUS_OK, insertReadAccessNode(&msg, "String1").code);
+    EXPECT_EQ(STATUS_OK, insertReadAccessNode(&msg, "String2").code);
+    EXPECT_EQ(2, msg->requestLength);
+
+    destroyEdgeMessage(msg);
+}
+
+static size_t allocatorCalls = 0;
+
+static void *countingMalloc(size_t size)
+{
+    allocatorCalls++;
+    return malloc(size);
+}
+
+static void *countingCalloc(size_t num, size_t size)
+{
+    allocatorCalls++;
+    return calloc(num, size);
+}
+
+static void *countingRealloc(void *ptr, size_t size)
+{
+    allocatorCalls++;
+    return realloc(ptr, size);
+}
+
+static void countingFree(void *ptr)
+{
+    allocatorCalls++;
+    free(ptr);
+}
+
+TEST_F(OPC_util , edgeSetAllocator_P)
+{
+    ASSERT_EQ(true, EdgeSetAllocator(countingMalloc, countingCalloc, countingRealloc,
+            countingFree));
+    allocatorCalls = 0;
+
+    int *ptr = (int*) EdgeCalloc(5, sizeof(int));
+    ASSERT_EQ(NULL != ptr, true);
+    ptr = (int*) EdgeRealloc(ptr, sizeof(int) * 10);
+    ASSERT_EQ(NULL != ptr, true);
+    EdgeFree(ptr);
+    EXPECT_EQ(3, allocatorCalls);
+
+    ASSERT_EQ(true, EdgeSetAllocator(NULL, NULL, NULL, NULL));
+}
+
+TEST_F(OPC_util , edgeSetAllocator_N)
+{
+    EXPECT_EQ(false, EdgeSetAllocator(countingMalloc, NULL, countingRealloc, countingFree));
+}
+
+TEST_F(OPC_util , getEdgeMemoryStats_N)
+{
+    EXPECT_EQ(STATUS_PARAM_INVALID, getEdgeMemoryStats(NULL).code);
+
+    EdgeMemoryStats stats;
+    EdgeResult result = getEdgeMemoryStats(&stats);
+#ifdef EDGE_MEMORY_STATS
+    EXPECT_EQ(STATUS_OK, result.code);
+#else
+    EXPECT_EQ(STATUS_NOT_SUPPORT, result.code);
+#endif
+}
+
 TEST_F(OPC_util , createQueue_P)
 {
     u_queue_t *queue = u_queue_create();